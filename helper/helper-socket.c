@@ -132,11 +132,27 @@ int helper_socket_return(GIOChannel *src, int value, int attach_num, int *attach
 	return CTS_SUCCESS;
 }
 
-static void helper_handle_import_sim(GIOChannel *src)
+int helper_socket_progress(GIOChannel *src, int done, int total)
+{
+	int ret;
+	cts_socket_msg msg={0};
+
+	msg.type = CTS_REQUEST_PROGRESS;
+	msg.val = done;
+	msg.attach_sizes[0] = total;
+
+	ret = helper_safe_write(g_io_channel_unix_get_fd(src), (char *)&msg, sizeof(msg));
+	h_retvm_if(-1 == ret, CTS_ERR_SOCKET_FAILED,
+			"helper_safe_write() Failed(errno = %d)", errno);
+
+	return CTS_SUCCESS;
+}
+
+static void helper_handle_import_sim(GIOChannel *src, bool progress)
 {
 	int ret;
 
-	ret = helper_sim_read_pb_record(src);
+	ret = helper_sim_read_pb_record(src, progress);
 	if (CTS_SUCCESS != ret) {
 		ERR("helper_sim_read_pb_record() Failed(%d)", ret);
 		helper_socket_return(src, ret, 0, NULL);
@@ -322,7 +338,7 @@ static gboolean request_handler(GIOChannel *src, GIOCondition condition,
 	switch (msg.type)
 	{
 	case CTS_REQUEST_IMPORT_SIM:
-		helper_handle_import_sim(src);
+		helper_handle_import_sim(src, msg.val);
 		break;
 	case CTS_REQUEST_EXPORT_SIM:
 		helper_handle_export_sim(src, msg.attach_sizes[0]);
@@ -23,6 +23,7 @@
 
 int helper_socket_init(void);
 int helper_socket_return(GIOChannel *src, int value, int attach_num, int *attach_size);
+int helper_socket_progress(GIOChannel *src, int done, int total);
 
 #endif // __CTS_HELPER_SOCKET_H__
 
@@ -28,6 +28,32 @@
 #include "utils.h"
 #include "sqlite.h"
 
+static void helper_resume_addressbook_deletion(void);
+
+static void helper_addressbook_deleted(int addressbook_id, int result, void *user_data)
+{
+	h_retm_if(CTS_SUCCESS != result, "Deleting the addressbook(%d) Failed(%d)",
+			addressbook_id, result);
+	helper_resume_addressbook_deletion();
+}
+
+/* The state of contacts_svc_delete_addressbook_async() is lost when its process exits */
+static void helper_resume_addressbook_deletion(void)
+{
+	int ret, addressbook_id;
+
+	addressbook_id = helper_get_deleting_addressbook();
+	h_retm_if(addressbook_id < CTS_SUCCESS,
+			"helper_get_deleting_addressbook() Failed(%d)", addressbook_id);
+	if (0 == addressbook_id)
+		return;
+
+	INFO("The deletion of addressbook(%d) is resumed", addressbook_id);
+	ret = contacts_svc_delete_addressbook_async(addressbook_id, 0, NULL,
+			helper_addressbook_deleted, NULL);
+	h_warn_if(CTS_SUCCESS != ret, "contacts_svc_delete_addressbook_async() Failed(%d)", ret);
+}
+
 int main(int argc, char **argv)
 {
 	int ret;
@@ -46,6 +72,11 @@ int main(int argc, char **argv)
 	helper_socket_init();
 	helper_init_configuration();
 
+	helper_resume_addressbook_deletion();
+
+	ret = contacts_svc_compact_tombstones_async(0, NULL, NULL);
+	h_warn_if(CTS_SUCCESS != ret, "contacts_svc_compact_tombstones_async() Failed(%d)", ret);
+
 	g_main_loop_run(cts_helper_loop);
 
 	helper_final_configuration();
@@ -30,6 +30,506 @@
 #include "schema.h"
 #include "schema-recovery.h"
 #include "cts-schema.h"
+#include "cts-sqlite.h"
+
+/*
+ * The upgrades of a DB which was made by an older schema.sql.
+ * A DB of user_version n is upgraded by helper_schema_upgrades[n] and the following ones.
+ * A new DB is made by schema.sql, so it gets the number of upgrades as its user_version.
+ */
+static const char *helper_schema_upgrades[] = {
+	/* 1 : contacts_svc_compact_tombstones() */
+		"CREATE INDEX IF NOT EXISTS grp_rel_log_ver_idx ON group_relations_log(ver); ",
+
+	/* 2 : the phonelog accumulation and stats by triggers */
+		"CREATE TABLE IF NOT EXISTS phonelog_stats(day INTEGER, log_type INTEGER, "
+		"  log_cnt INTEGER, duration INTEGER, PRIMARY KEY(day, log_type)); "
+		"DROP TRIGGER IF EXISTS trg_phonelogs_acc; "
+		"CREATE TRIGGER trg_phonelogs_acc AFTER INSERT ON phonelogs "
+		" WHEN new.log_type = 2 OR new.log_type = 4 "
+		" BEGIN "
+		"   UPDATE phonelog_accumulation SET log_cnt = log_cnt + 1, duration = duration + new.data1 "
+		"     WHERE id <= 2; "
+		" END; "
+		"DROP TRIGGER IF EXISTS trg_phonelogs_stat_insert; "
+		"CREATE TRIGGER trg_phonelogs_stat_insert AFTER INSERT ON phonelogs "
+		" BEGIN "
+		"   INSERT OR IGNORE INTO phonelog_stats VALUES(new.log_time/86400, new.log_type, 0, 0); "
+		"   UPDATE phonelog_stats SET log_cnt = log_cnt + 1, "
+		"     duration = duration + (CASE WHEN new.log_type < 100 THEN new.data1 ELSE 0 END) "
+		"     WHERE day = new.log_time/86400 AND log_type = new.log_type; "
+		" END; "
+		"DROP TRIGGER IF EXISTS trg_phonelogs_stat_del; "
+		"CREATE TRIGGER trg_phonelogs_stat_del AFTER DELETE ON phonelogs "
+		" BEGIN "
+		"   UPDATE phonelog_stats SET log_cnt = log_cnt - 1, "
+		"     duration = duration - (CASE WHEN old.log_type < 100 THEN old.data1 ELSE 0 END) "
+		"     WHERE day = old.log_time/86400 AND log_type = old.log_type; "
+		" END; "
+		"DROP TRIGGER IF EXISTS trg_phonelogs_stat_update; "
+		"CREATE TRIGGER trg_phonelogs_stat_update AFTER UPDATE OF log_type, log_time, data1 ON phonelogs "
+		" BEGIN "
+		"   UPDATE phonelog_stats SET log_cnt = log_cnt - 1, "
+		"     duration = duration - (CASE WHEN old.log_type < 100 THEN old.data1 ELSE 0 END) "
+		"     WHERE day = old.log_time/86400 AND log_type = old.log_type; "
+		"   INSERT OR IGNORE INTO phonelog_stats VALUES(new.log_time/86400, new.log_type, 0, 0); "
+		"   UPDATE phonelog_stats SET log_cnt = log_cnt + 1, "
+		"     duration = duration + (CASE WHEN new.log_type < 100 THEN new.data1 ELSE 0 END) "
+		"     WHERE day = new.log_time/86400 AND log_type = new.log_type; "
+		" END; "
+		"DELETE FROM phonelog_stats; "
+		"INSERT INTO phonelog_stats SELECT log_time/86400, log_type, COUNT(*), "
+		"  SUM(CASE WHEN log_type < 100 THEN data1 ELSE 0 END) "
+		"  FROM phonelogs GROUP BY log_time/86400, log_type; ",
+
+	/* 3 : phonelog_groups for the grouped phonelog lists */
+		"CREATE TABLE IF NOT EXISTS phonelog_groups(id INTEGER PRIMARY KEY AUTOINCREMENT, "
+		"  kind INTEGER, number TEXT, normal_num TEXT, related_id INTEGER, "
+		"  plog_id INTEGER, log_time INTEGER, contact_id INTEGER, number_type INTEGER); "
+		"CREATE INDEX IF NOT EXISTS idx1_phonelog_groups ON phonelog_groups(kind, log_time); "
+		"CREATE INDEX IF NOT EXISTS idx2_phonelog_groups ON phonelog_groups(number, kind); "
+		"CREATE INDEX IF NOT EXISTS idx3_phonelog_groups ON phonelog_groups(normal_num); "
+		"CREATE INDEX IF NOT EXISTS idx4_phonelog_groups ON phonelog_groups(plog_id); "
+		"DROP TRIGGER IF EXISTS trg_phonelog_groups_bind; "
+		"CREATE TRIGGER trg_phonelog_groups_bind AFTER UPDATE OF contact_id ON phonelog_groups "
+		" WHEN new.contact_id = -1 "
+		" BEGIN "
+		"   UPDATE phonelog_groups SET contact_id = IFNULL( "
+		"       (SELECT contact_id FROM data WHERE datatype = 8 AND data3 = new.normal_num "
+		"         AND contact_id = new.related_id), "
+		"       (SELECT MIN(contact_id) FROM data WHERE datatype = 8 AND data3 = new.normal_num)) "
+		"     WHERE id = new.id; "
+		"   UPDATE phonelog_groups SET number_type = (SELECT data1 FROM data "
+		"       WHERE datatype = 8 AND data3 = new.normal_num AND contact_id = phonelog_groups.contact_id) "
+		"     WHERE id = new.id; "
+		" END; "
+		"CREATE INDEX IF NOT EXISTS idx3_phonelogs ON phonelogs(number, log_time); "
+		"DROP TRIGGER IF EXISTS trg_phonelogs_group_insert; "
+		"CREATE TRIGGER trg_phonelogs_group_insert AFTER INSERT ON phonelogs "
+		" WHEN new.log_type < 201 "
+		" BEGIN "
+		"   INSERT INTO phonelog_groups(kind, number) SELECT 0, new.number "
+		"     WHERE NOT EXISTS (SELECT 1 FROM phonelog_groups WHERE kind = 0 AND number IS new.number); "
+		"   INSERT INTO phonelog_groups(kind, number) "
+		"     SELECT (CASE WHEN new.log_type < 101 THEN 1 ELSE 2 END), new.number "
+		"     WHERE NOT EXISTS (SELECT 1 FROM phonelog_groups "
+		"       WHERE kind = (CASE WHEN new.log_type < 101 THEN 1 ELSE 2 END) AND number IS new.number); "
+		"   UPDATE phonelog_groups SET plog_id = new.id, log_time = new.log_time, "
+		"       normal_num = new.normal_num, related_id = new.related_id, contact_id = -1 "
+		"     WHERE (kind = 0 OR kind = (CASE WHEN new.log_type < 101 THEN 1 ELSE 2 END)) "
+		"       AND number IS new.number AND (log_time ISNULL OR log_time <= new.log_time); "
+		" END; "
+		"DROP TRIGGER IF EXISTS trg_phonelogs_group_del; "
+		"CREATE TRIGGER trg_phonelogs_group_del AFTER DELETE ON phonelogs "
+		" WHEN old.log_type < 201 "
+		" BEGIN "
+		"   UPDATE phonelog_groups SET log_time = NULL, plog_id = (SELECT id FROM phonelogs "
+		"       WHERE number IS phonelog_groups.number "
+		"         AND log_type >= (CASE phonelog_groups.kind WHEN 2 THEN 101 ELSE 0 END) "
+		"         AND log_type < (CASE phonelog_groups.kind WHEN 1 THEN 101 ELSE 201 END) "
+		"       ORDER BY log_time DESC, id DESC LIMIT 1) "
+		"     WHERE plog_id = old.id; "
+		"   DELETE FROM phonelog_groups WHERE plog_id ISNULL; "
+		"   UPDATE phonelog_groups SET "
+		"       log_time = (SELECT log_time FROM phonelogs WHERE id = phonelog_groups.plog_id), "
+		"       normal_num = (SELECT normal_num FROM phonelogs WHERE id = phonelog_groups.plog_id), "
+		"       related_id = (SELECT related_id FROM phonelogs WHERE id = phonelog_groups.plog_id), "
+		"       contact_id = -1 "
+		"     WHERE number IS old.number AND log_time ISNULL; "
+		" END; "
+		"DROP TRIGGER IF EXISTS trg_data_number_del; "
+		"CREATE TRIGGER trg_data_number_del AFTER DELETE ON data "
+		" WHEN old.datatype = 8 "
+		" BEGIN "
+		"   DELETE FROM favorites WHERE  type = 1 AND related_id = old.id; "
+		"   DELETE FROM speeddials WHERE  number_id = old.id; "
+		"   UPDATE phonelog_groups SET contact_id = -1 WHERE normal_num = old.data3; "
+		" END; "
+		"DROP TRIGGER IF EXISTS trg_data_number_insert; "
+		"CREATE TRIGGER trg_data_number_insert AFTER INSERT ON data "
+		" WHEN new.datatype = 8 "
+		" BEGIN "
+		"   UPDATE phonelog_groups SET contact_id = -1 WHERE normal_num = new.data3; "
+		" END; "
+		"DROP TRIGGER IF EXISTS trg_data_number_update; "
+		"CREATE TRIGGER trg_data_number_update AFTER UPDATE OF data1, data3 ON data "
+		" WHEN new.datatype = 8 "
+		" BEGIN "
+		"   UPDATE phonelog_groups SET contact_id = -1 "
+		"     WHERE normal_num = old.data3 OR normal_num = new.data3; "
+		" END; "
+		"DELETE FROM phonelog_groups; "
+		"INSERT INTO phonelog_groups(kind, number, normal_num, related_id, plog_id, log_time) "
+		"  SELECT K.kind, A.number, A.normal_num, A.related_id, A.id, A.log_time "
+		"  FROM (SELECT 0 kind, 0 low, 201 high UNION ALL SELECT 1, 0, 101 "
+		"      UNION ALL SELECT 2, 101, 201) K, phonelogs A "
+		"  WHERE A.log_type >= K.low AND A.log_type < K.high "
+		"    AND A.id = (SELECT id FROM phonelogs WHERE number IS A.number "
+		"      AND log_type >= K.low AND log_type < K.high ORDER BY log_time DESC, id DESC LIMIT 1); "
+		/* trg_phonelog_groups_bind binds them */
+		"UPDATE phonelog_groups SET contact_id = -1; ",
+
+	/* 4 : contacts_svc_phonelog_set_retention() */
+		"CREATE TABLE IF NOT EXISTS phonelog_retention(log_type INTEGER PRIMARY KEY, "
+		"  max_cnt INTEGER, max_age INTEGER); ",
+
+	/* 5 : phonelog_counts for the phonelog counts of contacts_svc_count() */
+		"CREATE TABLE IF NOT EXISTS phonelog_counts(log_type INTEGER PRIMARY KEY, "
+		"  log_cnt INTEGER, ver INTEGER); "
+		"DROP TRIGGER IF EXISTS trg_phonelogs_count_insert; "
+		"CREATE TRIGGER trg_phonelogs_count_insert AFTER INSERT ON phonelogs "
+		" BEGIN "
+		"   INSERT OR IGNORE INTO phonelog_counts VALUES(new.log_type, 0, 0); "
+		"   UPDATE phonelog_counts SET log_cnt = log_cnt + 1, ver = ver + 1 WHERE log_type = new.log_type; "
+		" END; "
+		"DROP TRIGGER IF EXISTS trg_phonelogs_count_del; "
+		"CREATE TRIGGER trg_phonelogs_count_del AFTER DELETE ON phonelogs "
+		" BEGIN "
+		"   UPDATE phonelog_counts SET log_cnt = log_cnt - 1, ver = ver + 1 WHERE log_type = old.log_type; "
+		" END; "
+		"DROP TRIGGER IF EXISTS trg_phonelogs_count_update; "
+		"CREATE TRIGGER trg_phonelogs_count_update AFTER UPDATE OF log_type ON phonelogs "
+		" WHEN old.log_type != new.log_type "
+		" BEGIN "
+		"   UPDATE phonelog_counts SET log_cnt = log_cnt - 1, ver = ver + 1 WHERE log_type = old.log_type; "
+		"   INSERT OR IGNORE INTO phonelog_counts VALUES(new.log_type, 0, 0); "
+		"   UPDATE phonelog_counts SET log_cnt = log_cnt + 1, ver = ver + 1 WHERE log_type = new.log_type; "
+		" END; "
+		"DELETE FROM phonelog_counts; "
+		"INSERT INTO phonelog_counts SELECT log_type, COUNT(*), 0 FROM phonelogs GROUP BY log_type; ",
+
+	/* 6 : counters and counter_refs for contacts_svc_count() */
+		"CREATE TABLE IF NOT EXISTS counters(kind INTEGER, scope INTEGER, cnt INTEGER, "
+		"  PRIMARY KEY(kind, scope)); "
+		"CREATE TABLE IF NOT EXISTS counter_refs(kind INTEGER, scope INTEGER, "
+		"  member INTEGER, cnt INTEGER, PRIMARY KEY(kind, scope, member)); "
+		"INSERT OR IGNORE INTO counters VALUES(1, 0, 0); "
+		"DROP TRIGGER IF EXISTS trg_counter_refs_insert; "
+		"CREATE TRIGGER trg_counter_refs_insert AFTER INSERT ON counter_refs "
+		" BEGIN "
+		"   INSERT OR IGNORE INTO counters VALUES(new.kind, new.scope, 0); "
+		"   UPDATE counters SET cnt = cnt + 1 WHERE kind = new.kind AND scope = new.scope; "
+		" END; "
+		"DROP TRIGGER IF EXISTS trg_counter_refs_del; "
+		"CREATE TRIGGER trg_counter_refs_del AFTER DELETE ON counter_refs "
+		" BEGIN "
+		"   UPDATE counters SET cnt = cnt - 1 WHERE kind = old.kind AND scope = old.scope; "
+		" END; "
+		"DROP TRIGGER IF EXISTS trg_persons_insert; "
+		"CREATE TRIGGER trg_persons_insert AFTER INSERT ON persons "
+		" BEGIN "
+		"   UPDATE counters SET cnt = cnt + 1 WHERE kind = 1 AND scope = 0; "
+		" END; "
+		"DROP TRIGGER IF EXISTS trg_persons_del; "
+		"CREATE TRIGGER trg_persons_del AFTER DELETE ON persons "
+		" BEGIN "
+		"   UPDATE counters SET cnt = cnt - 1 WHERE kind = 1 AND scope = 0; "
+		" END; "
+		"DROP TRIGGER IF EXISTS trg_contacts_del; "
+		"CREATE TRIGGER trg_contacts_del AFTER DELETE ON contacts "
+		" BEGIN "
+		"   DELETE FROM data WHERE contact_id = old.contact_id; "
+		"   UPDATE counter_refs SET cnt = cnt - 1 WHERE kind = 2 "
+		"     AND scope = old.addrbook_id AND member = old.person_id; "
+		"   DELETE FROM counter_refs WHERE kind = 2 "
+		"     AND scope = old.addrbook_id AND member = old.person_id AND cnt <= 0; "
+		"   UPDATE counter_refs SET cnt = cnt - 1 WHERE kind = 4 "
+		"     AND scope = old.addrbook_id AND member = old.person_id "
+		"     AND NOT EXISTS (SELECT 1 FROM group_relations WHERE contact_id = old.contact_id); "
+		"   DELETE FROM counter_refs WHERE kind = 4 "
+		"     AND scope = old.addrbook_id AND member = old.person_id AND cnt <= 0; "
+		"   UPDATE counter_refs SET cnt = cnt - 1 WHERE kind = 3 AND member = old.person_id "
+		"     AND scope IN (SELECT group_id FROM group_relations WHERE contact_id = old.contact_id); "
+		"   DELETE FROM counter_refs WHERE kind = 3 AND member = old.person_id AND cnt <= 0 "
+		"     AND scope IN (SELECT group_id FROM group_relations WHERE contact_id = old.contact_id); "
+		"   DELETE FROM group_relations WHERE old.addrbook_id != -1 AND contact_id = old.contact_id; "
+		"   DELETE FROM favorites WHERE type = 0 AND related_id = old.contact_id; "
+		" END; "
+		"DROP TRIGGER IF EXISTS trg_contacts_insert; "
+		"CREATE TRIGGER trg_contacts_insert AFTER INSERT ON contacts "
+		" WHEN new.person_id NOT NULL "
+		" BEGIN "
+		"   INSERT OR IGNORE INTO counter_refs VALUES(2, new.addrbook_id, new.person_id, 0); "
+		"   UPDATE counter_refs SET cnt = cnt + 1 WHERE kind = 2 "
+		"     AND scope = new.addrbook_id AND member = new.person_id; "
+		"   INSERT OR IGNORE INTO counter_refs VALUES(4, new.addrbook_id, new.person_id, 0); "
+		"   UPDATE counter_refs SET cnt = cnt + 1 WHERE kind = 4 "
+		"     AND scope = new.addrbook_id AND member = new.person_id; "
+		" END; "
+		"DROP TRIGGER IF EXISTS trg_contacts_counter_update; "
+		"CREATE TRIGGER trg_contacts_counter_update AFTER UPDATE OF person_id, addrbook_id ON contacts "
+		" WHEN new.person_id NOT NULL "
+		"   AND (old.person_id IS NOT new.person_id OR old.addrbook_id != new.addrbook_id) "
+		" BEGIN "
+		"   UPDATE counter_refs SET cnt = cnt - 1 WHERE kind = 2 "
+		"     AND scope = old.addrbook_id AND member = old.person_id; "
+		"   DELETE FROM counter_refs WHERE kind = 2 "
+		"     AND scope = old.addrbook_id AND member = old.person_id AND cnt <= 0; "
+		"   INSERT OR IGNORE INTO counter_refs VALUES(2, new.addrbook_id, new.person_id, 0); "
+		"   UPDATE counter_refs SET cnt = cnt + 1 WHERE kind = 2 "
+		"     AND scope = new.addrbook_id AND member = new.person_id; "
+		"   UPDATE counter_refs SET cnt = cnt - 1 WHERE kind = 4 "
+		"     AND scope = old.addrbook_id AND member = old.person_id "
+		"     AND NOT EXISTS (SELECT 1 FROM group_relations WHERE contact_id = new.contact_id); "
+		"   DELETE FROM counter_refs WHERE kind = 4 "
+		"     AND scope = old.addrbook_id AND member = old.person_id AND cnt <= 0; "
+		"   INSERT OR IGNORE INTO counter_refs SELECT 4, new.addrbook_id, new.person_id, 0 "
+		"     WHERE NOT EXISTS (SELECT 1 FROM group_relations WHERE contact_id = new.contact_id); "
+		"   UPDATE counter_refs SET cnt = cnt + 1 WHERE kind = 4 "
+		"     AND scope = new.addrbook_id AND member = new.person_id "
+		"     AND NOT EXISTS (SELECT 1 FROM group_relations WHERE contact_id = new.contact_id); "
+		"   UPDATE counter_refs SET cnt = cnt - 1 WHERE kind = 3 AND member = old.person_id "
+		"     AND scope IN (SELECT group_id FROM group_relations WHERE contact_id = new.contact_id); "
+		"   DELETE FROM counter_refs WHERE kind = 3 AND member = old.person_id AND cnt <= 0 "
+		"     AND scope IN (SELECT group_id FROM group_relations WHERE contact_id = new.contact_id); "
+		"   INSERT OR IGNORE INTO counter_refs "
+		"     SELECT 3, group_id, new.person_id, 0 FROM group_relations WHERE contact_id = new.contact_id; "
+		"   UPDATE counter_refs SET cnt = cnt + 1 WHERE kind = 3 AND member = new.person_id "
+		"     AND scope IN (SELECT group_id FROM group_relations WHERE contact_id = new.contact_id); "
+		" END; "
+		"DROP TRIGGER IF EXISTS trg_data_restricted_insert; "
+		"CREATE TRIGGER trg_data_restricted_insert AFTER INSERT ON data "
+		" WHEN new.is_restricted = 1 "
+		" BEGIN "
+		"   INSERT OR IGNORE INTO counter_refs VALUES(6, 0, new.contact_id, 0); "
+		"   UPDATE counter_refs SET cnt = cnt + 1 WHERE kind = 6 AND scope = 0 AND member = new.contact_id; "
+		" END; "
+		"DROP TRIGGER IF EXISTS trg_data_restricted_del; "
+		"CREATE TRIGGER trg_data_restricted_del AFTER DELETE ON data "
+		" WHEN old.is_restricted = 1 "
+		" BEGIN "
+		"   UPDATE counter_refs SET cnt = cnt - 1 WHERE kind = 6 AND scope = 0 AND member = old.contact_id; "
+		"   DELETE FROM counter_refs WHERE kind = 6 AND scope = 0 AND member = old.contact_id AND cnt <= 0; "
+		" END; "
+		"DROP TRIGGER IF EXISTS trg_groups_del; "
+		"CREATE TRIGGER trg_groups_del AFTER DELETE ON groups "
+		" BEGIN "
+		"   DELETE FROM group_relations WHERE group_id = old.group_id; "
+		"   DELETE FROM group_relations_log WHERE group_id = old.group_id; "
+		"   UPDATE counters SET cnt = cnt - 1 WHERE kind = 5 AND scope = old.addrbook_id; "
+		"   DELETE FROM counters WHERE kind = 3 AND scope = old.group_id; "
+		" END; "
+		"DROP TRIGGER IF EXISTS trg_groups_insert; "
+		"CREATE TRIGGER trg_groups_insert AFTER INSERT ON groups "
+		" BEGIN "
+		"   INSERT OR IGNORE INTO counters VALUES(5, new.addrbook_id, 0); "
+		"   UPDATE counters SET cnt = cnt + 1 WHERE kind = 5 AND scope = new.addrbook_id; "
+		" END; "
+		"DROP TRIGGER IF EXISTS trg_group_relations_insert; "
+		"CREATE TRIGGER trg_group_relations_insert AFTER INSERT ON group_relations "
+		" BEGIN "
+		"   INSERT OR IGNORE INTO counter_refs "
+		"     SELECT 3, new.group_id, person_id, 0 FROM contacts WHERE contact_id = new.contact_id; "
+		"   UPDATE counter_refs SET cnt = cnt + 1 WHERE kind = 3 AND scope = new.group_id "
+		"     AND member = (SELECT person_id FROM contacts WHERE contact_id = new.contact_id); "
+		"   UPDATE counter_refs SET cnt = cnt - 1 WHERE kind = 4 "
+		"     AND scope = (SELECT addrbook_id FROM contacts WHERE contact_id = new.contact_id) "
+		"     AND member = (SELECT person_id FROM contacts WHERE contact_id = new.contact_id) "
+		"     AND 1 = (SELECT COUNT(*) FROM group_relations WHERE contact_id = new.contact_id); "
+		"   DELETE FROM counter_refs WHERE kind = 4 "
+		"     AND scope = (SELECT addrbook_id FROM contacts WHERE contact_id = new.contact_id) "
+		"     AND member = (SELECT person_id FROM contacts WHERE contact_id = new.contact_id) "
+		"     AND cnt <= 0; "
+		" END; "
+		"DROP TRIGGER IF EXISTS trg_group_relations_del; "
+		"CREATE TRIGGER trg_group_relations_del AFTER DELETE ON group_relations "
+		" BEGIN "
+		"   UPDATE counter_refs SET cnt = cnt - 1 WHERE kind = 3 AND scope = old.group_id "
+		"     AND member = (SELECT person_id FROM contacts WHERE contact_id = old.contact_id); "
+		"   DELETE FROM counter_refs WHERE kind = 3 AND scope = old.group_id "
+		"     AND member = (SELECT person_id FROM contacts WHERE contact_id = old.contact_id) "
+		"     AND cnt <= 0; "
+		"   INSERT OR IGNORE INTO counter_refs "
+		"     SELECT 4, addrbook_id, person_id, 0 FROM contacts WHERE contact_id = old.contact_id "
+		"       AND NOT EXISTS (SELECT 1 FROM group_relations WHERE contact_id = old.contact_id); "
+		"   UPDATE counter_refs SET cnt = cnt + 1 WHERE kind = 4 "
+		"     AND scope = (SELECT addrbook_id FROM contacts WHERE contact_id = old.contact_id) "
+		"     AND member = (SELECT person_id FROM contacts WHERE contact_id = old.contact_id) "
+		"     AND NOT EXISTS (SELECT 1 FROM group_relations WHERE contact_id = old.contact_id); "
+		" END; "
+		"DELETE FROM counter_refs; "
+		"DELETE FROM counters; "
+		"INSERT INTO counter_refs SELECT 2, addrbook_id, person_id, COUNT(*) FROM contacts "
+		"  WHERE person_id NOT NULL GROUP BY addrbook_id, person_id; "
+		"INSERT INTO counter_refs SELECT 4, addrbook_id, person_id, COUNT(*) FROM contacts "
+		"  WHERE person_id NOT NULL "
+		"    AND NOT EXISTS (SELECT 1 FROM group_relations R WHERE R.contact_id = contacts.contact_id) "
+		"  GROUP BY addrbook_id, person_id; "
+		"INSERT INTO counter_refs SELECT 3, R.group_id, C.person_id, COUNT(*) "
+		"  FROM group_relations R, contacts C ON R.contact_id = C.contact_id "
+		"  WHERE C.person_id NOT NULL GROUP BY R.group_id, C.person_id; "
+		"INSERT INTO counter_refs SELECT 6, 0, contact_id, COUNT(*) FROM data "
+		"  WHERE is_restricted = 1 GROUP BY contact_id; "
+		"INSERT INTO counters SELECT 1, 0, COUNT(*) FROM persons; "
+		"INSERT INTO counters SELECT 5, addrbook_id, COUNT(*) FROM groups GROUP BY addrbook_id; ",
+
+	/* 7 : similar_keys for the duplicate detection */
+		"CREATE TABLE IF NOT EXISTS similar_keys(key TEXT NOT NULL, "
+		"  contact_id INTEGER NOT NULL, data_id INTEGER NOT NULL); "
+		"CREATE INDEX IF NOT EXISTS similar_keys_idx1 ON similar_keys(key, contact_id); "
+		"CREATE INDEX IF NOT EXISTS similar_keys_idx2 ON similar_keys(data_id); "
+		"DROP TRIGGER IF EXISTS trg_data_similar_insert; "
+		"CREATE TRIGGER trg_data_similar_insert AFTER INSERT ON data "
+		" WHEN new.datatype IN (1, 8, 9) "
+		" BEGIN "
+		"   INSERT INTO similar_keys SELECT 'n:'||t, new.contact_id, new.id FROM "
+		"     (SELECT lower(trim(new.data2)) t UNION SELECT lower(trim(new.data3)) "
+		"       UNION SELECT lower(trim(new.data5))) "
+		"     WHERE new.datatype = 1 AND t != ''; "
+		"   INSERT INTO similar_keys SELECT 'p:'||substr(new.data3, -7), new.contact_id, new.id "
+		"     WHERE new.datatype = 8 AND new.data3 != ''; "
+		"   INSERT INTO similar_keys SELECT 'e:'||lower(trim(new.data2)), new.contact_id, new.id "
+		"     WHERE new.datatype = 9 AND trim(new.data2) != ''; "
+		" END; "
+		"DROP TRIGGER IF EXISTS trg_data_similar_update; "
+		"CREATE TRIGGER trg_data_similar_update AFTER UPDATE OF data2, data3, data5 ON data "
+		" WHEN new.datatype IN (1, 8, 9) "
+		" BEGIN "
+		"   DELETE FROM similar_keys WHERE data_id = old.id; "
+		"   INSERT INTO similar_keys SELECT 'n:'||t, new.contact_id, new.id FROM "
+		"     (SELECT lower(trim(new.data2)) t UNION SELECT lower(trim(new.data3)) "
+		"       UNION SELECT lower(trim(new.data5))) "
+		"     WHERE new.datatype = 1 AND t != ''; "
+		"   INSERT INTO similar_keys SELECT 'p:'||substr(new.data3, -7), new.contact_id, new.id "
+		"     WHERE new.datatype = 8 AND new.data3 != ''; "
+		"   INSERT INTO similar_keys SELECT 'e:'||lower(trim(new.data2)), new.contact_id, new.id "
+		"     WHERE new.datatype = 9 AND trim(new.data2) != ''; "
+		" END; "
+		"DROP TRIGGER IF EXISTS trg_data_similar_del; "
+		"CREATE TRIGGER trg_data_similar_del AFTER DELETE ON data "
+		" WHEN old.datatype IN (1, 8, 9) "
+		" BEGIN "
+		"   DELETE FROM similar_keys WHERE data_id = old.id; "
+		" END; "
+		"DELETE FROM similar_keys; "
+		"INSERT INTO similar_keys SELECT 'n:'||t, contact_id, id FROM "
+		"  (SELECT id, contact_id, lower(trim(data2)) t FROM data WHERE datatype = 1 "
+		"    UNION SELECT id, contact_id, lower(trim(data3)) FROM data WHERE datatype = 1 "
+		"    UNION SELECT id, contact_id, lower(trim(data5)) FROM data WHERE datatype = 1) "
+		"  WHERE t != ''; "
+		"INSERT INTO similar_keys SELECT 'p:'||substr(data3, -7), contact_id, id FROM data "
+		"  WHERE datatype = 8 AND data3 != ''; "
+		"INSERT INTO similar_keys SELECT 'e:'||lower(trim(data2)), contact_id, id FROM data "
+		"  WHERE datatype = 9 AND trim(data2) != ''; ",
+
+	/* 8 : person_orphans for cts_person_garbagecollection() */
+		"CREATE TABLE IF NOT EXISTS person_orphans(person_id INTEGER PRIMARY KEY); "
+		"DROP TRIGGER IF EXISTS trg_contacts_del; "
+		"CREATE TRIGGER trg_contacts_del AFTER DELETE ON contacts "
+		" BEGIN "
+		"   DELETE FROM data WHERE contact_id = old.contact_id; "
+		"   UPDATE counter_refs SET cnt = cnt - 1 WHERE kind = 2 "
+		"     AND scope = old.addrbook_id AND member = old.person_id; "
+		"   DELETE FROM counter_refs WHERE kind = 2 "
+		"     AND scope = old.addrbook_id AND member = old.person_id AND cnt <= 0; "
+		"   UPDATE counter_refs SET cnt = cnt - 1 WHERE kind = 4 "
+		"     AND scope = old.addrbook_id AND member = old.person_id "
+		"     AND NOT EXISTS (SELECT 1 FROM group_relations WHERE contact_id = old.contact_id); "
+		"   DELETE FROM counter_refs WHERE kind = 4 "
+		"     AND scope = old.addrbook_id AND member = old.person_id AND cnt <= 0; "
+		"   UPDATE counter_refs SET cnt = cnt - 1 WHERE kind = 3 AND member = old.person_id "
+		"     AND scope IN (SELECT group_id FROM group_relations WHERE contact_id = old.contact_id); "
+		"   DELETE FROM counter_refs WHERE kind = 3 AND member = old.person_id AND cnt <= 0 "
+		"     AND scope IN (SELECT group_id FROM group_relations WHERE contact_id = old.contact_id); "
+		"   DELETE FROM group_relations WHERE old.addrbook_id != -1 AND contact_id = old.contact_id; "
+		"   DELETE FROM favorites WHERE type = 0 AND related_id = old.contact_id; "
+		"   INSERT OR IGNORE INTO person_orphans SELECT old.person_id "
+		"     WHERE old.contact_id = old.person_id "
+		"     AND EXISTS (SELECT 1 FROM persons WHERE person_id = old.person_id); "
+		" END; "
+		"INSERT OR IGNORE INTO person_orphans SELECT person_id FROM persons "
+		"  WHERE NOT EXISTS (SELECT 1 FROM contacts WHERE contact_id = persons.person_id); ",
+
+	/* 9 : contacts_svc_delete_addressbook_async() */
+		"ALTER TABLE addressbooks ADD COLUMN deleting INTEGER DEFAULT 0; "
+		"CREATE INDEX IF NOT EXISTS contacts_addrbook_idx ON contacts(addrbook_id); ",
+};
+
+#define HELPER_SCHEMA_VERSION (sizeof(helper_schema_upgrades)/sizeof(*helper_schema_upgrades))
+
+static int helper_set_schema_version(sqlite3 *db, int version)
+{
+	int ret;
+	char *errmsg = NULL;
+	char query[CTS_SQL_MIN_LEN] = {0};
+
+	snprintf(query, sizeof(query), "PRAGMA user_version = %d", version);
+	ret = sqlite3_exec(db, query, NULL, NULL, &errmsg);
+	if (SQLITE_OK != ret) {
+		ERR("sqlite3_exec(%s) Failed(%d, %s)", query, ret, errmsg);
+		sqlite3_free(errmsg);
+		return CTS_ERR_DB_FAILED;
+	}
+
+	return CTS_SUCCESS;
+}
+
+static int helper_get_schema_version(sqlite3 *db)
+{
+	int ret, version;
+	sqlite3_stmt *stmt = NULL;
+
+	ret = sqlite3_prepare_v2(db, "PRAGMA user_version", -1, &stmt, NULL);
+	h_retvm_if(SQLITE_OK != ret, CTS_ERR_DB_FAILED,
+			"sqlite3_prepare_v2() Failed(%s)", sqlite3_errmsg(db));
+
+	ret = sqlite3_step(stmt);
+	version = sqlite3_column_int(stmt, 0);
+	sqlite3_finalize(stmt);
+	h_retvm_if(SQLITE_ROW != ret, CTS_ERR_DB_FAILED, "sqlite3_step() Failed(%d)", ret);
+
+	return version;
+}
+
+/* Each upgrade is committed with its version, so a failed upgrade is tried again at next boot */
+static int helper_upgrade_schema(void)
+{
+	int i, ret, version;
+	char *errmsg = NULL;
+	sqlite3 *db;
+
+	ret = helper_db_open(&db);
+	h_retvm_if(CTS_SUCCESS != ret, ret, "helper_db_open() Failed(%d)", ret);
+
+	version = helper_get_schema_version(db);
+	if (version < CTS_SUCCESS) {
+		helper_db_close();
+		return version;
+	}
+
+	for (i=version;i<HELPER_SCHEMA_VERSION;i++) {
+		INFO("The schema is upgraded to version %d", i+1);
+		ret = helper_begin_trans();
+		if (CTS_SUCCESS != ret) {
+			ERR("helper_begin_trans() Failed(%d)", ret);
+			break;
+		}
+
+		ret = sqlite3_exec(db, helper_schema_upgrades[i], NULL, NULL, &errmsg);
+		if (SQLITE_OK != ret) {
+			ERR("Upgrading the schema to version %d Failed(%d, %s)", i+1, ret, errmsg);
+			sqlite3_free(errmsg);
+			helper_end_trans(false);
+			ret = CTS_ERR_DB_FAILED;
+			break;
+		}
+
+		ret = helper_set_schema_version(db, i+1);
+		if (CTS_SUCCESS != ret) {
+			helper_end_trans(false);
+			break;
+		}
+
+		ret = helper_end_trans(true);
+		if (CTS_SUCCESS != ret) {
+			ERR("helper_end_trans() Failed(%d)", ret);
+			break;
+		}
+	}
+	helper_db_close();
+
+	return ret;
+}
 
 static inline int helper_check_db_file(void)
 {
@@ -55,6 +555,8 @@ static inline int remake_db_file()
 		ERR("remake contacts DB file is Failed : %s", errmsg);
 		sqlite3_free(errmsg);
 	}
+	else
+		helper_set_schema_version(db, HELPER_SCHEMA_VERSION);
 
 	helper_db_close();
 
@@ -79,6 +581,8 @@ int helper_check_schema(void)
 {
 	if (CTS_ERR_NO_DB_FILE == helper_check_db_file())
 		remake_db_file();
+	else
+		helper_upgrade_schema();
 
 	return CTS_SUCCESS;
 }
@@ -18,6 +18,7 @@
  * limitations under the License.
  *
  */
+#include <stdlib.h>
 #include <string.h>
 #include <tapi_common.h>
 #include <ITapiSim.h>
@@ -41,8 +42,15 @@
 #define TAPI_PB_NAME_INDEX TAPI_PB_3G_NAME
 #define TAPI_PB_NUMBER_INDEX TAPI_PB_3G_NUMBER
 
+#define HELPER_SIM_PROGRESS_UNIT 50
+
 static TelSimImsiInfo_t TAPI_imsi;
 static void *helper_sim_data = NULL;
+static bool helper_sim_progress;
+/* The records are read from SIM first and saved at once */
+static TelSimPbRecord_t *helper_sim_records;
+static int helper_sim_record_cnt;
+static int helper_sim_record_size;
 static TapiHandle *handle;
 static int helper_register_tapi_cnt = 0;
 static TelSimPbType_t sim_type = TAPI_SIM_PB_UNKNOWNN;
@@ -114,9 +122,15 @@ static int helper_insert_SDN(TelSimPbRecord_t *pb2g_data)
 	return ret;
 }
 
-static int helper_insert_2g_contact(TelSimPbRecord_t *pb2g_data)
+static inline void helper_sim_make_uid(int index, char *dest, int dest_size)
+{
+	snprintf(dest, dest_size, "SIM:%s-%s-%s-%d",
+			TAPI_imsi.szMcc, TAPI_imsi.szMnc, TAPI_imsi.szMsin, index);
+}
+
+static int helper_insert_2g_contact(TelSimPbRecord_t *pb2g_data, int found_id)
 {
-	int ret, found_id;
+	int ret;
 	char uid[32];
 	CTSstruct *contact;
 	GSList *numbers=NULL;
@@ -124,12 +138,9 @@ static int helper_insert_2g_contact(TelSimPbRecord_t *pb2g_data)
 
 	h_retvm_if(pb2g_data->index <= 0, CTS_ERR_ARG_INVALID, "The index(%d) is invalid", pb2g_data->index);
 
-	snprintf(uid, sizeof(uid), "SIM:%s-%s-%s-%d",
-			TAPI_imsi.szMcc, TAPI_imsi.szMnc, TAPI_imsi.szMsin, pb2g_data->index);
+	helper_sim_make_uid(pb2g_data->index, uid, sizeof(uid));
 	HELPER_DBG("UID = %s", uid);
 
-	found_id = contacts_svc_find_contact_by(CTS_FIND_BY_UID, uid);
-
 	contact = contacts_svc_struct_new(CTS_STRUCT_CONTACT);
 
 	base = contacts_svc_value_new(CTS_VALUE_CONTACT_BASE_INFO);
@@ -202,9 +213,9 @@ static inline GSList* helper_insert_3g_contact_email(GSList *emails, char *email
 	return g_slist_append(emails, value);
 }
 
-static int helper_insert_3g_contact(TelSimPbRecord_t *pb3g_data)
+static int helper_insert_3g_contact(TelSimPbRecord_t *pb3g_data, int found_id)
 {
-	int ret, found_id;
+	int ret;
 	char uid[32];
 	CTSstruct *contact;
 	CTSvalue *name_val=NULL, *number_val, *base;
@@ -212,10 +223,8 @@ static int helper_insert_3g_contact(TelSimPbRecord_t *pb3g_data)
 
 	h_retvm_if(pb3g_data->index <= 0, CTS_ERR_ARG_INVALID, "The index(%d) is invalid", pb3g_data->index);
 
-	snprintf(uid, sizeof(uid), "SIM:%s-%s-%s-%d",
-			TAPI_imsi.szMcc, TAPI_imsi.szMnc, TAPI_imsi.szMsin, pb3g_data->index);
+	helper_sim_make_uid(pb3g_data->index, uid, sizeof(uid));
 	HELPER_DBG("UID = %s", uid);
-	found_id = contacts_svc_find_contact_by(CTS_FIND_BY_UID, uid);
 
 	contact = contacts_svc_struct_new(CTS_STRUCT_CONTACT);
 
@@ -276,6 +285,104 @@ static int helper_insert_3g_contact(TelSimPbRecord_t *pb3g_data)
 	return ret;
 }
 
+static int helper_sim_keep_record(TelSimPbRecord_t *record)
+{
+	int size;
+	TelSimPbRecord_t *tmp;
+
+	/* It is skipped here, because a failing record fails the whole saving */
+	if (record->index <= 0) {
+		ERR("The index(%d) is invalid", record->index);
+		return CTS_SUCCESS;
+	}
+
+	if (helper_sim_record_size <= helper_sim_record_cnt) {
+		size = helper_sim_record_size ? helper_sim_record_size * 2 : HELPER_SIM_PROGRESS_UNIT;
+		tmp = realloc(helper_sim_records, size * sizeof(TelSimPbRecord_t));
+		h_retvm_if(NULL == tmp, CTS_ERR_OUT_OF_MEMORY, "realloc() Failed");
+		helper_sim_records = tmp;
+		helper_sim_record_size = size;
+	}
+	helper_sim_records[helper_sim_record_cnt++] = *record;
+
+	return CTS_SUCCESS;
+}
+
+static void helper_sim_free_records(void)
+{
+	free(helper_sim_records);
+	helper_sim_records = NULL;
+	helper_sim_record_cnt = 0;
+	helper_sim_record_size = 0;
+}
+
+/*
+ * The existing SIM contacts are found by one query instead of a query per record,
+ * and all records are saved in one transaction after reading SIM is finished.
+ * The nested transaction of a failing record cannot roll back its part alone,
+ * so the failure rolls back all records.
+ */
+static int helper_sim_insert_records(void)
+{
+	int i, ret, found_id;
+	char uid[32];
+	GHashTable *ids;
+	TelSimPbRecord_t *record;
+
+	ids = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	h_retvm_if(NULL == ids, CTS_ERR_OUT_OF_MEMORY, "g_hash_table_new_full() Failed");
+
+	snprintf(uid, sizeof(uid), "SIM:%s-%s-%s-",
+			TAPI_imsi.szMcc, TAPI_imsi.szMnc, TAPI_imsi.szMsin);
+	ret = helper_get_contact_ids_by_uid(uid, ids);
+	h_warn_if(CTS_SUCCESS != ret, "helper_get_contact_ids_by_uid() Failed(%d)", ret);
+
+	ret = contacts_svc_begin_trans();
+	if (CTS_SUCCESS != ret) {
+		ERR("contacts_svc_begin_trans() Failed(%d)", ret);
+		g_hash_table_destroy(ids);
+		return ret;
+	}
+
+	for (i=0;i<helper_sim_record_cnt;i++) {
+		record = &helper_sim_records[i];
+		helper_sim_make_uid(record->index, uid, sizeof(uid));
+		found_id = GPOINTER_TO_INT(g_hash_table_lookup(ids, uid));
+
+		if (TAPI_SIM_PB_3GSIM == record->phonebook_type) {
+			ret = helper_insert_3g_contact(record, found_id);
+			if (ret < CTS_SUCCESS) {
+				ERR("helper_insert_3g_contact() is Failed(%d)", ret);
+				break;
+			}
+		}
+		else {
+			ret = helper_insert_2g_contact(record, found_id);
+			if (ret < CTS_SUCCESS) {
+				ERR("helper_insert_2g_contact() is Failed(%d)", ret);
+				break;
+			}
+		}
+
+		if (helper_sim_progress && helper_sim_data
+				&& (0 == (i+1) % HELPER_SIM_PROGRESS_UNIT || i+1 == helper_sim_record_cnt)) {
+			ret = helper_socket_progress(helper_sim_data, i+1, helper_sim_record_cnt);
+			h_warn_if(CTS_SUCCESS != ret, "helper_socket_progress() Failed(%d)", ret);
+		}
+	}
+	g_hash_table_destroy(ids);
+
+	if (i < helper_sim_record_cnt) {
+		contacts_svc_end_trans(false);
+		return ret;
+	}
+
+	ret = contacts_svc_end_trans(true);
+	h_retvm_if(ret < CTS_SUCCESS, ret, "contacts_svc_end_trans() Failed(%d)", ret);
+
+	return CTS_SUCCESS;
+}
+
 static void helper_sim_read_record_cb(TapiHandle *handle, int result, void *data, void *user_data)
 {
 	HELPER_FN_CALL;
@@ -310,12 +417,12 @@ static void helper_sim_read_record_cb(TapiHandle *handle, int result, void *data
 		h_warn_if(ret < CTS_SUCCESS, "helper_insert_SDN() is Failed(%d)", ret);
 		break;
 	case TAPI_SIM_PB_ADN:
-		ret = helper_insert_2g_contact(sim_info);
-		h_warn_if(ret < CTS_SUCCESS, "helper_insert_2g_contact() is Failed(%d)", ret);
-		break;
 	case TAPI_SIM_PB_3GSIM:
-		ret = helper_insert_3g_contact(sim_info);
-		h_warn_if(ret < CTS_SUCCESS, "helper_insert_3g_contact() is Failed(%d)", ret);
+		ret = helper_sim_keep_record(sim_info);
+		if (CTS_SUCCESS != ret) {
+			ERR("helper_sim_keep_record() Failed(%d)", ret);
+			goto ERROR_RETURN;
+		}
 		break;
 	case TAPI_SIM_PB_FDN:
 	default:
@@ -333,11 +440,15 @@ static void helper_sim_read_record_cb(TapiHandle *handle, int result, void *data
 		}
 	}
 	else {
+		ret = CTS_SUCCESS;
 		if (TAPI_SIM_PB_ADN == sim_info->phonebook_type ||
-			TAPI_SIM_PB_3GSIM == sim_info->phonebook_type)
-			contacts_svc_end_trans(true);
+			TAPI_SIM_PB_3GSIM == sim_info->phonebook_type) {
+			ret = helper_sim_insert_records();
+			h_warn_if(CTS_SUCCESS != ret, "helper_sim_insert_records() Failed(%d)", ret);
+			helper_sim_free_records();
+		}
 		if (helper_sim_data) {
-			ret = helper_socket_return(helper_sim_data, CTS_SUCCESS, 0, NULL);
+			ret = helper_socket_return(helper_sim_data, ret, 0, NULL);
 			h_warn_if(CTS_SUCCESS != ret, "helper_socket_return() Failed(%d)", ret);
 			helper_sim_data = NULL;
 			memset(&TAPI_imsi, 0x00, sizeof(TelSimImsiInfo_t));
@@ -349,9 +460,7 @@ static void helper_sim_read_record_cb(TapiHandle *handle, int result, void *data
 	return;
 
 ERROR_RETURN:
-	if (TAPI_SIM_PB_ADN == sim_info->phonebook_type ||
-		TAPI_SIM_PB_3GSIM == sim_info->phonebook_type)
-		contacts_svc_end_trans(false);
+	helper_sim_free_records();
 	if (helper_sim_data) {
 		ret = helper_socket_return(helper_sim_data, CTS_SUCCESS, 0, NULL);
 		h_warn_if(CTS_SUCCESS != ret, "helper_socket_return() Failed(%d)", ret);
@@ -398,17 +507,16 @@ static void helper_sim_aync_response_pb_count(TapiHandle *handle, int result, vo
 	case TAPI_SIM_PB_3GSIM:
 		if (sim_info->UsedRecordCount) {
 			HELPER_DBG("ADN count = %d", sim_info->UsedRecordCount);
+			helper_sim_free_records();
+			helper_sim_records = calloc(sim_info->UsedRecordCount, sizeof(TelSimPbRecord_t));
+			if (helper_sim_records)
+				helper_sim_record_size = sim_info->UsedRecordCount;
 			ret = tel_read_sim_pb_record(handle, sim_info->StorageFileType, 1, helper_sim_read_record_cb, NULL);
 			if (TAPI_API_SUCCESS != ret) {
 				ERR("tel_read_sim_pb_record() Failed(%d)", ret);
 				ret = CTS_ERR_TAPI_FAILED;
 				goto ERROR_RETURN;
 			}
-			ret = contacts_svc_begin_trans();
-			if (CTS_SUCCESS != ret) {
-				ERR("contacts_svc_begin_trans() Failed(%d)", ret);
-				goto ERROR_RETURN;
-			}
 		} else {
 			ret = CTS_ERR_NO_DATA;
 			goto ERROR_RETURN;
@@ -432,7 +540,7 @@ ERROR_RETURN:
 	helper_deregister_tapi_deinit();
 }
 
-int helper_sim_read_pb_record(void *data)
+int helper_sim_read_pb_record(void *data, bool progress)
 {
 	int ret;
 	int sim_pb_inited;
@@ -481,6 +589,7 @@ int helper_sim_read_pb_record(void *data)
 	}
 
 	helper_sim_data = data;
+	helper_sim_progress = progress;
 
 	return CTS_SUCCESS;
 
@@ -21,7 +21,7 @@
 #ifndef __CTS_HELPER_SIM_H__
 #define __CTS_HELPER_SIM_H__
 
-int helper_sim_read_pb_record(void* data);
+int helper_sim_read_pb_record(void* data, bool progress);
 int helper_sim_write_pb_record(void* data, int index);
 int helper_sim_read_SDN(void* data);
 
@@ -203,6 +203,82 @@ int helper_insert_SDN_contact(const char *name, const char *number)
 	return CTS_SUCCESS;
 }
 
+/*
+ * This function fills ids with the contacts whose uid starts with uid_prefix.
+ * The key is the uid(char *) and the value is the contact id.
+ */
+int helper_get_contact_ids_by_uid(const char *uid_prefix, GHashTable *ids)
+{
+	int ret;
+	sqlite3* db = NULL;
+	sqlite3_stmt* stmt = NULL;
+	char query[CTS_SQL_MIN_LEN] = {0};
+	char pattern[CTS_SQL_MIN_LEN] = {0};
+
+	ret = helper_db_open(&db);
+	h_retvm_if(CTS_SUCCESS != ret, ret, "helper_db_open() Failed(%d)", ret);
+
+	snprintf(query, sizeof(query), "SELECT uid, contact_id FROM %s WHERE uid LIKE ?",
+			CTS_TABLE_CONTACTS);
+
+	ret = sqlite3_prepare_v2(db, query, strlen(query), &stmt, NULL);
+	if(SQLITE_OK != ret) {
+		ERR("sqlite3_prepare_v2(%s) Failed(%s)", query, sqlite3_errmsg(db));
+		helper_db_close();
+		return CTS_ERR_DB_FAILED;
+	}
+
+	snprintf(pattern, sizeof(pattern), "%s%%", uid_prefix);
+	sqlite3_bind_text(stmt, 1, pattern, strlen(pattern), SQLITE_STATIC);
+
+	while (SQLITE_ROW == (ret = sqlite3_step(stmt))) {
+		g_hash_table_insert(ids, g_strdup((const char *)sqlite3_column_text(stmt, 0)),
+				GINT_TO_POINTER(sqlite3_column_int(stmt, 1)));
+	}
+	sqlite3_finalize(stmt);
+	helper_db_close();
+
+	h_retvm_if(SQLITE_DONE != ret, CTS_ERR_DB_FAILED, "sqlite3_step() Failed(%d)", ret);
+
+	return CTS_SUCCESS;
+}
+
+/*
+ * This returns an addressbook whose deletion(contacts_svc_delete_addressbook_async())
+ * was not finished, or 0 if there is none.
+ */
+int helper_get_deleting_addressbook(void)
+{
+	int ret, id = 0;
+	sqlite3* db = NULL;
+	sqlite3_stmt* stmt = NULL;
+	char query[CTS_SQL_MIN_LEN] = {0};
+
+	ret = helper_db_open(&db);
+	h_retvm_if(CTS_SUCCESS != ret, ret, "helper_db_open() Failed(%d)", ret);
+
+	snprintf(query, sizeof(query), "SELECT addrbook_id FROM %s WHERE deleting = 1 LIMIT 1",
+			CTS_TABLE_ADDRESSBOOKS);
+
+	ret = sqlite3_prepare_v2(db, query, strlen(query), &stmt, NULL);
+	if(SQLITE_OK != ret) {
+		ERR("sqlite3_prepare_v2(%s) Failed(%s)", query, sqlite3_errmsg(db));
+		helper_db_close();
+		return CTS_ERR_DB_FAILED;
+	}
+
+	ret = sqlite3_step(stmt);
+	if (SQLITE_ROW == ret)
+		id = sqlite3_column_int(stmt, 0);
+	sqlite3_finalize(stmt);
+	helper_db_close();
+
+	h_retvm_if(SQLITE_ROW != ret && SQLITE_DONE != ret, CTS_ERR_DB_FAILED,
+			"sqlite3_step() Failed(%d)", ret);
+
+	return id;
+}
+
 int helper_delete_SDN_contact(void)
 {
 	int ret;
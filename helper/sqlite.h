@@ -21,13 +21,19 @@
 #ifndef __CTS_HELPER_SQLITE_H__
 #define __CTS_HELPER_SQLITE_H__
 
+#include <stdbool.h>
 #include <sqlite3.h>
+#include <glib.h>
 
 int helper_db_open(sqlite3 **db);
 int helper_db_close(void);
+int helper_begin_trans(void);
+int helper_end_trans(bool success);
 int helper_update_default_language(int system_lang, int default_lang);
 int helper_insert_SDN_contact(const char *name, const char *number);
 int helper_delete_SDN_contact(void);
+int helper_get_contact_ids_by_uid(const char *uid_prefix, GHashTable *ids);
+int helper_get_deleting_addressbook(void);
 int helper_update_collation();
 
 #endif // __CTS_HELPER_SQLITE_H__
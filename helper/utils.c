@@ -150,6 +150,7 @@ int helper_init_configuration(void)
 
 void helper_trim_memory(void)
 {
+	contacts_svc_trim_memory();
 	malloc_trim(0);
 	sqlite3_release_memory(-1);
 }
@@ -59,6 +59,7 @@ chown :6005 /opt/dbspace/.contacts-svc.db
 chown :6005 /opt/dbspace/.contacts-svc.db-journal
 chown :6005 -R /opt/data/contacts-svc/img
 chown :6005 /opt/data/contacts-svc/.CONTACTS_SVC_*_CHANGED
+chown :6005 /opt/data/contacts-svc/.CONTACTS_SVC_CHANGE_LOG
 
 chmod 660 /opt/dbspace/.contacts-svc.db
 chmod 660 /opt/dbspace/.contacts-svc.db-journal
@@ -21,11 +21,56 @@
 --PRAGMA journal_mode = PERSIST;
 --PRAGMA journal_mode = TRUNCATE;
 
+-- The counts for contacts_svc_count() and contacts_svc_count_with_int()
+-- kind 1 : persons(scope 0), 2 : persons in addressbook, 3 : persons in group,
+--      4 : persons having a contact without group in addressbook, 5 : groups in addressbook
+CREATE TABLE counters
+(
+kind INTEGER,
+scope INTEGER,
+cnt INTEGER,
+PRIMARY KEY(kind, scope)
+);
+INSERT INTO counters VALUES(1, 0, 0);
+
+-- The members of the distinct counts. cnt is the number of rows which refer the member.
+-- kind 6 : restricted contacts(scope 0)
+CREATE TABLE counter_refs
+(
+kind INTEGER,
+scope INTEGER,
+member INTEGER,
+cnt INTEGER,
+PRIMARY KEY(kind, scope, member)
+);
+CREATE TRIGGER trg_counter_refs_insert AFTER INSERT ON counter_refs
+ BEGIN
+   INSERT OR IGNORE INTO counters VALUES(new.kind, new.scope, 0);
+   UPDATE counters SET cnt = cnt + 1 WHERE kind = new.kind AND scope = new.scope;
+ END;
+CREATE TRIGGER trg_counter_refs_del AFTER DELETE ON counter_refs
+ BEGIN
+   UPDATE counters SET cnt = cnt - 1 WHERE kind = old.kind AND scope = old.scope;
+ END;
+
 CREATE TABLE persons
 (
 person_id INTEGER PRIMARY KEY AUTOINCREMENT,
 outgoing_count INTEGER DEFAULT 0
 );
+CREATE TRIGGER trg_persons_insert AFTER INSERT ON persons
+ BEGIN
+   UPDATE counters SET cnt = cnt + 1 WHERE kind = 1 AND scope = 0;
+ END;
+CREATE TRIGGER trg_persons_del AFTER DELETE ON persons
+ BEGIN
+   UPDATE counters SET cnt = cnt - 1 WHERE kind = 1 AND scope = 0;
+ END;
+-- persons which lost their primary contact. cts_person_garbagecollection() handles them.
+CREATE TABLE person_orphans
+(
+person_id INTEGER PRIMARY KEY
+);
 
 CREATE TABLE addressbooks
 (
@@ -34,7 +79,8 @@ addrbook_name TEXT,
 acc_id INTEGER,
 acc_type INTEGER DEFAULT 0,
 mode INTEGER, -- permission
-last_sync_ver INTEGER
+last_sync_ver INTEGER,
+deleting INTEGER DEFAULT 0 -- hidden while contacts_svc_delete_addressbook_async() runs
 );
 --CREATE TRIGGER trg_addressbook_sync AFTER UPDATE OF last_sync_ver ON addressbooks
 -- BEGIN
@@ -68,11 +114,71 @@ image1 TEXT -- full image
 );
 CREATE INDEX contacts_ver_idx ON contacts(changed_ver);
 CREATE INDEX contacts_person_idx ON contacts(person_id);
+CREATE INDEX contacts_addrbook_idx ON contacts(addrbook_id);
 CREATE TRIGGER trg_contacts_del AFTER DELETE ON contacts
  BEGIN
    DELETE FROM data WHERE contact_id = old.contact_id;
+   -- counters should be updated before group_relations
+   UPDATE counter_refs SET cnt = cnt - 1 WHERE kind = 2
+     AND scope = old.addrbook_id AND member = old.person_id;
+   DELETE FROM counter_refs WHERE kind = 2
+     AND scope = old.addrbook_id AND member = old.person_id AND cnt <= 0;
+   UPDATE counter_refs SET cnt = cnt - 1 WHERE kind = 4
+     AND scope = old.addrbook_id AND member = old.person_id
+     AND NOT EXISTS (SELECT 1 FROM group_relations WHERE contact_id = old.contact_id);
+   DELETE FROM counter_refs WHERE kind = 4
+     AND scope = old.addrbook_id AND member = old.person_id AND cnt <= 0;
+   UPDATE counter_refs SET cnt = cnt - 1 WHERE kind = 3 AND member = old.person_id
+     AND scope IN (SELECT group_id FROM group_relations WHERE contact_id = old.contact_id);
+   DELETE FROM counter_refs WHERE kind = 3 AND member = old.person_id AND cnt <= 0
+     AND scope IN (SELECT group_id FROM group_relations WHERE contact_id = old.contact_id);
    DELETE FROM group_relations WHERE old.addrbook_id != -1 AND contact_id = old.contact_id;
    DELETE FROM favorites WHERE type = 0 AND related_id = old.contact_id;
+   INSERT OR IGNORE INTO person_orphans SELECT old.person_id
+     WHERE old.contact_id = old.person_id
+     AND EXISTS (SELECT 1 FROM persons WHERE person_id = old.person_id);
+ END;
+CREATE TRIGGER trg_contacts_insert AFTER INSERT ON contacts
+ WHEN new.person_id NOT NULL
+ BEGIN
+   INSERT OR IGNORE INTO counter_refs VALUES(2, new.addrbook_id, new.person_id, 0);
+   UPDATE counter_refs SET cnt = cnt + 1 WHERE kind = 2
+     AND scope = new.addrbook_id AND member = new.person_id;
+   INSERT OR IGNORE INTO counter_refs VALUES(4, new.addrbook_id, new.person_id, 0);
+   UPDATE counter_refs SET cnt = cnt + 1 WHERE kind = 4
+     AND scope = new.addrbook_id AND member = new.person_id;
+ END;
+CREATE TRIGGER trg_contacts_counter_update AFTER UPDATE OF person_id, addrbook_id ON contacts
+ WHEN new.person_id NOT NULL
+   AND (old.person_id IS NOT new.person_id OR old.addrbook_id != new.addrbook_id)
+ BEGIN
+   UPDATE counter_refs SET cnt = cnt - 1 WHERE kind = 2
+     AND scope = old.addrbook_id AND member = old.person_id;
+   DELETE FROM counter_refs WHERE kind = 2
+     AND scope = old.addrbook_id AND member = old.person_id AND cnt <= 0;
+   INSERT OR IGNORE INTO counter_refs VALUES(2, new.addrbook_id, new.person_id, 0);
+   UPDATE counter_refs SET cnt = cnt + 1 WHERE kind = 2
+     AND scope = new.addrbook_id AND member = new.person_id;
+
+   UPDATE counter_refs SET cnt = cnt - 1 WHERE kind = 4
+     AND scope = old.addrbook_id AND member = old.person_id
+     AND NOT EXISTS (SELECT 1 FROM group_relations WHERE contact_id = new.contact_id);
+   DELETE FROM counter_refs WHERE kind = 4
+     AND scope = old.addrbook_id AND member = old.person_id AND cnt <= 0;
+   INSERT OR IGNORE INTO counter_refs SELECT 4, new.addrbook_id, new.person_id, 0
+     WHERE NOT EXISTS (SELECT 1 FROM group_relations WHERE contact_id = new.contact_id);
+   UPDATE counter_refs SET cnt = cnt + 1 WHERE kind = 4
+     AND scope = new.addrbook_id AND member = new.person_id
+     AND NOT EXISTS (SELECT 1 FROM group_relations WHERE contact_id = new.contact_id);
+
+   UPDATE counter_refs SET cnt = cnt - 1 WHERE kind = 3 AND member = old.person_id
+     AND scope IN (SELECT group_id FROM group_relations WHERE contact_id = new.contact_id);
+   DELETE FROM counter_refs WHERE kind = 3 AND member = old.person_id AND cnt <= 0
+     AND scope IN (SELECT group_id FROM group_relations WHERE contact_id = new.contact_id);
+   INSERT OR IGNORE INTO counter_refs
+     SELECT 3, group_id, new.person_id, 0 FROM group_relations WHERE contact_id = new.contact_id;
+   UPDATE counter_refs SET cnt = cnt + 1 WHERE kind = 3 AND member = new.person_id
+     AND scope IN (SELECT group_id FROM group_relations WHERE contact_id = new.contact_id);
  END;
 
 CREATE TABLE deleteds
@@ -132,6 +238,62 @@ CREATE TRIGGER trg_data_number_del AFTER DELETE ON data
  BEGIN
    DELETE FROM favorites WHERE  type = 1 AND related_id = old.id;
    DELETE FROM speeddials WHERE  number_id = old.id;
+   UPDATE phonelog_groups SET contact_id = -1 WHERE normal_num = old.data3;
+ END;
+CREATE TRIGGER trg_data_number_insert AFTER INSERT ON data
+ WHEN new.datatype = 8
+ BEGIN
+   UPDATE phonelog_groups SET contact_id = -1 WHERE normal_num = new.data3;
+ END;
+CREATE TRIGGER trg_data_restricted_insert AFTER INSERT ON data
+ WHEN new.is_restricted = 1
+ BEGIN
+   INSERT OR IGNORE INTO counter_refs VALUES(6, 0, new.contact_id, 0);
+   UPDATE counter_refs SET cnt = cnt + 1 WHERE kind = 6 AND scope = 0 AND member = new.contact_id;
+ END;
+CREATE TRIGGER trg_data_restricted_del AFTER DELETE ON data
+ WHEN old.is_restricted = 1
+ BEGIN
+   UPDATE counter_refs SET cnt = cnt - 1 WHERE kind = 6 AND scope = 0 AND member = old.contact_id;
+   DELETE FROM counter_refs WHERE kind = 6 AND scope = 0 AND member = old.contact_id AND cnt <= 0;
+ END;
+CREATE TRIGGER trg_data_number_update AFTER UPDATE OF data1, data3 ON data
+ WHEN new.datatype = 8
+ BEGIN
+   UPDATE phonelog_groups SET contact_id = -1
+     WHERE normal_num = old.data3 OR normal_num = new.data3;
+ END;
+-- similar_keys are the blocking keys of duplicate detection(cts-person.c)
+-- 'n:' name fields, 'p:' the last 7 digits of normalized numbers, 'e:' emails
+CREATE TRIGGER trg_data_similar_insert AFTER INSERT ON data
+ WHEN new.datatype IN (1, 8, 9)
+ BEGIN
+   INSERT INTO similar_keys SELECT 'n:'||t, new.contact_id, new.id FROM
+     (SELECT lower(trim(new.data2)) t UNION SELECT lower(trim(new.data3))
+       UNION SELECT lower(trim(new.data5)))
+     WHERE new.datatype = 1 AND t != '';
+   INSERT INTO similar_keys SELECT 'p:'||substr(new.data3, -7), new.contact_id, new.id
+     WHERE new.datatype = 8 AND new.data3 != '';
+   INSERT INTO similar_keys SELECT 'e:'||lower(trim(new.data2)), new.contact_id, new.id
+     WHERE new.datatype = 9 AND trim(new.data2) != '';
+ END;
+CREATE TRIGGER trg_data_similar_update AFTER UPDATE OF data2, data3, data5 ON data
+ WHEN new.datatype IN (1, 8, 9)
+ BEGIN
+   DELETE FROM similar_keys WHERE data_id = old.id;
+   INSERT INTO similar_keys SELECT 'n:'||t, new.contact_id, new.id FROM
+     (SELECT lower(trim(new.data2)) t UNION SELECT lower(trim(new.data3))
+       UNION SELECT lower(trim(new.data5)))
+     WHERE new.datatype = 1 AND t != '';
+   INSERT INTO similar_keys SELECT 'p:'||substr(new.data3, -7), new.contact_id, new.id
+     WHERE new.datatype = 8 AND new.data3 != '';
+   INSERT INTO similar_keys SELECT 'e:'||lower(trim(new.data2)), new.contact_id, new.id
+     WHERE new.datatype = 9 AND trim(new.data2) != '';
+ END;
+CREATE TRIGGER trg_data_similar_del AFTER DELETE ON data
+ WHEN old.datatype IN (1, 8, 9)
+ BEGIN
+   DELETE FROM similar_keys WHERE data_id = old.id;
  END;
 CREATE INDEX data_contact_idx ON data(contact_id);
 CREATE INDEX data_contact_idx2 ON data(datatype, contact_id);
@@ -146,6 +308,15 @@ CREATE INDEX data_idx8 ON data(data8);
 CREATE INDEX data_idx9 ON data(data9);
 CREATE INDEX data_idx10 ON data(data10);
 
+CREATE TABLE similar_keys
+(
+key TEXT NOT NULL,
+contact_id INTEGER NOT NULL,
+data_id INTEGER NOT NULL
+);
+CREATE INDEX similar_keys_idx1 ON similar_keys(key, contact_id);
+CREATE INDEX similar_keys_idx2 ON similar_keys(data_id);
+
 CREATE TABLE groups
 (
 group_id INTEGER PRIMARY KEY AUTOINCREMENT,
@@ -160,6 +331,13 @@ CREATE TRIGGER trg_groups_del AFTER DELETE ON groups
  BEGIN
    DELETE FROM group_relations WHERE group_id = old.group_id;
    DELETE FROM group_relations_log WHERE group_id = old.group_id;
+   UPDATE counters SET cnt = cnt - 1 WHERE kind = 5 AND scope = old.addrbook_id;
+   DELETE FROM counters WHERE kind = 3 AND scope = old.group_id;
+ END;
+CREATE TRIGGER trg_groups_insert AFTER INSERT ON groups
+ BEGIN
+   INSERT OR IGNORE INTO counters VALUES(5, new.addrbook_id, 0);
+   UPDATE counters SET cnt = cnt + 1 WHERE kind = 5 AND scope = new.addrbook_id;
  END;
 
 CREATE TABLE group_deleteds
@@ -177,6 +355,38 @@ contact_id INTEGER NOT NULL,
 UNIQUE(group_id, contact_id)
 );
 CREATE INDEX group_idx1 ON group_relations(contact_id);
+CREATE TRIGGER trg_group_relations_insert AFTER INSERT ON group_relations
+ BEGIN
+   INSERT OR IGNORE INTO counter_refs
+     SELECT 3, new.group_id, person_id, 0 FROM contacts WHERE contact_id = new.contact_id;
+   UPDATE counter_refs SET cnt = cnt + 1 WHERE kind = 3 AND scope = new.group_id
+     AND member = (SELECT person_id FROM contacts WHERE contact_id = new.contact_id);
+   -- the first group of the contact
+   UPDATE counter_refs SET cnt = cnt - 1 WHERE kind = 4
+     AND scope = (SELECT addrbook_id FROM contacts WHERE contact_id = new.contact_id)
+     AND member = (SELECT person_id FROM contacts WHERE contact_id = new.contact_id)
+     AND 1 = (SELECT COUNT(*) FROM group_relations WHERE contact_id = new.contact_id);
+   DELETE FROM counter_refs WHERE kind = 4
+     AND scope = (SELECT addrbook_id FROM contacts WHERE contact_id = new.contact_id)
+     AND member = (SELECT person_id FROM contacts WHERE contact_id = new.contact_id)
+     AND cnt <= 0;
+ END;
+CREATE TRIGGER trg_group_relations_del AFTER DELETE ON group_relations
+ BEGIN
+   UPDATE counter_refs SET cnt = cnt - 1 WHERE kind = 3 AND scope = old.group_id
+     AND member = (SELECT person_id FROM contacts WHERE contact_id = old.contact_id);
+   DELETE FROM counter_refs WHERE kind = 3 AND scope = old.group_id
+     AND member = (SELECT person_id FROM contacts WHERE contact_id = old.contact_id)
+     AND cnt <= 0;
+   -- the last group of the contact
+   INSERT OR IGNORE INTO counter_refs
+     SELECT 4, addrbook_id, person_id, 0 FROM contacts WHERE contact_id = old.contact_id
+       AND NOT EXISTS (SELECT 1 FROM group_relations WHERE contact_id = old.contact_id);
+   UPDATE counter_refs SET cnt = cnt + 1 WHERE kind = 4
+     AND scope = (SELECT addrbook_id FROM contacts WHERE contact_id = old.contact_id)
+     AND member = (SELECT person_id FROM contacts WHERE contact_id = old.contact_id)
+     AND NOT EXISTS (SELECT 1 FROM group_relations WHERE contact_id = old.contact_id);
+ END;
 
 CREATE TABLE group_relations_log
 (
@@ -186,6 +396,7 @@ type INTEGER NOT NULL,
 ver INTEGER NOT NULL,
 UNIQUE(group_id, type, ver)
 );
+CREATE INDEX grp_rel_log_ver_idx ON group_relations_log(ver);
 
 CREATE TABLE speeddials
 (
@@ -227,12 +438,89 @@ data2 TEXT  -- short message
 );
 CREATE INDEX idx1_phonelogs ON phonelogs(log_type);
 CREATE INDEX idx2_phonelogs ON phonelogs(log_time);
+CREATE INDEX idx3_phonelogs ON phonelogs(number, log_time);
 CREATE TRIGGER trg_phonelogs_del AFTER DELETE ON phonelogs
  WHEN old.log_type = 2 OR old.log_type = 4
  BEGIN
    DELETE FROM phonelog_accumulation WHERE log_time < (old.log_time - 3456000); -- 40 days
    INSERT INTO phonelog_accumulation VALUES(NULL, 1, old.log_time, old.data1);
  END;
+CREATE TRIGGER trg_phonelogs_acc AFTER INSERT ON phonelogs
+ WHEN new.log_type = 2 OR new.log_type = 4
+ BEGIN
+   UPDATE phonelog_accumulation SET log_cnt = log_cnt + 1, duration = duration + new.data1
+     WHERE id <= 2;
+ END;
+CREATE TRIGGER trg_phonelogs_group_insert AFTER INSERT ON phonelogs
+ WHEN new.log_type < 201
+ BEGIN
+   INSERT INTO phonelog_groups(kind, number) SELECT 0, new.number
+     WHERE NOT EXISTS (SELECT 1 FROM phonelog_groups WHERE kind = 0 AND number IS new.number);
+   INSERT INTO phonelog_groups(kind, number)
+     SELECT (CASE WHEN new.log_type < 101 THEN 1 ELSE 2 END), new.number
+     WHERE NOT EXISTS (SELECT 1 FROM phonelog_groups
+       WHERE kind = (CASE WHEN new.log_type < 101 THEN 1 ELSE 2 END) AND number IS new.number);
+   UPDATE phonelog_groups SET plog_id = new.id, log_time = new.log_time,
+       normal_num = new.normal_num, related_id = new.related_id, contact_id = -1
+     WHERE (kind = 0 OR kind = (CASE WHEN new.log_type < 101 THEN 1 ELSE 2 END))
+       AND number IS new.number AND (log_time ISNULL OR log_time <= new.log_time);
+ END;
+CREATE TRIGGER trg_phonelogs_group_del AFTER DELETE ON phonelogs
+ WHEN old.log_type < 201
+ BEGIN
+   UPDATE phonelog_groups SET log_time = NULL, plog_id = (SELECT id FROM phonelogs
+       WHERE number IS phonelog_groups.number
+         AND log_type >= (CASE phonelog_groups.kind WHEN 2 THEN 101 ELSE 0 END)
+         AND log_type < (CASE phonelog_groups.kind WHEN 1 THEN 101 ELSE 201 END)
+       ORDER BY log_time DESC, id DESC LIMIT 1)
+     WHERE plog_id = old.id;
+   DELETE FROM phonelog_groups WHERE plog_id ISNULL;
+   UPDATE phonelog_groups SET
+       log_time = (SELECT log_time FROM phonelogs WHERE id = phonelog_groups.plog_id),
+       normal_num = (SELECT normal_num FROM phonelogs WHERE id = phonelog_groups.plog_id),
+       related_id = (SELECT related_id FROM phonelogs WHERE id = phonelog_groups.plog_id),
+       contact_id = -1
+     WHERE number IS old.number AND log_time ISNULL;
+ END;
+CREATE TRIGGER trg_phonelogs_count_insert AFTER INSERT ON phonelogs
+ BEGIN
+   INSERT OR IGNORE INTO phonelog_counts VALUES(new.log_type, 0, 0);
+   UPDATE phonelog_counts SET log_cnt = log_cnt + 1, ver = ver + 1 WHERE log_type = new.log_type;
+ END;
+CREATE TRIGGER trg_phonelogs_count_del AFTER DELETE ON phonelogs
+ BEGIN
+   UPDATE phonelog_counts SET log_cnt = log_cnt - 1, ver = ver + 1 WHERE log_type = old.log_type;
+ END;
+CREATE TRIGGER trg_phonelogs_count_update AFTER UPDATE OF log_type ON phonelogs
+ WHEN old.log_type != new.log_type
+ BEGIN
+   UPDATE phonelog_counts SET log_cnt = log_cnt - 1, ver = ver + 1 WHERE log_type = old.log_type;
+   INSERT OR IGNORE INTO phonelog_counts VALUES(new.log_type, 0, 0);
+   UPDATE phonelog_counts SET log_cnt = log_cnt + 1, ver = ver + 1 WHERE log_type = new.log_type;
+ END;
+CREATE TRIGGER trg_phonelogs_stat_insert AFTER INSERT ON phonelogs
+ BEGIN
+   INSERT OR IGNORE INTO phonelog_stats VALUES(new.log_time/86400, new.log_type, 0, 0);
+   UPDATE phonelog_stats SET log_cnt = log_cnt + 1,
+     duration = duration + (CASE WHEN new.log_type < 100 THEN new.data1 ELSE 0 END)
+     WHERE day = new.log_time/86400 AND log_type = new.log_type;
+ END;
+CREATE TRIGGER trg_phonelogs_stat_del AFTER DELETE ON phonelogs
+ BEGIN
+   UPDATE phonelog_stats SET log_cnt = log_cnt - 1,
+     duration = duration - (CASE WHEN old.log_type < 100 THEN old.data1 ELSE 0 END)
+     WHERE day = old.log_time/86400 AND log_type = old.log_type;
+ END;
+CREATE TRIGGER trg_phonelogs_stat_update AFTER UPDATE OF log_type, log_time, data1 ON phonelogs
+ BEGIN
+   UPDATE phonelog_stats SET log_cnt = log_cnt - 1,
+     duration = duration - (CASE WHEN old.log_type < 100 THEN old.data1 ELSE 0 END)
+     WHERE day = old.log_time/86400 AND log_type = old.log_type;
+   INSERT OR IGNORE INTO phonelog_stats VALUES(new.log_time/86400, new.log_type, 0, 0);
+   UPDATE phonelog_stats SET log_cnt = log_cnt + 1,
+     duration = duration + (CASE WHEN new.log_type < 100 THEN new.data1 ELSE 0 END)
+     WHERE day = new.log_time/86400 AND log_type = new.log_type;
+ END;
 
 CREATE TABLE phonelog_accumulation
 (
@@ -244,6 +532,59 @@ duration INTEGER
 INSERT INTO phonelog_accumulation VALUES(1, 0, NULL, 0);
 INSERT INTO phonelog_accumulation VALUES(2, 0, NULL, 0); --total
 
+-- The latest log of each number for the grouped log lists
+CREATE TABLE phonelog_groups
+(
+id INTEGER PRIMARY KEY AUTOINCREMENT,
+kind INTEGER, -- 0 : calls and messages, 1 : calls, 2 : messages
+number TEXT,
+normal_num TEXT,
+related_id INTEGER,
+plog_id INTEGER,
+log_time INTEGER,
+contact_id INTEGER, -- -1 means that it should be bound again
+number_type INTEGER
+);
+CREATE INDEX idx1_phonelog_groups ON phonelog_groups(kind, log_time);
+CREATE INDEX idx2_phonelog_groups ON phonelog_groups(number, kind);
+CREATE INDEX idx3_phonelog_groups ON phonelog_groups(normal_num);
+CREATE INDEX idx4_phonelog_groups ON phonelog_groups(plog_id);
+CREATE TRIGGER trg_phonelog_groups_bind AFTER UPDATE OF contact_id ON phonelog_groups
+ WHEN new.contact_id = -1
+ BEGIN
+   UPDATE phonelog_groups SET contact_id = IFNULL(
+       (SELECT contact_id FROM data WHERE datatype = 8 AND data3 = new.normal_num
+         AND contact_id = new.related_id),
+       (SELECT MIN(contact_id) FROM data WHERE datatype = 8 AND data3 = new.normal_num))
+     WHERE id = new.id;
+   UPDATE phonelog_groups SET number_type = (SELECT data1 FROM data
+       WHERE datatype = 8 AND data3 = new.normal_num AND contact_id = phonelog_groups.contact_id)
+     WHERE id = new.id;
+ END;
+
+CREATE TABLE phonelog_retention
+(
+log_type INTEGER PRIMARY KEY, -- 0 : all logs
+max_cnt INTEGER, -- 0 : unlimited
+max_age INTEGER -- days, 0 : unlimited
+);
+
+CREATE TABLE phonelog_counts
+(
+log_type INTEGER PRIMARY KEY,
+log_cnt INTEGER,
+ver INTEGER -- increased whenever log_cnt is changed
+);
+
+CREATE TABLE phonelog_stats
+(
+day INTEGER, -- log_time/86400 (UTC)
+log_type INTEGER,
+log_cnt INTEGER,
+duration INTEGER, -- call types only
+PRIMARY KEY(day, log_type)
+);
+
 CREATE TABLE my_profiles
 (
 id INTEGER PRIMARY KEY AUTOINCREMENT,
@@ -22,9 +22,18 @@
 #include "cts-schema.h"
 #include "cts-sqlite.h"
 #include "cts-utils.h"
+#include "cts-list.h"
 #include "cts-person.h"
+#include "cts-restriction.h"
 #include "cts-addressbook.h"
 
+/*
+ * Whether an addressbook is being deleted. It is read again after the addressbook
+ * notification is published by any process, or this process changes the addressbooks.
+ */
+static int cts_addrbook_deleting = -1;
+static struct timespec cts_addrbook_deleting_time;
+
 static inline int cts_reset_internal_addressbook(void)
 {
 	CTS_FN_CALL;
@@ -45,6 +54,13 @@ static inline int cts_reset_internal_addressbook(void)
 		return ret;
 	}
 
+	ret = cts_person_garbagecollection();
+	if (CTS_SUCCESS != ret) {
+		ERR("cts_person_garbagecollection() Failed(%d)", ret);
+		contacts_svc_end_trans(false);
+		return ret;
+	}
+
 	snprintf(query, sizeof(query), "DELETE FROM %s WHERE addrbook_id = %d",
 			CTS_TABLE_GROUPS, CTS_ADDRESSBOOK_INTERNAL);
 
@@ -58,6 +74,7 @@ static inline int cts_reset_internal_addressbook(void)
 
 	cts_set_contact_noti();
 	cts_set_group_noti();
+	cts_add_change_noti(CTS_CHANGE_TABLE_ADDRESSBOOK, CTS_ADDRESSBOOK_INTERNAL, CTS_OPERATION_DELETED);
 	ret = contacts_svc_end_trans(true);
 	if (ret < CTS_SUCCESS)
 		return ret;
@@ -105,6 +122,7 @@ API int contacts_svc_insert_addressbook(CTSvalue *addressbook)
 	cts_stmt_finalize(stmt);
 
 	cts_set_addrbook_noti();
+	cts_add_change_noti(CTS_CHANGE_TABLE_ADDRESSBOOK, index, CTS_OPERATION_INSERTED);
 	ret = contacts_svc_end_trans(true);
 	retvm_if(ret < CTS_SUCCESS, ret, "contacts_svc_end_trans() Failed(%d)", ret);
 
@@ -114,7 +132,7 @@ API int contacts_svc_insert_addressbook(CTSvalue *addressbook)
 API int contacts_svc_delete_addressbook(int addressbook_id)
 {
 	CTS_FN_CALL;
-	int ret;
+	int ret, changed;
 	char query[CTS_SQL_MAX_LEN] = {0};
 
 	if (CTS_ADDRESSBOOK_INTERNAL == addressbook_id)
@@ -132,6 +150,7 @@ API int contacts_svc_delete_addressbook(int addressbook_id)
 		contacts_svc_end_trans(false);
 		return ret;
 	}
+	changed = cts_db_change();
 
 	ret = cts_person_garbagecollection();
 	if (CTS_SUCCESS != ret) {
@@ -140,12 +159,12 @@ API int contacts_svc_delete_addressbook(int addressbook_id)
 		return ret;
 	}
 
-	ret = cts_db_change();
-
-	if (0 < ret) {
+	if (0 < changed) {
 		cts_set_contact_noti();
 		cts_set_group_noti();
 		cts_set_addrbook_noti();
+		cts_add_change_noti(CTS_CHANGE_TABLE_ADDRESSBOOK, addressbook_id, CTS_OPERATION_DELETED);
+		cts_addrbook_deleting = -1;
 		ret = contacts_svc_end_trans(true);
 	}
 	else {
@@ -197,6 +216,7 @@ API int contacts_svc_update_addressbook(CTSvalue *addressbook)
 	cts_stmt_finalize(stmt);
 
 	cts_set_addrbook_noti();
+	cts_add_change_noti(CTS_CHANGE_TABLE_ADDRESSBOOK, record->id, CTS_OPERATION_UPDATED);
 
 	ret = contacts_svc_end_trans(true);
 	if (ret < CTS_SUCCESS)
@@ -216,7 +236,8 @@ API int contacts_svc_get_addressbook(int addressbook_id, CTSvalue **ret_value)
 
 	snprintf(query, sizeof(query),
 			"SELECT addrbook_id, addrbook_name, acc_id, acc_type, mode "
-			"FROM %s WHERE addrbook_id = %d", CTS_TABLE_ADDRESSBOOKS, addressbook_id);
+			"FROM %s WHERE addrbook_id = %d AND deleting = 0",
+			CTS_TABLE_ADDRESSBOOKS, addressbook_id);
 
 	stmt = cts_query_prepare(query);
 	retvm_if(NULL == stmt, CTS_ERR_DB_FAILED, "cts_query_prepare() Failed");
@@ -240,3 +261,453 @@ API int contacts_svc_get_addressbook(int addressbook_id, CTSvalue **ret_value)
 
 	return CTS_SUCCESS;
 }
+
+API int contacts_svc_set_addressbook_sync_ver(int addressbook_id, int version)
+{
+	int ret;
+	char query[CTS_SQL_MIN_LEN] = {0};
+
+	retvm_if(addressbook_id <= CTS_ADDRESSBOOK_INTERNAL, CTS_ERR_ARG_INVALID,
+			"The addressbook_id(%d) is invalid", addressbook_id);
+	retvm_if(version < 0, CTS_ERR_ARG_INVALID, "The version(%d) is invalid", version);
+
+	ret = contacts_svc_begin_trans();
+	retvm_if(ret, ret, "contacts_svc_begin_trans() Failed(%d)", ret);
+
+	snprintf(query, sizeof(query), "UPDATE %s SET last_sync_ver = %d WHERE addrbook_id = %d",
+			CTS_TABLE_ADDRESSBOOKS, version, addressbook_id);
+
+	ret = cts_query_exec(query);
+	if (CTS_SUCCESS != ret) {
+		ERR("cts_query_exec() Failed(%d)", ret);
+		contacts_svc_end_trans(false);
+		return ret;
+	}
+	if (!cts_db_change()) {
+		contacts_svc_end_trans(false);
+		return CTS_ERR_DB_RECORD_NOT_FOUND;
+	}
+
+	ret = contacts_svc_end_trans(true);
+	if (ret < CTS_SUCCESS)
+		return ret;
+	else
+		return CTS_SUCCESS;
+}
+
+#define CTS_COMPACTION_BATCH_DEFAULT 100
+
+static inline int cts_get_compaction_ver(void)
+{
+	int ret;
+	char query[CTS_SQL_MIN_LEN] = {0};
+
+	/* An addressbook which has never been synchronized blocks the compaction.
+	 * Without addressbooks, the internal addressbook(it cannot set the version)
+	 * may be synchronized, so nothing is removed(MIN() of no row is NULL = 0). */
+	snprintf(query, sizeof(query),
+			"SELECT MIN(IFNULL(last_sync_ver, 0)) FROM %s WHERE deleting = 0",
+			CTS_TABLE_ADDRESSBOOKS);
+
+	ret = cts_query_get_first_int_result(query);
+	if (CTS_ERR_DB_RECORD_NOT_FOUND == ret)
+		return 0;
+	return ret;
+}
+
+/* It returns the number of removed rows. It is less than batch_size at the last batch. */
+static int cts_compact_tombstones_batch(int compaction_ver, int batch_size)
+{
+	int i, ret, removed;
+	char query[CTS_SQL_MIN_LEN] = {0};
+	const char *tables[][2] = {
+		{CTS_TABLE_DELETEDS, "deleted_ver"},
+		{CTS_TABLE_GROUP_DELETEDS, "deleted_ver"},
+		{CTS_TABLE_GROUP_RELATIONS_LOG, "ver"},
+	};
+
+	ret = contacts_svc_begin_trans();
+	retvm_if(ret, ret, "contacts_svc_begin_trans() Failed(%d)", ret);
+
+	removed = 0;
+	for (i=0;i<sizeof(tables)/sizeof(*tables) && removed < batch_size;i++) {
+		snprintf(query, sizeof(query),
+				"DELETE FROM %s WHERE rowid IN "
+				"(SELECT rowid FROM %s WHERE %s <= %d LIMIT %d)",
+				tables[i][0], tables[i][0], tables[i][1], compaction_ver,
+				batch_size - removed);
+
+		ret = cts_query_exec(query);
+		if (CTS_SUCCESS != ret) {
+			ERR("cts_query_exec() Failed(%d)", ret);
+			contacts_svc_end_trans(false);
+			return ret;
+		}
+		removed += cts_db_change();
+	}
+
+	ret = contacts_svc_end_trans(0 < removed);
+	retvm_if(ret < CTS_SUCCESS, ret, "contacts_svc_end_trans() Failed(%d)", ret);
+
+	return removed;
+}
+
+API int contacts_svc_compact_tombstones(int batch_size)
+{
+	int ret, compaction_ver, total;
+
+	retvm_if(batch_size < 0, CTS_ERR_ARG_INVALID, "The batch_size(%d) is invalid", batch_size);
+	if (0 == batch_size)
+		batch_size = CTS_COMPACTION_BATCH_DEFAULT;
+
+	compaction_ver = cts_get_compaction_ver();
+	retvm_if(compaction_ver < CTS_SUCCESS, compaction_ver,
+			"cts_get_compaction_ver() Failed(%d)", compaction_ver);
+	if (0 == compaction_ver)
+		return 0;
+
+	total = 0;
+	do {
+		ret = cts_compact_tombstones_batch(compaction_ver, batch_size);
+		retvm_if(ret < CTS_SUCCESS, ret, "cts_compact_tombstones_batch() Failed(%d)", ret);
+		total += ret;
+	} while (batch_size == ret);
+
+	INFO("%d tombstones are removed(ver <= %d)", total, compaction_ver);
+	return total;
+}
+
+static struct {
+	bool running;
+	int compaction_ver;
+	int batch_size;
+	int total;
+	cts_compact_fn cb;
+	void *user_data;
+}cts_compaction;
+
+static gboolean cts_compact_tombstones_idle(gpointer data)
+{
+	int ret;
+
+	if (0 == cts_compaction.compaction_ver)
+		ret = 0;
+	else
+		ret = cts_compact_tombstones_batch(cts_compaction.compaction_ver,
+				cts_compaction.batch_size);
+	if (cts_compaction.batch_size == ret) {
+		cts_compaction.total += ret;
+		return TRUE;
+	}
+
+	if (CTS_SUCCESS <= ret) {
+		cts_compaction.total += ret;
+		ret = cts_compaction.total;
+		INFO("%d tombstones are removed(ver <= %d)", ret, cts_compaction.compaction_ver);
+	}
+	else
+		ERR("cts_compact_tombstones_batch() Failed(%d)", ret);
+
+	cts_compaction.running = false;
+	if (cts_compaction.cb)
+		cts_compaction.cb(ret, cts_compaction.user_data);
+
+	return FALSE;
+}
+
+API int contacts_svc_compact_tombstones_async(int batch_size,
+		cts_compact_fn cb, void *user_data)
+{
+	int compaction_ver;
+
+	retvm_if(batch_size < 0, CTS_ERR_ARG_INVALID, "The batch_size(%d) is invalid", batch_size);
+	retvm_if(cts_compaction.running, CTS_ERR_ALREADY_RUNNING, "The compaction is running");
+
+	compaction_ver = cts_get_compaction_ver();
+	retvm_if(compaction_ver < CTS_SUCCESS, compaction_ver,
+			"cts_get_compaction_ver() Failed(%d)", compaction_ver);
+
+	cts_compaction.running = true;
+	cts_compaction.compaction_ver = compaction_ver;
+	cts_compaction.batch_size = batch_size?batch_size:CTS_COMPACTION_BATCH_DEFAULT;
+	cts_compaction.total = 0;
+	cts_compaction.cb = cb;
+	cts_compaction.user_data = user_data;
+
+	g_idle_add(cts_compact_tombstones_idle, NULL);
+
+	return CTS_SUCCESS;
+}
+
+#define CTS_ADDRBOOK_DELETE_BATCH_DEFAULT 100
+
+static struct {
+	bool running;
+	int addrbook_id;
+	int batch_size;
+	int deleted;
+	int total;
+	cts_addrbook_delete_progress_fn progress_cb;
+	cts_addrbook_delete_done_fn done_cb;
+	void *user_data;
+}cts_addrbook_deletion;
+
+/*
+ * This returns the data table for lists, searches and counts.
+ * The restricted data are hidden without the permit and the data of the addressbooks
+ * which are being deleted by contacts_svc_delete_addressbook_async() are hidden.
+ */
+const char* cts_addressbook_get_visible_data(void)
+{
+	int ret;
+	struct timespec noti_time = {0};
+	char query[CTS_SQL_MIN_LEN];
+
+	ret = cts_get_addrbook_noti_time(&noti_time);
+	if (CTS_SUCCESS != ret
+			|| noti_time.tv_sec != cts_addrbook_deleting_time.tv_sec
+			|| noti_time.tv_nsec != cts_addrbook_deleting_time.tv_nsec)
+		cts_addrbook_deleting = -1;
+
+	if (cts_addrbook_deleting < 0) {
+		snprintf(query, sizeof(query), "SELECT COUNT(*) FROM %s WHERE deleting = 1",
+				CTS_TABLE_ADDRESSBOOKS);
+		ret = cts_query_get_first_int_result(query);
+		if (CTS_SUCCESS <= ret) {
+			cts_addrbook_deleting = (0 < ret);
+			cts_addrbook_deleting_time = noti_time;
+		}
+	}
+
+	if (1 == cts_addrbook_deleting)
+		return CTS_TABLE_VISIBLE_DATA_VIEW;
+
+	if (cts_restriction_get_permit())
+		return CTS_TABLE_DATA;
+	else
+		return CTS_TABLE_RESTRICTED_DATA_VIEW;
+}
+
+static int cts_set_addressbook_deleting(int addressbook_id, bool deleting)
+{
+	int ret;
+	char query[CTS_SQL_MIN_LEN] = {0};
+
+	ret = contacts_svc_begin_trans();
+	retvm_if(ret, ret, "contacts_svc_begin_trans() Failed(%d)", ret);
+
+	snprintf(query, sizeof(query), "UPDATE %s SET deleting = %d WHERE addrbook_id = %d",
+			CTS_TABLE_ADDRESSBOOKS, deleting, addressbook_id);
+	cts_addrbook_deleting = -1;
+	ret = cts_query_exec(query);
+	if (CTS_SUCCESS != ret) {
+		ERR("cts_query_exec() Failed(%d)", ret);
+		contacts_svc_end_trans(false);
+		return ret;
+	}
+	if (0 == cts_db_change()) {
+		contacts_svc_end_trans(false);
+		return CTS_ERR_DB_RECORD_NOT_FOUND;
+	}
+
+	cts_set_addrbook_noti();
+	ret = contacts_svc_end_trans(true);
+	retvm_if(ret < CTS_SUCCESS, ret, "contacts_svc_end_trans() Failed(%d)", ret);
+
+	return CTS_SUCCESS;
+}
+
+/*
+ * A batch deletes batch_size contacts(and their rows by trg_contacts_del) with
+ * their change records and then
+ * batch_size tombstones. After all of them, the addressbook itself is deleted.
+ * It returns the number of deleted contacts.
+ */
+static int cts_delete_addressbook_batch(int addressbook_id, int batch_size, bool *done)
+{
+	int i, ret, deleted;
+	int *ids;
+	cts_stmt stmt = NULL;
+	char query[CTS_SQL_MIN_LEN] = {0};
+
+	*done = false;
+
+	ids = malloc(batch_size * sizeof(int));
+	retvm_if(NULL == ids, CTS_ERR_OUT_OF_MEMORY, "malloc() Failed");
+
+	ret = contacts_svc_begin_trans();
+	if (ret) {
+		ERR("contacts_svc_begin_trans() Failed(%d)", ret);
+		free(ids);
+		return ret;
+	}
+
+	snprintf(query, sizeof(query), "SELECT contact_id FROM %s WHERE addrbook_id = %d LIMIT %d",
+			CTS_TABLE_CONTACTS, addressbook_id, batch_size);
+	stmt = cts_query_prepare(query);
+	if (NULL == stmt) {
+		ERR("cts_query_prepare() Failed");
+		contacts_svc_end_trans(false);
+		free(ids);
+		return CTS_ERR_DB_FAILED;
+	}
+	deleted = 0;
+	while (deleted < batch_size && CTS_TRUE == (ret = cts_stmt_step(stmt)))
+		ids[deleted++] = cts_stmt_get_int(stmt, 0);
+	cts_stmt_finalize(stmt);
+	if (ret < CTS_SUCCESS) {
+		ERR("cts_stmt_step() Failed(%d)", ret);
+		contacts_svc_end_trans(false);
+		free(ids);
+		return ret;
+	}
+
+	snprintf(query, sizeof(query), "DELETE FROM %s WHERE contact_id = ?", CTS_TABLE_CONTACTS);
+	stmt = cts_query_prepare(query);
+	if (NULL == stmt) {
+		ERR("cts_query_prepare() Failed");
+		contacts_svc_end_trans(false);
+		free(ids);
+		return CTS_ERR_DB_FAILED;
+	}
+	for (i=0;i<deleted;i++) {
+		cts_stmt_bind_int(stmt, 1, ids[i]);
+		ret = cts_stmt_step(stmt);
+		if (CTS_SUCCESS != ret) {
+			ERR("cts_stmt_step() Failed(%d)", ret);
+			cts_stmt_finalize(stmt);
+			contacts_svc_end_trans(false);
+			free(ids);
+			return ret;
+		}
+		cts_stmt_reset(stmt);
+		cts_add_change_noti(CTS_CHANGE_TABLE_CONTACT, ids[i], CTS_OPERATION_DELETED);
+	}
+	cts_stmt_finalize(stmt);
+	free(ids);
+
+	if (deleted) {
+		ret = cts_person_garbagecollection();
+		if (CTS_SUCCESS != ret) {
+			ERR("cts_person_garbagecollection() Failed(%d)", ret);
+			contacts_svc_end_trans(false);
+			return ret;
+		}
+		cts_set_contact_noti();
+	}
+	else {
+		snprintf(query, sizeof(query),
+				"DELETE FROM %s WHERE rowid IN "
+				"(SELECT rowid FROM %s WHERE addrbook_id = %d LIMIT %d)",
+				CTS_TABLE_DELETEDS, CTS_TABLE_DELETEDS, addressbook_id, batch_size);
+		ret = cts_query_exec(query);
+		if (CTS_SUCCESS != ret) {
+			ERR("cts_query_exec() Failed(%d)", ret);
+			contacts_svc_end_trans(false);
+			return ret;
+		}
+
+		if (0 == cts_db_change()) {
+			/* trg_addressbook_del removes the groups and the rest */
+			snprintf(query, sizeof(query), "DELETE FROM %s WHERE addrbook_id = %d",
+					CTS_TABLE_ADDRESSBOOKS, addressbook_id);
+			ret = cts_query_exec(query);
+			if (CTS_SUCCESS != ret) {
+				ERR("cts_query_exec() Failed(%d)", ret);
+				contacts_svc_end_trans(false);
+				return ret;
+			}
+			cts_set_group_noti();
+			cts_set_addrbook_noti();
+			cts_add_change_noti(CTS_CHANGE_TABLE_ADDRESSBOOK, addressbook_id,
+					CTS_OPERATION_DELETED);
+			cts_addrbook_deleting = -1;
+			*done = true;
+		}
+	}
+
+	ret = contacts_svc_end_trans(true);
+	retvm_if(ret < CTS_SUCCESS, ret, "contacts_svc_end_trans() Failed(%d)", ret);
+
+	return deleted;
+}
+
+static gboolean cts_delete_addressbook_idle(gpointer data)
+{
+	int ret;
+	bool done, canceled = false;
+
+	ret = cts_delete_addressbook_batch(cts_addrbook_deletion.addrbook_id,
+			cts_addrbook_deletion.batch_size, &done);
+	if (CTS_SUCCESS <= ret) {
+		cts_addrbook_deletion.deleted += ret;
+		/* Other writers can delete or add contacts of the addressbook meanwhile */
+		if (done)
+			cts_addrbook_deletion.total = cts_addrbook_deletion.deleted;
+
+		/* every batch(including the tombstones and the last one) is reported */
+		if (cts_addrbook_deletion.progress_cb)
+			canceled = cts_addrbook_deletion.progress_cb(cts_addrbook_deletion.deleted,
+					cts_addrbook_deletion.total, cts_addrbook_deletion.user_data);
+
+		if (done) {
+			INFO("The addressbook(%d) is deleted with %d contacts",
+					cts_addrbook_deletion.addrbook_id, cts_addrbook_deletion.deleted);
+			ret = CTS_SUCCESS;
+		}
+		else if (canceled)
+			ret = CTS_ERR_CANCELED;
+		else
+			return TRUE;
+	}
+	else
+		ERR("cts_delete_addressbook_batch() Failed(%d)", ret);
+
+	/* The deleted contacts are not restored. The rest is shown again. */
+	if (CTS_SUCCESS != ret) {
+		int err = cts_set_addressbook_deleting(cts_addrbook_deletion.addrbook_id, false);
+		warn_if(CTS_SUCCESS != err, "cts_set_addressbook_deleting() Failed(%d)", err);
+	}
+
+	cts_addrbook_deletion.running = false;
+	if (cts_addrbook_deletion.done_cb)
+		cts_addrbook_deletion.done_cb(cts_addrbook_deletion.addrbook_id, ret,
+				cts_addrbook_deletion.user_data);
+
+	return FALSE;
+}
+
+API int contacts_svc_delete_addressbook_async(int addressbook_id, int batch_size,
+		cts_addrbook_delete_progress_fn progress_cb, cts_addrbook_delete_done_fn done_cb,
+		void *user_data)
+{
+	int ret, total;
+	char query[CTS_SQL_MIN_LEN] = {0};
+
+	retvm_if(CTS_ADDRESSBOOK_INTERNAL == addressbook_id, CTS_ERR_ARG_INVALID,
+			"The internal addressbook cannot be deleted");
+	retvm_if(batch_size < 0, CTS_ERR_ARG_INVALID, "The batch_size(%d) is invalid", batch_size);
+	retvm_if(cts_addrbook_deletion.running, CTS_ERR_ALREADY_RUNNING,
+			"The addressbook(%d) is being deleted", cts_addrbook_deletion.addrbook_id);
+
+	snprintf(query, sizeof(query), "SELECT COUNT(*) FROM %s WHERE addrbook_id = %d",
+			CTS_TABLE_CONTACTS, addressbook_id);
+	total = cts_query_get_first_int_result(query);
+	retvm_if(total < CTS_SUCCESS, total, "cts_query_get_first_int_result() Failed(%d)", total);
+
+	ret = cts_set_addressbook_deleting(addressbook_id, true);
+	retvm_if(CTS_SUCCESS != ret, ret, "cts_set_addressbook_deleting() Failed(%d)", ret);
+
+	cts_addrbook_deletion.running = true;
+	cts_addrbook_deletion.addrbook_id = addressbook_id;
+	cts_addrbook_deletion.batch_size = batch_size?batch_size:CTS_ADDRBOOK_DELETE_BATCH_DEFAULT;
+	cts_addrbook_deletion.deleted = 0;
+	cts_addrbook_deletion.total = total;
+	cts_addrbook_deletion.progress_cb = progress_cb;
+	cts_addrbook_deletion.done_cb = done_cb;
+	cts_addrbook_deletion.user_data = user_data;
+
+	g_idle_add(cts_delete_addressbook_idle, NULL);
+
+	return CTS_SUCCESS;
+}
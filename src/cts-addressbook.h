@@ -30,6 +30,8 @@ enum ADDRESSBOOK{
 	CTS_ADDRESSBOOK_START,
 };
 
+const char* cts_addressbook_get_visible_data(void);
+
 #ifndef __CONTACTS_SVC_H__
 
 
@@ -196,6 +198,102 @@ int contacts_svc_update_addressbook(CTSvalue *addressbook);
  */
 int contacts_svc_get_addressbook(int addressbook_id, CTSvalue **ret_value);
 
+/**
+ * This function sets the last version which the addressbook has synchronized.
+ * The deleted records(tombstones) of the version and older versions can be removed
+ * by contacts_svc_compact_tombstones() after all addressbooks are synchronized with them.
+ * The internal addressbook cannot be set.
+ *
+ * @param[in] addressbook_id The index of addressbook
+ * @param[in] version The contacts version which is synchronized
+ * @return #CTS_SUCCESS on success, Negative value(#cts_error) on error
+ */
+int contacts_svc_set_addressbook_sync_ver(int addressbook_id, int version);
+
+/**
+ * This function removes the tombstones of contacts, groups and group relations
+ * which every addressbook has already synchronized(see contacts_svc_set_addressbook_sync_ver()).
+ * An addressbook which has never set the synchronized version keeps all tombstones.
+ * If there is no addressbook except the internal one, no tombstone is removed.
+ * The tombstones are removed by batch_size rows per transaction not to block other writers long.
+ *
+ * @param[in] batch_size The maximum number of rows which are removed in a transaction.
+ * 0 means the default size.
+ * @return The number of removed rows on success, Negative value(#cts_error) on error
+ */
+int contacts_svc_compact_tombstones(int batch_size);
+
+/**
+ * This is the signature of a callback function added with contacts_svc_compact_tombstones_async().
+ *
+ * @param[in] result The number of removed rows on success, Negative value(#cts_error) on error
+ * @param[in] user_data The data which is set by contacts_svc_compact_tombstones_async()
+ */
+typedef void (*cts_compact_fn)(int result, void *user_data);
+
+/**
+ * This function removes the tombstones like contacts_svc_compact_tombstones() in the background.
+ * A batch is processed in each idle time of default context of g_main_loop.
+ * When all batches are done, cb is called.
+ *
+ * @param[in] batch_size The maximum number of rows which are removed in a batch.
+ * 0 means the default size.
+ * @param[in] cb callback function pointer(#cts_compact_fn). It can be NULL.
+ * @param[in] user_data data which is passed to callback function
+ * @return #CTS_SUCCESS on success, #CTS_ERR_ALREADY_RUNNING if it is running,
+ * Negative value(#cts_error) on error
+ */
+int contacts_svc_compact_tombstones_async(int batch_size, cts_compact_fn cb, void *user_data);
+
+/**
+ * This is the signature of a progress callback function added with
+ * contacts_svc_delete_addressbook_async(). It is called after each batch
+ * of contacts or tombstones. The last call, after the addressbook is deleted,
+ * has deleted == total and its return value is ignored.
+ *
+ * @param[in] deleted The number of contacts which are deleted
+ * @param[in] total The number of contacts which the addressbook had
+ * @param[in] user_data The data which is set by contacts_svc_delete_addressbook_async()
+ * @return #CTS_SUCCESS to continue, other value to cancel
+ */
+typedef int (*cts_addrbook_delete_progress_fn)(int deleted, int total, void *user_data);
+
+/**
+ * This is the signature of a callback function added with contacts_svc_delete_addressbook_async().
+ * It is called once when the deletion is finished, canceled or failed.
+ *
+ * @param[in] addressbook_id The index of addressbook
+ * @param[in] result #CTS_SUCCESS on success, #CTS_ERR_CANCELED if it is canceled,
+ * Negative value(#cts_error) on error
+ * @param[in] user_data The data which is set by contacts_svc_delete_addressbook_async()
+ */
+typedef void (*cts_addrbook_delete_done_fn)(int addressbook_id, int result, void *user_data);
+
+/**
+ * This function deletes an addressbook like contacts_svc_delete_addressbook() in the background.
+ * The addressbook is hidden from contacts_svc_get_addressbook() and the addressbook lists
+ * immediately, and its contacts are hidden from the contact lists, searches and counts.
+ * Its contacts are deleted by batch_size contacts per transaction
+ * in each idle time of default context of g_main_loop, so other writers can run between batches.
+ * When it is canceled or failed, the contacts which are already deleted are not restored
+ * and the addressbook is shown again.
+ * If the process exits before the deletion is finished, contacts-svc-helper resumes it.
+ * Only one addressbook can be deleted at a time.
+ *
+ * @param[in] addressbook_id The index of addressbook. The internal addressbook is not allowed.
+ * @param[in] batch_size The maximum number of contacts which are deleted in a batch.
+ * 0 means the default size.
+ * @param[in] progress_cb progress callback function pointer(#cts_addrbook_delete_progress_fn).
+ * It can be NULL.
+ * @param[in] done_cb callback function pointer(#cts_addrbook_delete_done_fn). It can be NULL.
+ * @param[in] user_data data which is passed to callback functions
+ * @return #CTS_SUCCESS on success, #CTS_ERR_ALREADY_RUNNING if a deletion is running,
+ * Negative value(#cts_error) on error
+ */
+int contacts_svc_delete_addressbook_async(int addressbook_id, int batch_size,
+		cts_addrbook_delete_progress_fn progress_cb, cts_addrbook_delete_done_fn done_cb,
+		void *user_data);
+
 /**
  * @}
  */
@@ -38,56 +38,43 @@
 #define CTS_MAIN_CTS_GET_IMG (1<<6)
 #define CTS_MAIN_CTS_GET_ALL (1<<0|1<<1|1<<2|1<<3|1<<4|1<<5|1<<6)
 
-static int cts_get_main_contacts_info(int op_code, int index, contact_t *contact)
+static inline int cts_make_main_contacts_query(int op_code, char *dest, int dest_size)
 {
-	int ret, len;
-	cts_stmt stmt = NULL;
-	char query[CTS_SQL_MAX_LEN] = {0};
-	char *temp;
+	int len;
 
-	len = snprintf(query, sizeof(query), "SELECT ");
+	len = snprintf(dest, dest_size, "SELECT ");
 
-	len += snprintf(query+len, sizeof(query)-len,
+	len += snprintf(dest+len, dest_size-len,
 			"contact_id, person_id, addrbook_id, changed_time");
 
 	if(op_code & CTS_MAIN_CTS_GET_UID)
-		len += snprintf(query+len, sizeof(query)-len, ", uid");
+		len += snprintf(dest+len, dest_size-len, ", uid");
 	if (op_code & CTS_MAIN_CTS_GET_RINGTON)
-		len += snprintf(query+len, sizeof(query)-len, ", ringtone");
+		len += snprintf(dest+len, dest_size-len, ", ringtone");
 	if (op_code & CTS_MAIN_CTS_GET_NOTE)
-		len += snprintf(query+len, sizeof(query)-len, ", note");
+		len += snprintf(dest+len, dest_size-len, ", note");
 	if (op_code & CTS_MAIN_CTS_GET_DEFAULT_NUM)
-		len += snprintf(query+len, sizeof(query)-len, ", default_num");
+		len += snprintf(dest+len, dest_size-len, ", default_num");
 	if (op_code & CTS_MAIN_CTS_GET_DEFAULT_EMAIL)
-		len += snprintf(query+len, sizeof(query)-len, ", default_email");
+		len += snprintf(dest+len, dest_size-len, ", default_email");
 	if (op_code & CTS_MAIN_CTS_GET_FAVOR)
-		len += snprintf(query+len, sizeof(query)-len, ", is_favorite");
+		len += snprintf(dest+len, dest_size-len, ", is_favorite");
 	if (op_code & CTS_MAIN_CTS_GET_IMG) {
-		len += snprintf(query+len, sizeof(query)-len, ", image0");
-		len += snprintf(query+len, sizeof(query)-len, ", image1");
+		len += snprintf(dest+len, dest_size-len, ", image0");
+		len += snprintf(dest+len, dest_size-len, ", image1");
 	}
 
-	snprintf(query+len, sizeof(query)-len,
-			" FROM %s WHERE contact_id = %d", CTS_TABLE_CONTACTS, index);
-
-	stmt = cts_query_prepare(query);
-	retvm_if(NULL == stmt, CTS_ERR_DB_FAILED, "cts_query_prepare() Failed");
+	return len;
+}
 
-	ret = cts_stmt_step(stmt);
-	if (CTS_TRUE != ret)
-	{
-		ERR("cts_stmt_step() Failed(%d)", ret);
-		cts_stmt_finalize(stmt);
-		return CTS_ERR_DB_RECORD_NOT_FOUND;
-	}
+static int cts_stmt_get_main_contacts_info(int op_code, cts_stmt stmt, contact_t *contact)
+{
 	int count=0;
+	char *temp;
 
 	contact->base = (cts_ct_base *)contacts_svc_value_new(CTS_VALUE_CONTACT_BASE_INFO);
-	if (NULL == contact->base) {
-		cts_stmt_finalize(stmt);
-		ERR("contacts_svc_value_new(CTS_VALUE_CONTACT_BASE_INFO) Failed");
-		return CTS_ERR_OUT_OF_MEMORY;
-	}
+	retvm_if(NULL == contact->base, CTS_ERR_OUT_OF_MEMORY,
+			"contacts_svc_value_new(CTS_VALUE_CONTACT_BASE_INFO) Failed");
 
 	contact->base->id = cts_stmt_get_int(stmt, count++);
 	contact->base->person_id = cts_stmt_get_int(stmt, count++);
@@ -137,9 +124,34 @@ static int cts_get_main_contacts_info(int op_code, int index, contact_t *contact
 		}
 	}
 
+	return CTS_SUCCESS;
+}
+
+static int cts_get_main_contacts_info(int op_code, int index, contact_t *contact)
+{
+	int ret, len;
+	cts_stmt stmt = NULL;
+	char query[CTS_SQL_MAX_LEN] = {0};
+
+	len = cts_make_main_contacts_query(op_code, query, sizeof(query));
+	snprintf(query+len, sizeof(query)-len,
+			" FROM %s WHERE contact_id = %d", CTS_TABLE_CONTACTS, index);
+
+	stmt = cts_query_prepare(query);
+	retvm_if(NULL == stmt, CTS_ERR_DB_FAILED, "cts_query_prepare() Failed");
+
+	ret = cts_stmt_step(stmt);
+	if (CTS_TRUE != ret)
+	{
+		ERR("cts_stmt_step() Failed(%d)", ret);
+		cts_stmt_finalize(stmt);
+		return CTS_ERR_DB_RECORD_NOT_FOUND;
+	}
+
+	ret = cts_stmt_get_main_contacts_info(op_code, stmt, contact);
 	cts_stmt_finalize(stmt);
 
-	return CTS_SUCCESS;
+	return ret;
 }
 
 static inline int cts_get_data_info_number(cts_stmt stmt, contact_t *contact)
@@ -379,105 +391,165 @@ static inline int cts_get_data_info_extend(cts_stmt stmt, int type,
 }
 
 
-int cts_get_data_info(int op_code, int field, int index, contact_t *contact)
+static inline int cts_append_data_field_cond(int field, char *dest, int dest_size)
 {
-	int ret, datatype, len;
-	const char *data;
-	cts_stmt stmt = NULL;
-	char query[CTS_SQL_MAX_LEN] = {0};
-
-	if (cts_restriction_get_permit())
-		data = CTS_TABLE_DATA;
-	else
-		data = CTS_TABLE_RESTRICTED_DATA_VIEW;
-
-	switch (op_code)
-	{
-	case CTS_GET_DATA_BY_CONTACT_ID:
-		len = snprintf(query, sizeof(query), "SELECT datatype, id, data1, data2,"
-				"data3, data4, data5, data6, data7, data8, data9, data10 "
-				"FROM %s WHERE contact_id = %d", data, index);
-		break;
-	case CTS_GET_DATA_BY_ID:
-	default:
-		ERR("Invalid parameter : The op_code(%d) is not supported", op_code);
-		return CTS_ERR_ARG_INVALID;
-	}
+	int len = 0;
 
 	if (CTS_DATA_FIELD_ALL != field && CTS_DATA_FIELD_EXTEND_ALL != field)
 	{
 		bool first= true;
-		len += snprintf(query+len, sizeof(query)-len, " AND datatype IN (");
+		len += snprintf(dest+len, dest_size-len, " AND datatype IN (");
 
 		if (field & CTS_DATA_FIELD_NAME) {
 			first=false;
-			len += snprintf(query+len, sizeof(query)-len, "%d", CTS_DATA_NAME);
+			len += snprintf(dest+len, dest_size-len, "%d", CTS_DATA_NAME);
 		}
 		if (field & CTS_DATA_FIELD_EVENT) {
 			if (first)
 				first=false;
 			else
-				len += snprintf(query+len, sizeof(query)-len, ", ");
-			len += snprintf(query+len, sizeof(query)-len, "%d", CTS_DATA_EVENT);
+				len += snprintf(dest+len, dest_size-len, ", ");
+			len += snprintf(dest+len, dest_size-len, "%d", CTS_DATA_EVENT);
 		}
 		if (field & CTS_DATA_FIELD_MESSENGER) {
 			if (first)
 				first=false;
 			else
-				len += snprintf(query+len, sizeof(query)-len, ", ");
-			len += snprintf(query+len, sizeof(query)-len, "%d", CTS_DATA_MESSENGER);
+				len += snprintf(dest+len, dest_size-len, ", ");
+			len += snprintf(dest+len, dest_size-len, "%d", CTS_DATA_MESSENGER);
 		}
 		if (field & CTS_DATA_FIELD_POSTAL) {
 			if (first)
 				first=false;
 			else
-				len += snprintf(query+len, sizeof(query)-len, ", ");
-			len += snprintf(query+len, sizeof(query)-len, "%d", CTS_DATA_POSTAL);
+				len += snprintf(dest+len, dest_size-len, ", ");
+			len += snprintf(dest+len, dest_size-len, "%d", CTS_DATA_POSTAL);
 		}
 		if (field & CTS_DATA_FIELD_WEB) {
 			if (first)
 				first=false;
 			else
-				len += snprintf(query+len, sizeof(query)-len, ", ");
-			len += snprintf(query+len, sizeof(query)-len, "%d", CTS_DATA_WEB);
+				len += snprintf(dest+len, dest_size-len, ", ");
+			len += snprintf(dest+len, dest_size-len, "%d", CTS_DATA_WEB);
 		}
 		if (field & CTS_DATA_FIELD_NICKNAME) {
 			if (first)
 				first=false;
 			else
-				len += snprintf(query+len, sizeof(query)-len, ", ");
-			len += snprintf(query+len, sizeof(query)-len, "%d", CTS_DATA_NICKNAME);
+				len += snprintf(dest+len, dest_size-len, ", ");
+			len += snprintf(dest+len, dest_size-len, "%d", CTS_DATA_NICKNAME);
 		}
 		if (field & CTS_DATA_FIELD_COMPANY) {
 			if (first)
 				first=false;
 			else
-				len += snprintf(query+len, sizeof(query)-len, ", ");
-			len += snprintf(query+len, sizeof(query)-len, "%d", CTS_DATA_COMPANY);
+				len += snprintf(dest+len, dest_size-len, ", ");
+			len += snprintf(dest+len, dest_size-len, "%d", CTS_DATA_COMPANY);
 		}
 		if (field & CTS_DATA_FIELD_NUMBER) {
 			if (first)
 				first=false;
 			else
-				len += snprintf(query+len, sizeof(query)-len, ", ");
-			len += snprintf(query+len, sizeof(query)-len, "%d", CTS_DATA_NUMBER);
+				len += snprintf(dest+len, dest_size-len, ", ");
+			len += snprintf(dest+len, dest_size-len, "%d", CTS_DATA_NUMBER);
 		}
 		if (field & CTS_DATA_FIELD_EMAIL) {
 			if (first)
 				first=false;
 			else
-				len += snprintf(query+len, sizeof(query)-len, ", ");
-			len += snprintf(query+len, sizeof(query)-len, "%d", CTS_DATA_EMAIL);
+				len += snprintf(dest+len, dest_size-len, ", ");
+			len += snprintf(dest+len, dest_size-len, "%d", CTS_DATA_EMAIL);
 		}
 
-		len += snprintf(query+len, sizeof(query)-len, ")");
+		len += snprintf(dest+len, dest_size-len, ")");
 	}
 
 	if (CTS_DATA_FIELD_ALL != field && field & CTS_DATA_FIELD_EXTEND_ALL) {
-		len += snprintf(query+len, sizeof(query)-len, " AND datatype>=%d",
+		len += snprintf(dest+len, dest_size-len, " AND datatype>=%d",
 				CTS_DATA_EXTEND_START);
 	}
 
+	return len;
+}
+
+static inline void cts_get_data_info_row(cts_stmt stmt, contact_t *contact)
+{
+	int datatype;
+
+	datatype = cts_stmt_get_int(stmt, 0);
+
+	switch (datatype)
+	{
+	case CTS_DATA_NAME:
+		if (contact->name)
+			ERR("name already Exist");
+		else
+			contact->name = cts_get_data_info_name(stmt);
+		break;
+	case CTS_DATA_EVENT:
+		cts_get_data_info_event(stmt, contact);
+		break;
+	case CTS_DATA_MESSENGER:
+		cts_get_data_info_messenger(stmt, contact);
+		break;
+	case CTS_DATA_POSTAL:
+		cts_get_data_info_postal(stmt, contact);
+		break;
+	case CTS_DATA_WEB:
+		cts_get_data_info_web(stmt, contact);
+		break;
+	case CTS_DATA_NICKNAME:
+		cts_get_data_info_nick(stmt, contact);
+		break;
+	case CTS_DATA_NUMBER:
+		cts_get_data_info_number(stmt, contact);
+		break;
+	case CTS_DATA_EMAIL:
+		cts_get_data_info_email(stmt, contact);
+		break;
+	case CTS_DATA_COMPANY:
+		if (contact->company)
+			ERR("company already Exist");
+		else
+			contact->company = cts_get_data_info_company(stmt);
+		break;
+	default:
+		if (CTS_DATA_EXTEND_START <= datatype) {
+			cts_get_data_info_extend(stmt, datatype, contact);
+			break;
+		}
+		ERR("Unknown data type(%d)", datatype);
+		break;
+	}
+}
+
+int cts_get_data_info(int op_code, int field, int index, contact_t *contact)
+{
+	int ret, len;
+	const char *data;
+	cts_stmt stmt = NULL;
+	char query[CTS_SQL_MAX_LEN] = {0};
+
+	if (cts_restriction_get_permit())
+		data = CTS_TABLE_DATA;
+	else
+		data = CTS_TABLE_RESTRICTED_DATA_VIEW;
+
+	switch (op_code)
+	{
+	case CTS_GET_DATA_BY_CONTACT_ID:
+		len = snprintf(query, sizeof(query), "SELECT datatype, id, data1, data2,"
+				"data3, data4, data5, data6, data7, data8, data9, data10 "
+				"FROM %s WHERE contact_id = %d", data, index);
+		break;
+	case CTS_GET_DATA_BY_ID:
+	default:
+		ERR("Invalid parameter : The op_code(%d) is not supported", op_code);
+		return CTS_ERR_ARG_INVALID;
+	}
+
+	len += cts_append_data_field_cond(field, query+len, sizeof(query)-len);
+
 	stmt = cts_query_prepare(query);
 	retvm_if(NULL == stmt, CTS_ERR_DB_FAILED, "cts_query_prepare() Failed");
 
@@ -490,51 +562,7 @@ int cts_get_data_info(int op_code, int field, int index, contact_t *contact)
 	}
 
 	do {
-		datatype = cts_stmt_get_int(stmt, 0);
-
-		switch (datatype)
-		{
-		case CTS_DATA_NAME:
-			if (contact->name)
-				ERR("name already Exist");
-			else
-				contact->name = cts_get_data_info_name(stmt);
-			break;
-		case CTS_DATA_EVENT:
-			cts_get_data_info_event(stmt, contact);
-			break;
-		case CTS_DATA_MESSENGER:
-			cts_get_data_info_messenger(stmt, contact);
-			break;
-		case CTS_DATA_POSTAL:
-			cts_get_data_info_postal(stmt, contact);
-			break;
-		case CTS_DATA_WEB:
-			cts_get_data_info_web(stmt, contact);
-			break;
-		case CTS_DATA_NICKNAME:
-			cts_get_data_info_nick(stmt, contact);
-			break;
-		case CTS_DATA_NUMBER:
-			cts_get_data_info_number(stmt, contact);
-			break;
-		case CTS_DATA_EMAIL:
-			cts_get_data_info_email(stmt, contact);
-			break;
-		case CTS_DATA_COMPANY:
-			if (contact->company)
-				ERR("company already Exist");
-			else
-				contact->company = cts_get_data_info_company(stmt);
-			break;
-		default:
-			if (CTS_DATA_EXTEND_START <= datatype) {
-				cts_get_data_info_extend(stmt, datatype, contact);
-				break;
-			}
-			ERR("Unknown data type(%d)", datatype);
-			continue;
-		}
+		cts_get_data_info_row(stmt, contact);
 	}while(CTS_TRUE == cts_stmt_step(stmt));
 
 	cts_stmt_finalize(stmt);
@@ -582,6 +610,186 @@ static inline int cts_get_groups_info(int index, contact_t *contact)
 
 }
 
+static inline contact_t* cts_find_contact_in_batch(int id, const int *ids,
+		contact_t **records, int cnt)
+{
+	int i;
+	for (i=0;i<cnt;i++)
+		if (ids[i] == id)
+			return records[i];
+	return NULL;
+}
+
+static inline int cts_get_main_contacts_info_batch(const char *id_list,
+		const int *ids, contact_t **records, int cnt)
+{
+	int ret, i, len;
+	cts_stmt stmt;
+	contact_t *record;
+	char query[CTS_SQL_MAX_LEN] = {0};
+
+	len = cts_make_main_contacts_query(CTS_MAIN_CTS_GET_ALL, query, sizeof(query));
+	snprintf(query+len, sizeof(query)-len,
+			" FROM %s WHERE contact_id IN (%s)", CTS_TABLE_CONTACTS, id_list);
+
+	stmt = cts_query_prepare(query);
+	retvm_if(NULL == stmt, CTS_ERR_DB_FAILED, "cts_query_prepare() Failed");
+
+	while (CTS_TRUE == (ret = cts_stmt_step(stmt))) {
+		record = cts_find_contact_in_batch(cts_stmt_get_int(stmt, 0), ids, records, cnt);
+		if (NULL == record || record->base)
+			continue;
+		ret = cts_stmt_get_main_contacts_info(CTS_MAIN_CTS_GET_ALL, stmt, record);
+		if (CTS_SUCCESS != ret) {
+			ERR("cts_stmt_get_main_contacts_info() Failed(%d)", ret);
+			cts_stmt_finalize(stmt);
+			return ret;
+		}
+	}
+	cts_stmt_finalize(stmt);
+	retvm_if(ret < CTS_SUCCESS, ret, "cts_stmt_step() Failed(%d)", ret);
+
+	for (i=0;i<cnt;i++) {
+		if (NULL == records[i]->base) {
+			contacts_svc_struct_free((CTSstruct *)records[i]);
+			records[i] = NULL;
+		}
+	}
+
+	return CTS_SUCCESS;
+}
+
+static inline int cts_get_data_info_batch(int field, const char *id_list,
+		const int *ids, contact_t **records, int cnt)
+{
+	int ret, len;
+	const char *data;
+	cts_stmt stmt;
+	contact_t *record;
+	char query[CTS_SQL_MAX_LEN] = {0};
+
+	if (cts_restriction_get_permit())
+		data = CTS_TABLE_DATA;
+	else
+		data = CTS_TABLE_RESTRICTED_DATA_VIEW;
+
+	/* contact_id is the last column not to shift the columns of data row */
+	len = snprintf(query, sizeof(query), "SELECT datatype, id, data1, data2,"
+			"data3, data4, data5, data6, data7, data8, data9, data10, contact_id "
+			"FROM %s WHERE contact_id IN (%s)", data, id_list);
+	cts_append_data_field_cond(field, query+len, sizeof(query)-len);
+
+	stmt = cts_query_prepare(query);
+	retvm_if(NULL == stmt, CTS_ERR_DB_FAILED, "cts_query_prepare() Failed");
+
+	while (CTS_TRUE == (ret = cts_stmt_step(stmt))) {
+		record = cts_find_contact_in_batch(cts_stmt_get_int(stmt, 12), ids, records, cnt);
+		if (record)
+			cts_get_data_info_row(stmt, record);
+	}
+	cts_stmt_finalize(stmt);
+	retvm_if(ret < CTS_SUCCESS, ret, "cts_stmt_step() Failed(%d)", ret);
+
+	return CTS_SUCCESS;
+}
+
+static inline int cts_get_groups_info_batch(const char *id_list,
+		const int *ids, contact_t **records, int cnt)
+{
+	int ret;
+	cts_stmt stmt;
+	contact_t *record;
+	cts_group *group_info;
+	char query[CTS_SQL_MAX_LEN] = {0};
+
+	snprintf(query, sizeof(query), "SELECT B.contact_id, A.group_id, A.addrbook_id,"
+			" A.group_name"
+			" FROM %s A JOIN %s B ON A.group_id = B.group_id"
+			" WHERE B.contact_id IN (%s)"
+			" ORDER BY A.group_name COLLATE NOCASE",
+			CTS_TABLE_GROUPS, CTS_TABLE_GROUPING_INFO, id_list);
+
+	stmt = cts_query_prepare(query);
+	retvm_if(NULL == stmt, CTS_ERR_DB_FAILED, "cts_query_prepare() Failed");
+
+	while (CTS_TRUE == (ret = cts_stmt_step(stmt))) {
+		record = cts_find_contact_in_batch(cts_stmt_get_int(stmt, 0), ids, records, cnt);
+		if (NULL == record)
+			continue;
+
+		group_info = (cts_group *)contacts_svc_value_new(CTS_VALUE_GROUP_RELATION);
+		if (group_info) {
+			group_info->id = cts_stmt_get_int(stmt, 1);
+			group_info->addrbook_id = cts_stmt_get_int(stmt, 2);
+			group_info->embedded = true;
+			group_info->name = SAFE_STRDUP(cts_stmt_get_text(stmt, 3));
+			group_info->img_loaded = false; //It will load at cts_value_get_str_group()
+
+			record->grouprelations = g_slist_append(record->grouprelations, group_info);
+		}
+	}
+	cts_stmt_finalize(stmt);
+	retvm_if(ret < CTS_SUCCESS, ret, "cts_stmt_step() Failed(%d)", ret);
+
+	return CTS_SUCCESS;
+}
+
+/* The contacts which are not found are set to NULL.
+ * If field is CTS_DATA_FIELD_ALL, group relations are also loaded. */
+int cts_get_contacts_batch(int field, const int *ids, int cnt, contact_t **records)
+{
+	int i, ret, len;
+	char id_list[CTS_SQL_MIN_LEN] = {0};
+
+	retv_if(NULL == ids, CTS_ERR_ARG_NULL);
+	retv_if(NULL == records, CTS_ERR_ARG_NULL);
+	retvm_if(cnt <= 0 || CTS_BATCH_CONTACTS_MAX < cnt, CTS_ERR_ARG_INVALID,
+			"The count(%d) is invalid", cnt);
+
+	memset(records, 0x00, sizeof(contact_t *) * cnt);
+
+	len = 0;
+	for (i=0;i<cnt;i++) {
+		len += snprintf(id_list+len, sizeof(id_list)-len, i?", %d":"%d", ids[i]);
+		records[i] = (contact_t *)contacts_svc_struct_new(CTS_STRUCT_CONTACT);
+		if (NULL == records[i]) {
+			ERR("contacts_svc_struct_new() Failed");
+			ret = CTS_ERR_OUT_OF_MEMORY;
+			goto CTS_RETURN_ERROR;
+		}
+	}
+
+	ret = cts_get_main_contacts_info_batch(id_list, ids, records, cnt);
+	if (CTS_SUCCESS != ret) {
+		ERR("cts_get_main_contacts_info_batch() Failed(%d)", ret);
+		goto CTS_RETURN_ERROR;
+	}
+
+	ret = cts_get_data_info_batch(field, id_list, ids, records, cnt);
+	if (CTS_SUCCESS != ret) {
+		ERR("cts_get_data_info_batch() Failed(%d)", ret);
+		goto CTS_RETURN_ERROR;
+	}
+
+	if (CTS_DATA_FIELD_ALL == field) {
+		ret = cts_get_groups_info_batch(id_list, ids, records, cnt);
+		if (CTS_SUCCESS != ret) {
+			ERR("cts_get_groups_info_batch() Failed(%d)", ret);
+			goto CTS_RETURN_ERROR;
+		}
+	}
+
+	return CTS_SUCCESS;
+
+CTS_RETURN_ERROR:
+	for (i=0;i<cnt;i++) {
+		if (records[i])
+			contacts_svc_struct_free((CTSstruct *)records[i]);
+		records[i] = NULL;
+	}
+	return ret;
+}
+
 static inline int cts_get_number_value(int op_code, int id, CTSvalue **value)
 {
 	int ret;
@@ -24,6 +24,7 @@
 #include "cts-schema.h"
 #include "cts-sqlite.h"
 #include "cts-utils.h"
+#include "cts-list.h"
 #include "cts-group.h"
 #include "cts-types.h"
 #include "cts-normalize.h"
@@ -923,8 +924,17 @@ static inline int cts_insert_contact(int addressbook_id, contact_t *contact)
 		cts_stmt_bind_text(stmt, 4, normal_img);
 	}
 	else if (contact->base->vcard_img_path) {
-		ret = cts_contact_add_image_file(CTS_IMG_NORMAL, contact->base->id, contact->base->vcard_img_path,
-				normal_img, sizeof(normal_img));
+		if (contact->base->vcard_img_movable) {
+			ret = cts_contact_move_image_file(CTS_IMG_NORMAL, contact->base->id,
+					contact->base->vcard_img_path, normal_img, sizeof(normal_img));
+			if (CTS_SUCCESS == ret) {
+				free(contact->base->vcard_img_path);
+				contact->base->vcard_img_path = NULL;
+			}
+		}
+		else
+			ret = cts_contact_add_image_file(CTS_IMG_NORMAL, contact->base->id,
+					contact->base->vcard_img_path, normal_img, sizeof(normal_img));
 		if (CTS_SUCCESS == ret)
 			cts_stmt_bind_text(stmt, 4, normal_img);
 	}
@@ -1001,6 +1011,7 @@ API int contacts_svc_insert_contact(int addressbook_id, CTSstruct* contact)
 	}
 
 	cts_set_contact_noti();
+	cts_add_change_noti(CTS_CHANGE_TABLE_CONTACT, record->base->id, CTS_OPERATION_INSERTED);
 	if (0 < ret)
 		cts_set_group_rel_noti();
 	ret = contacts_svc_end_trans(true);
@@ -1080,6 +1091,7 @@ API int contacts_svc_delete_contact(int index)
 	}
 
 	cts_set_contact_noti();
+	cts_add_change_noti(CTS_CHANGE_TABLE_CONTACT, index, CTS_OPERATION_DELETED);
 
 	ret = contacts_svc_end_trans(true);
 	CTS_END_TIME_CHECK();
@@ -2081,6 +2093,7 @@ static inline int cts_update_contact(contact_t *contact)
 	cts_stmt_finalize(stmt);
 
 	cts_set_contact_noti();
+	cts_add_change_noti(CTS_CHANGE_TABLE_CONTACT, contact->base->id, CTS_OPERATION_UPDATED);
 	if (0 < rel_changed)
 		cts_set_group_rel_noti();
 
@@ -2323,6 +2336,7 @@ API int contacts_svc_put_contact_value(cts_put_contact_val_op op_code,
 	}
 
 	cts_set_contact_noti();
+	cts_add_change_noti(CTS_CHANGE_TABLE_CONTACT, contact_id, CTS_OPERATION_UPDATED);
 
 	ret = contacts_svc_end_trans(true);
 	CTS_END_TIME_CHECK();
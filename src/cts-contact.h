@@ -28,6 +28,9 @@ enum{
 
 int cts_get_data_info(int op_code, int field, int index, contact_t *contact);
 
+#define CTS_BATCH_CONTACTS_MAX 64
+int cts_get_contacts_batch(int field, const int *ids, int cnt, contact_t **records);
+
 //<!--
 /**
  * @defgroup   CONTACTS_SVC_NAME Contact Naming Rule
@@ -36,6 +36,7 @@ typedef enum
 	CTS_ERR_VCONF_FAILED = -102, /**< -102 */
 	CTS_ERR_VOBJECT_FAILED = -101, /**< -101 */
 
+	CTS_ERR_CANCELED = -14, /**< -14 */
 	CTS_ERR_NO_SPACE = -13, /**< -13 */
 	CTS_ERR_IO_ERR = -12, /**< -12 */
 	CTS_ERR_MSG_INVALID = -11, /**< -11 */
@@ -23,8 +23,59 @@
 #include "cts-sqlite.h"
 #include "cts-utils.h"
 #include "cts-restriction.h"
+#include "cts-list.h"
 #include "cts-favorite.h"
 
+static int cts_favorite_change_noti(int type, int related_id)
+{
+	int ret;
+	cts_stmt stmt;
+	char query[CTS_SQL_MIN_LEN] = {0};
+
+	if (CTS_FAVOR_PERSON == type)
+		snprintf(query, sizeof(query), "SELECT contact_id FROM %s WHERE person_id = %d",
+				CTS_TABLE_CONTACTS, related_id);
+	else
+		snprintf(query, sizeof(query), "SELECT contact_id FROM %s WHERE id = %d",
+				CTS_TABLE_DATA, related_id);
+
+	stmt = cts_query_prepare(query);
+	retvm_if(NULL == stmt, CTS_ERR_DB_FAILED, "cts_query_prepare() Failed");
+
+	while (CTS_TRUE == (ret = cts_stmt_step(stmt)))
+		cts_add_change_noti(CTS_CHANGE_TABLE_CONTACT, cts_stmt_get_int(stmt, 0),
+				CTS_OPERATION_UPDATED);
+	cts_stmt_finalize(stmt);
+	retvm_if(CTS_SUCCESS != ret, ret, "cts_stmt_step() Failed(%d)", ret);
+
+	return CTS_SUCCESS;
+}
+
+static int cts_favorite_id_change_noti(int favorite_id)
+{
+	int ret, type, related_id;
+	cts_stmt stmt;
+	char query[CTS_SQL_MIN_LEN] = {0};
+
+	snprintf(query, sizeof(query), "SELECT type, related_id FROM %s WHERE id = %d",
+			CTS_TABLE_FAVORITES, favorite_id);
+
+	stmt = cts_query_prepare(query);
+	retvm_if(NULL == stmt, CTS_ERR_DB_FAILED, "cts_query_prepare() Failed");
+
+	ret = cts_stmt_step(stmt);
+	if (CTS_TRUE != ret) {
+		cts_stmt_finalize(stmt);
+		retvm_if(CTS_SUCCESS != ret, ret, "cts_stmt_step() Failed(%d)", ret);
+		return CTS_SUCCESS;
+	}
+	type = cts_stmt_get_int(stmt, 0);
+	related_id = cts_stmt_get_int(stmt, 1);
+	cts_stmt_finalize(stmt);
+
+	return cts_favorite_change_noti(type, related_id);
+}
+
 API int contacts_svc_set_favorite(cts_favor_type op, int related_id)
 {
 	int ret;
@@ -69,6 +120,12 @@ API int contacts_svc_set_favorite(cts_favor_type op, int related_id)
 		return ret;
 	}
 
+	ret = cts_favorite_change_noti(op, related_id);
+	if (CTS_SUCCESS != ret) {
+		ERR("cts_favorite_change_noti() Failed(%d)", ret);
+		contacts_svc_end_trans(false);
+		return ret;
+	}
 	cts_set_favor_noti();
 
 	ret = contacts_svc_end_trans(true);
@@ -118,6 +175,12 @@ API int contacts_svc_unset_favorite(cts_favor_type op, int related_id)
 	cts_stmt_finalize(stmt);
 
 	if (0 < ret) {
+		ret = cts_favorite_change_noti(op, related_id);
+		if (CTS_SUCCESS != ret) {
+			ERR("cts_favorite_change_noti() Failed(%d)", ret);
+			contacts_svc_end_trans(false);
+			return ret;
+		}
 		cts_set_favor_noti();
 		ret = contacts_svc_end_trans(true);
 	}
@@ -144,6 +207,13 @@ API int contacts_svc_delete_favorite(int favorite_id)
 	ret = contacts_svc_begin_trans();
 	retvm_if(ret, ret, "contacts_svc_begin_trans() Failed(%d)", ret);
 
+	ret = cts_favorite_id_change_noti(favorite_id);
+	if (CTS_SUCCESS != ret) {
+		ERR("cts_favorite_id_change_noti() Failed(%d)", ret);
+		contacts_svc_end_trans(false);
+		return ret;
+	}
+
 	stmt = cts_query_prepare(query);
 	retvm_if(NULL == stmt, CTS_ERR_DB_FAILED, "cts_query_prepare() Failed");
 
@@ -237,6 +307,13 @@ API int contacts_svc_favorite_order(int favorite_id,
 		contacts_svc_end_trans(false);
 		return ret;
 	}
+
+	ret = cts_favorite_id_change_noti(favorite_id);
+	if (CTS_SUCCESS != ret) {
+		ERR("cts_favorite_id_change_noti() Failed(%d)", ret);
+		contacts_svc_end_trans(false);
+		return ret;
+	}
 	cts_set_favor_noti();
 
 	ret = contacts_svc_end_trans(true);
@@ -129,6 +129,7 @@ API int contacts_svc_update_group(CTSvalue *group)
 	}
 
 	cts_set_group_noti();
+	cts_add_change_noti(CTS_CHANGE_TABLE_GROUP, record->id, CTS_OPERATION_UPDATED);
 
 	ret = contacts_svc_end_trans(true);
 	if (ret < CTS_SUCCESS)
@@ -193,6 +194,7 @@ API int contacts_svc_insert_group(int addressbook_id, CTSvalue *group)
 	}
 
 	cts_set_group_noti();
+	cts_add_change_noti(CTS_CHANGE_TABLE_GROUP, index, CTS_OPERATION_INSERTED);
 	ret = contacts_svc_end_trans(true);
 	retvm_if(ret < CTS_SUCCESS, ret,
 			"contacts_svc_end_trans(true) Failed(%d)", ret);
@@ -259,6 +261,7 @@ API int contacts_svc_delete_group_with_members(int index)
 
 		cts_set_contact_noti();
 		cts_set_group_noti();
+		cts_add_change_noti(CTS_CHANGE_TABLE_GROUP, index, CTS_OPERATION_DELETED);
 		ret = contacts_svc_end_trans(true);
 	} else {
 		contacts_svc_end_trans(false);
@@ -310,6 +313,7 @@ API int contacts_svc_delete_group(int index)
 		}
 
 		cts_set_group_noti();
+		cts_add_change_noti(CTS_CHANGE_TABLE_GROUP, index, CTS_OPERATION_DELETED);
 		ret = contacts_svc_end_trans(true);
 	} else {
 		contacts_svc_end_trans(false);
@@ -330,7 +334,7 @@ int cts_group_add_log(int group_id, int type)
 	char query[CTS_SQL_MIN_LEN];
 
 	snprintf(query, sizeof(query), "INSERT OR IGNORE INTO %s VALUES(%d, %d, %d)",
-			"group_relations_log", group_id, type, cts_get_next_ver());
+			CTS_TABLE_GROUP_RELATIONS_LOG, group_id, type, cts_get_next_ver());
 
 	stmt = cts_query_prepare(query);
 	retvm_if(NULL == stmt, CTS_ERR_DB_FAILED, "cts_query_prepare() Failed");
@@ -412,6 +416,7 @@ API int contacts_svc_group_set_relation(int group_id, int contact_id)
 	}
 
 	cts_set_contact_noti();
+	cts_add_change_noti(CTS_CHANGE_TABLE_CONTACT, contact_id, CTS_OPERATION_UPDATED);
 	if (0 < changed)
 		cts_set_group_rel_noti();
 	ret = contacts_svc_end_trans(true);
@@ -472,6 +477,7 @@ API int contacts_svc_group_unset_relation(int group_id, int contact_id)
 	}
 
 	cts_set_contact_noti();
+	cts_add_change_noti(CTS_CHANGE_TABLE_CONTACT, contact_id, CTS_OPERATION_UPDATED);
 	if (0 < changed)
 		cts_set_group_rel_noti();
 	ret = contacts_svc_end_trans(true);
@@ -24,6 +24,7 @@
 #include "cts-types.h"
 #include "cts-normalize.h"
 #include "cts-restriction.h"
+#include "cts-addressbook.h"
 #include "cts-list-filter.h"
 
 
@@ -149,10 +150,7 @@ static int cts_list_str_filter_make_query(CTSfilter *filter, CTSiter *iter)
 	else
 		display = CTS_SCHEMA_DATA_NAME_LOOKUP;
 
-	if (cts_restriction_get_permit())
-		data = CTS_TABLE_DATA;
-	else
-		data = CTS_TABLE_RESTRICTED_DATA_VIEW;
+	data = cts_addressbook_get_visible_data();
 
 	switch (filter->list_type) {
 	case CTS_FILTERED_PLOGS_OF_NUMBER:
@@ -405,10 +403,7 @@ static inline void cts_filter_make_query_ALL_CONTACT(CTSfilter *filter, char *bu
 	else
 		display = CTS_SCHEMA_DATA_NAME_LOOKUP;
 
-	if (cts_restriction_get_permit())
-		data = CTS_TABLE_DATA;
-	else
-		data = CTS_TABLE_RESTRICTED_DATA_VIEW;
+	data = cts_addressbook_get_visible_data();
 
 	if (filter->addrbook_on) {
 		ret = snprintf(buf, buf_size,
@@ -456,10 +451,7 @@ static inline void cts_filter_make_query_ALL_CONTACT_OSP(CTSfilter *filter, char
 	else
 		display = CTS_SCHEMA_DATA_NAME_LOOKUP;
 
-	if (cts_restriction_get_permit())
-		data = CTS_TABLE_DATA;
-	else
-		data = CTS_TABLE_RESTRICTED_DATA_VIEW;
+	data = cts_addressbook_get_visible_data();
 
 	if (filter->addrbook_on) {
 		ret = snprintf(buf, buf_size,
@@ -514,10 +506,7 @@ static inline void cts_filter_make_query_ALL_CONTACT_HAD_NUMBER(CTSfilter *filte
 	else
 		display = CTS_SCHEMA_DATA_NAME_LOOKUP;
 
-	if (cts_restriction_get_permit())
-		data = CTS_TABLE_DATA;
-	else
-		data = CTS_TABLE_RESTRICTED_DATA_VIEW;
+	data = cts_addressbook_get_visible_data();
 
 	if (filter->addrbook_on) {
 		ret = snprintf(buf, buf_size,
@@ -566,10 +555,7 @@ static inline void cts_filter_make_query_ALL_CONTACT_HAD_EMAIL(CTSfilter *filter
 	else
 		display = CTS_SCHEMA_DATA_NAME_LOOKUP;
 
-	if (cts_restriction_get_permit())
-		data = CTS_TABLE_DATA;
-	else
-		data = CTS_TABLE_RESTRICTED_DATA_VIEW;
+	data = cts_addressbook_get_visible_data();
 
 	if (filter->addrbook_on) {
 		ret = snprintf(buf, buf_size,
@@ -618,10 +604,7 @@ static int cts_list_filter_make_query(CTSfilter *filter, CTSiter *iter)
 	else
 		display = CTS_SCHEMA_DATA_NAME_LOOKUP;
 
-	if (cts_restriction_get_permit())
-		data = CTS_TABLE_DATA;
-	else
-		data = CTS_TABLE_RESTRICTED_DATA_VIEW;
+	data = cts_addressbook_get_visible_data();
 
 	switch (filter->list_type) {
 	case CTS_FILTERED_ALL_CONTACT:
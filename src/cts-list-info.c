@@ -210,6 +210,21 @@ static inline CTSvalue* cts_iter_get_info_change(updated_record *cursor)
 	return (CTSvalue *)result;
 }
 
+static inline CTSvalue* cts_iter_get_info_change_stmt(cts_stmt stmt)
+{
+	change_list *result;
+
+	result = (change_list *)contacts_svc_value_new(CTS_VALUE_LIST_CHANGE);
+	retvm_if(NULL == result, NULL, "contacts_svc_value_new() Failed");
+
+	result->changed_type = cts_stmt_get_int(stmt, 0);
+	result->id = cts_stmt_get_int(stmt, 1);
+	result->changed_ver = cts_stmt_get_int(stmt, 2);
+	result->addressbook_id = cts_stmt_get_int(stmt, 3);
+
+	return (CTSvalue *)result;
+}
+
 static inline CTSvalue* cts_iter_get_info_plog(int type, cts_stmt stmt)
 {
 	int lang, cnt=0;
@@ -407,6 +422,10 @@ API CTSvalue* contacts_svc_iter_get_info(CTSiter *iter)
 		result = cts_iter_get_info_change(iter->info->cursor);
 		retvm_if(NULL == result, NULL, "cts_iter_get_info_change() Failed");
 		break;
+	case CTS_ITER_UPDATED_CONTACTS_AFTER_CHECKPOINT:
+		result = cts_iter_get_info_change_stmt(iter->stmt);
+		retvm_if(NULL == result, NULL, "cts_iter_get_info_change_stmt() Failed");
+		break;
 	case CTS_ITER_GROUPING_PLOG:
 	case CTS_ITER_PLOGS_OF_NUMBER:
 	case CTS_ITER_PLOGS_OF_PERSON_ID:
@@ -25,9 +25,11 @@
 #include "cts-normalize.h"
 #include "cts-favorite.h"
 #include "cts-restriction.h"
+#include "cts-addressbook.h"
+#include "cts-contact.h"
 #include "cts-list.h"
+#include "cts-mempool.h"
 
-#define CTS_MALLOC_DEFAULT_NUM 256 //4Kbytes
 #define CTS_OFTEN_USED_NUM 1
 
 static inline updated_record* cts_updated_info_add_mempool(void)
@@ -35,7 +37,8 @@ static inline updated_record* cts_updated_info_add_mempool(void)
 	int i;
 	updated_record *mempool;
 
-	mempool = calloc(CTS_MALLOC_DEFAULT_NUM, sizeof(updated_record));
+	mempool = cts_mempool_get(CTS_MEMPOOL_UPDATED_INFO);
+	retvm_if(NULL == mempool, NULL, "cts_mempool_get() Failed");
 	for (i=0;i<CTS_MALLOC_DEFAULT_NUM-1;i++)
 		mempool[i].next = &mempool[i+1];
 	return mempool;
@@ -50,7 +53,7 @@ static inline int cts_updated_contact_free_mempool(updated_record *mempool)
 	memseg = mempool;
 	while (memseg) {
 		tmp = memseg[CTS_MALLOC_DEFAULT_NUM-1].next;
-		free(memseg);
+		cts_mempool_put(CTS_MEMPOOL_UPDATED_INFO, memseg);
 		memseg = tmp;
 	}
 
@@ -117,6 +120,54 @@ API int contacts_svc_iter_remove(CTSiter *iter)
 	return CTS_SUCCESS;
 }
 
+/*
+ * phonelog_groups keeps the latest log and the bound contact of each number.
+ * It is maintained by the triggers of phonelogs and data(schema.sql),
+ * so the grouped lists are read in the order of idx1_phonelog_groups.
+ */
+static inline cts_stmt cts_list_grouping_plog(int kind, const char *data)
+{
+	char query[CTS_SQL_MAX_LEN] = {0};
+
+	if (!strcmp(data, CTS_TABLE_DATA)) {
+		snprintf(query, sizeof(query),
+				"SELECT G.plog_id, F.data1, F.data2, F.data3, F.data5, E.image0, C.number, "
+				"C.log_type, C.log_time, C.data1, C.data2, G.contact_id, G.number_type "
+				"FROM %s G "
+				"JOIN %s C ON G.plog_id = C.id "
+				"LEFT JOIN %s F ON F.contact_id = G.contact_id AND F.datatype = %d "
+				"LEFT JOIN %s E ON E.contact_id = F.contact_id "
+				"WHERE G.kind = %d "
+				"ORDER BY G.log_time DESC",
+				CTS_TABLE_PHONELOG_GROUPS, CTS_TABLE_PHONELOGS,
+				data, CTS_DATA_NAME, CTS_TABLE_CONTACTS, kind);
+		return cts_query_prepare(query);
+	}
+
+	/* The contact of phonelog_groups is bound over all data.
+	 * If it is hidden, the number is bound again to the smallest visible contact. */
+	snprintf(query, sizeof(query),
+			"SELECT G.plog_id, F.data1, F.data2, F.data3, F.data5, E.image0, C.number, "
+			"C.log_type, C.log_time, C.data1, C.data2, G.bound, "
+			"(SELECT data1 FROM %s WHERE datatype = %d AND data3 = G.normal_num "
+			"AND contact_id = G.bound) "
+			"FROM (SELECT plog_id, normal_num, log_time, IFNULL("
+			"(SELECT contact_id FROM %s WHERE datatype = %d AND data3 = normal_num "
+			"AND contact_id = %s.contact_id), "
+			"(SELECT MIN(contact_id) FROM %s WHERE datatype = %d AND data3 = normal_num)) bound "
+			"FROM %s WHERE kind = %d) G "
+			"JOIN %s C ON G.plog_id = C.id "
+			"LEFT JOIN %s F ON F.contact_id = G.bound AND F.datatype = %d "
+			"LEFT JOIN %s E ON E.contact_id = F.contact_id "
+			"ORDER BY G.log_time DESC",
+			data, CTS_DATA_NUMBER,
+			data, CTS_DATA_NUMBER, CTS_TABLE_PHONELOG_GROUPS,
+			data, CTS_DATA_NUMBER, CTS_TABLE_PHONELOG_GROUPS, kind,
+			CTS_TABLE_PHONELOGS, data, CTS_DATA_NAME, CTS_TABLE_CONTACTS);
+
+	return cts_query_prepare(query);
+}
+
 static inline int cts_get_list(cts_get_list_op op_code, CTSiter *iter)
 {
 	cts_stmt stmt = NULL;
@@ -128,10 +179,7 @@ static inline int cts_get_list(cts_get_list_op op_code, CTSiter *iter)
 	iter->i_type = CTS_ITER_NONE;
 	iter->stmt = NULL;
 
-	if (cts_restriction_get_permit())
-		data = CTS_TABLE_DATA;
-	else
-		data = CTS_TABLE_RESTRICTED_DATA_VIEW;
+	data = cts_addressbook_get_visible_data();
 
 	switch (op_code)
 	{
@@ -158,7 +206,7 @@ static inline int cts_get_list(cts_get_list_op op_code, CTSiter *iter)
 		iter->i_type = CTS_ITER_ADDRESSBOOKS;
 		snprintf(query, sizeof(query),
 				"SELECT addrbook_id, addrbook_name, acc_id, acc_type, mode "
-				"FROM %s ORDER BY acc_id, addrbook_id",
+				"FROM %s WHERE deleting = 0 ORDER BY acc_id, addrbook_id",
 				CTS_TABLE_ADDRESSBOOKS);
 
 		stmt = cts_query_prepare(query);
@@ -186,80 +234,20 @@ static inline int cts_get_list(cts_get_list_op op_code, CTSiter *iter)
 		break;
 	case CTS_LIST_GROUPING_PLOG:
 		iter->i_type = CTS_ITER_GROUPING_PLOG;
-		snprintf(query, sizeof(query),
-				"SELECT C.id, F.data1, F.data2, F.data3, F.data5, F.image0, C.number, "
-				"C.log_type, C.log_time, C.data1, C.data2, C.contact_id, C.number_type "
-				"FROM "
-				"(SELECT A.id, A.number, A.log_type, A.log_time, A.data1, A.data2, "
-				"MIN(B.contact_id) contact_id, B.data1 number_type "
-				"FROM %s A LEFT JOIN %s B ON B.datatype = %d AND A.normal_num = B.data3 AND "
-				"(A.related_id = B.contact_id OR A.related_id IS NULL OR "
-				"NOT EXISTS (SELECT id FROM %s "
-				"WHERE datatype = %d AND contact_id = A.related_id "
-				"AND A.normal_num = data3)) "
-				"WHERE A.log_type < %d "
-				"GROUP BY A.id) C "
-				"LEFT JOIN (SELECT D.contact_id, data1, data2, data3, data5, image0 "
-				"FROM %s D, %s E ON D.datatype = %d AND D.contact_id = E.contact_id) F "
-				"ON C.contact_id = F.contact_id "
-				"GROUP BY F.data2, F.data3, F.data5, C.number "
-				"ORDER BY C.log_time DESC",
-				CTS_TABLE_PHONELOGS, data, CTS_DATA_NUMBER, data,
-				CTS_DATA_NUMBER, CTS_PLOG_TYPE_EMAIL_RECEIVED,
-				data, CTS_TABLE_CONTACTS, CTS_DATA_NAME);
-		stmt = cts_query_prepare(query);
-		retvm_if(NULL == stmt, CTS_ERR_DB_FAILED, "cts_query_prepare() Failed");
+		stmt = cts_list_grouping_plog(CTS_SCHEMA_PLOG_GROUP_ALL, data);
+		retvm_if(NULL == stmt, CTS_ERR_DB_FAILED, "cts_list_grouping_plog() Failed");
 		iter->stmt = stmt;
 		break;
 	case CTS_LIST_GROUPING_MSG_PLOG:
 		iter->i_type = CTS_ITER_GROUPING_PLOG;
-		snprintf(query, sizeof(query),
-				"SELECT C.id, F.data1, F.data2, F.data3, F.data5, F.image0, C.number, "
-				"C.log_type, C.log_time, C.data1, C.data2, C.contact_id, C.number_type "
-				"FROM "
-				"(SELECT A.id, A.number, A.log_type, A.log_time, A.data1, A.data2, "
-				"MIN(B.contact_id) contact_id, B.data1 number_type "
-				"FROM %s A LEFT JOIN %s B ON B.datatype = %d AND A.normal_num = B.data3 AND "
-				"(A.related_id = B.contact_id OR A.related_id IS NULL OR "
-				"NOT EXISTS (SELECT id FROM %s WHERE datatype = %d AND contact_id = A.related_id "
-				"AND A.normal_num = data3)) "
-				"WHERE (A.log_type BETWEEN %d AND %d) "
-				"GROUP BY A.id) C "
-				"LEFT JOIN (SELECT D.contact_id, data1, data2, data3, data5, image0 "
-				"FROM %s D, %s E ON D.datatype = %d AND D.contact_id = E.contact_id) F "
-				"ON C.contact_id = F.contact_id "
-				"GROUP BY F.data2, F.data3, F.data5, C.number "
-				"ORDER BY C.log_time DESC",
-				CTS_TABLE_PHONELOGS, data, CTS_DATA_NUMBER, data, CTS_DATA_NUMBER,
-				CTS_PLOG_TYPE_MMS_INCOMMING, CTS_PLOG_TYPE_MMS_BLOCKED,
-				data, CTS_TABLE_CONTACTS, CTS_DATA_NAME);
-		stmt = cts_query_prepare(query);
-		retvm_if(NULL == stmt, CTS_ERR_DB_FAILED, "cts_query_prepare() Failed");
+		stmt = cts_list_grouping_plog(CTS_SCHEMA_PLOG_GROUP_MSG, data);
+		retvm_if(NULL == stmt, CTS_ERR_DB_FAILED, "cts_list_grouping_plog() Failed");
 		iter->stmt = stmt;
 		break;
 	case CTS_LIST_GROUPING_CALL_PLOG:
 		iter->i_type = CTS_ITER_GROUPING_PLOG;
-		snprintf(query, sizeof(query),
-				"SELECT C.id, F.data1, F.data2, F.data3, F.data5, F.image0, C.number, "
-				"C.log_type, C.log_time, C.data1, C.data2, C.contact_id, C.number_type "
-				"FROM "
-				"(SELECT A.id, A.number, A.log_type, A.log_time, A.data1, A.data2, "
-				"MIN(B.contact_id) contact_id, B.data1 number_type "
-				"FROM %s A LEFT JOIN %s B ON B.datatype = %d AND A.normal_num = B.data3 AND "
-				"(A.related_id = B.contact_id OR A.related_id IS NULL OR "
-				"NOT EXISTS (SELECT id FROM %s WHERE datatype = %d AND contact_id = A.related_id "
-				"AND A.normal_num = data3)) "
-				"WHERE A.log_type < %d "
-				"GROUP BY A.id) C "
-				"LEFT JOIN (SELECT D.contact_id, data1, data2, data3, data5, image0 "
-				"FROM %s D, %s E ON D.datatype = %d AND D.contact_id = E.contact_id) F "
-				"ON C.contact_id = F.contact_id "
-				"GROUP BY F.data2, F.data3, F.data5, C.number "
-				"ORDER BY C.log_time DESC",
-				CTS_TABLE_PHONELOGS, data, CTS_DATA_NUMBER, data, CTS_DATA_NUMBER,
-				CTS_PLOG_TYPE_MMS_INCOMMING, data, CTS_TABLE_CONTACTS, CTS_DATA_NAME);
-		stmt = cts_query_prepare(query);
-		retvm_if(NULL == stmt, CTS_ERR_DB_FAILED, "cts_query_prepare() Failed");
+		stmt = cts_list_grouping_plog(CTS_SCHEMA_PLOG_GROUP_CALL, data);
+		retvm_if(NULL == stmt, CTS_ERR_DB_FAILED, "cts_list_grouping_plog() Failed");
 		iter->stmt = stmt;
 		break;
 	case CTS_LIST_ALL_PLOG:
@@ -593,10 +581,7 @@ static inline int cts_get_list_with_str(cts_get_list_str_op op_code,
 	retvm_if(NULL == search_value && CTS_LIST_PLOGS_OF_NUMBER != op_code,
 			CTS_ERR_ARG_NULL, "The search_value is NULL");
 
-	if (cts_restriction_get_permit())
-		data = CTS_TABLE_DATA;
-	else
-		data = CTS_TABLE_RESTRICTED_DATA_VIEW;
+	data = cts_addressbook_get_visible_data();
 
 	switch ((int)op_code)
 	{
@@ -777,10 +762,7 @@ static inline int cts_get_list_with_int(cts_get_list_int_op op_code,
 	else
 		display = CTS_SCHEMA_DATA_NAME_LOOKUP;
 
-	if (cts_restriction_get_permit())
-		data = CTS_TABLE_DATA;
-	else
-		data = CTS_TABLE_RESTRICTED_DATA_VIEW;
+	data = cts_addressbook_get_visible_data();
 
 	switch (op_code) {
 	case CTS_LIST_MEMBERS_OF_GROUP_ID:
@@ -845,7 +827,7 @@ static inline int cts_get_list_with_int(cts_get_list_int_op op_code,
 		iter->i_type = CTS_ITER_ADDRESSBOOKS;
 		snprintf(query, sizeof(query),
 				"SELECT addrbook_id, addrbook_name, acc_id, acc_type, mode "
-				"FROM %s WHERE acc_id = %d "
+				"FROM %s WHERE acc_id = %d AND deleting = 0 "
 				"ORDER BY addrbook_id",
 				CTS_TABLE_ADDRESSBOOKS, search_value);
 		stmt = cts_query_prepare(query);
@@ -989,6 +971,10 @@ static inline int cts_get_updated_contacts(int addressbook_id, int version,
 	}
 
 	iter->info->head = result = cts_updated_info_add_mempool();
+	if (NULL == result) {
+		cts_stmt_finalize(stmt);
+		return CTS_ERR_OUT_OF_MEMORY;
+	}
 	do {
 		result->type = cts_stmt_get_int(stmt, 0);
 		result->id = cts_stmt_get_int(stmt, 1);
@@ -1038,6 +1024,196 @@ API int contacts_svc_get_updated_contacts(int addressbook_id,
 	return CTS_SUCCESS;
 }
 
+static cts_stmt cts_query_updated_contacts_after(int addressbook_id,
+		int last_ver, int last_id, int max_count)
+{
+	int len;
+	cts_stmt stmt;
+	char addrbook_cond[64] = {0};
+	char query[CTS_SQL_MAX_LEN] = {0};
+
+	if (0 <= addressbook_id)
+		snprintf(addrbook_cond, sizeof(addrbook_cond), "AND addrbook_id = %d", addressbook_id);
+
+	/* Each part walks its version index in order of (version, contact_id)
+	 * because contact_id is the rowid of the table. */
+	len = snprintf(query, sizeof(query),
+			"SELECT CASE WHEN created_ver = changed_ver OR created_ver > %d "
+			"OR (created_ver = %d AND contact_id > %d) THEN %d ELSE %d END, "
+			"contact_id, changed_ver, addrbook_id FROM %s "
+			"WHERE (changed_ver > %d OR (changed_ver = %d AND contact_id > %d)) %s "
+			"UNION ALL "
+			"SELECT %d, contact_id, deleted_ver, addrbook_id FROM %s "
+			"WHERE (deleted_ver > %d OR (deleted_ver = %d AND contact_id > %d)) %s "
+			"ORDER BY 3, 2",
+			last_ver, last_ver, last_id, CTS_OPERATION_INSERTED, CTS_OPERATION_UPDATED,
+			CTS_TABLE_CONTACTS, last_ver, last_ver, last_id, addrbook_cond,
+			CTS_OPERATION_DELETED, CTS_TABLE_DELETEDS, last_ver, last_ver, last_id,
+			addrbook_cond);
+	if (0 < max_count)
+		snprintf(query+len, sizeof(query)-len, " LIMIT %d", max_count);
+
+	stmt = cts_query_prepare(query);
+	retvm_if(NULL == stmt, NULL, "cts_query_prepare() Failed");
+
+	return stmt;
+}
+
+API int contacts_svc_get_updated_contacts_after(int addressbook_id,
+		int last_ver, int last_id, int max_count, CTSiter **iter)
+{
+	cts_stmt stmt;
+	CTSiter *result;
+
+	retv_if(NULL == iter, CTS_ERR_ARG_NULL);
+	retvm_if(last_ver < 0 || last_id < 0, CTS_ERR_ARG_INVALID,
+			"The checkpoint(%d, %d) is invalid", last_ver, last_id);
+
+	stmt = cts_query_updated_contacts_after(addressbook_id, last_ver, last_id, max_count);
+	retvm_if(NULL == stmt, CTS_ERR_DB_FAILED, "cts_query_updated_contacts_after() Failed");
+
+	result = calloc(1, sizeof(CTSiter));
+	if (NULL == result) {
+		ERR("calloc() Failed");
+		cts_stmt_finalize(stmt);
+		return CTS_ERR_OUT_OF_MEMORY;
+	}
+
+	result->i_type = CTS_ITER_UPDATED_CONTACTS_AFTER_CHECKPOINT;
+	result->stmt = stmt;
+
+	*iter = (CTSiter *)result;
+	INFO(",CTSiter,1");
+	return CTS_SUCCESS;
+}
+
+static inline int cts_change_payload_get_field(cts_change_payload_type payload)
+{
+	switch (payload) {
+	case CTS_CHANGE_PAYLOAD_NAME:
+		return CTS_DATA_FIELD_NAME;
+	case CTS_CHANGE_PAYLOAD_NAME_NUMBER_EMAIL:
+		return CTS_DATA_FIELD_NAME|CTS_DATA_FIELD_NUMBER|CTS_DATA_FIELD_EMAIL;
+	case CTS_CHANGE_PAYLOAD_ALL:
+		return CTS_DATA_FIELD_ALL;
+	case CTS_CHANGE_PAYLOAD_NONE:
+	default:
+		return 0;
+	}
+}
+
+static inline int cts_change_feed_dispatch(updated_record *changes, int cnt,
+		int field, cts_change_foreach_fn cb, void *user_data)
+{
+	int i, ret, id_cnt;
+	change_list *value;
+	CTSstruct *contact;
+	int ids[CTS_BATCH_CONTACTS_MAX];
+	contact_t *records[CTS_BATCH_CONTACTS_MAX] = {0};
+
+	id_cnt = 0;
+	if (field) {
+		for (i=0;i<cnt;i++)
+			if (CTS_OPERATION_DELETED != changes[i].type)
+				ids[id_cnt++] = changes[i].id;
+		if (id_cnt) {
+			ret = cts_get_contacts_batch(field, ids, id_cnt, records);
+			retvm_if(CTS_SUCCESS != ret, ret, "cts_get_contacts_batch() Failed(%d)", ret);
+		}
+	}
+
+	ret = CTS_SUCCESS;
+	for (i=0;i<cnt;i++) {
+		contact = NULL;
+		if (id_cnt && CTS_OPERATION_DELETED != changes[i].type) {
+			int j;
+			for (j=0;j<id_cnt;j++)
+				if (ids[j] == changes[i].id)
+					contact = (CTSstruct *)records[j];
+		}
+
+		value = (change_list *)contacts_svc_value_new(CTS_VALUE_LIST_CHANGE);
+		if (NULL == value) {
+			ERR("contacts_svc_value_new() Failed");
+			ret = CTS_ERR_OUT_OF_MEMORY;
+			break;
+		}
+		value->changed_type = changes[i].type;
+		value->id = changes[i].id;
+		value->changed_ver = changes[i].ver;
+		value->addressbook_id = changes[i].addressbook_id;
+
+		ret = cb((CTSvalue *)value, contact, user_data);
+		contacts_svc_value_free((CTSvalue *)value);
+		if (CTS_SUCCESS != ret) {
+			ERR("cts_change_foreach_fn(%p) Failed(%d)", cb, ret);
+			ret = CTS_ERR_FINISH_ITER;
+			break;
+		}
+	}
+
+	for (i=0;i<id_cnt;i++)
+		if (records[i])
+			contacts_svc_struct_free((CTSstruct *)records[i]);
+
+	return ret;
+}
+
+API int contacts_svc_updated_contacts_foreach(int addressbook_id,
+		int last_ver, int last_id, int max_count, cts_change_payload_type payload,
+		cts_change_foreach_fn cb, void *user_data)
+{
+	int ret, cnt, field;
+	cts_stmt stmt;
+	updated_record changes[CTS_BATCH_CONTACTS_MAX];
+
+	retv_if(NULL == cb, CTS_ERR_ARG_NULL);
+	retvm_if(last_ver < 0 || last_id < 0, CTS_ERR_ARG_INVALID,
+			"The checkpoint(%d, %d) is invalid", last_ver, last_id);
+
+	field = cts_change_payload_get_field(payload);
+
+	stmt = cts_query_updated_contacts_after(addressbook_id, last_ver, last_id, max_count);
+	retvm_if(NULL == stmt, CTS_ERR_DB_FAILED, "cts_query_updated_contacts_after() Failed");
+
+	/* The statement keeps the read transaction of the connection open
+	 * until it is finalized. So every batch of contact data is read
+	 * in the same snapshot as the changes. */
+	do {
+		cnt = 0;
+		while (cnt < CTS_BATCH_CONTACTS_MAX && CTS_TRUE == (ret = cts_stmt_step(stmt))) {
+			changes[cnt].type = cts_stmt_get_int(stmt, 0);
+			changes[cnt].id = cts_stmt_get_int(stmt, 1);
+			changes[cnt].ver = cts_stmt_get_int(stmt, 2);
+			changes[cnt].addressbook_id = cts_stmt_get_int(stmt, 3);
+			cnt++;
+		}
+		if (ret < CTS_SUCCESS) {
+			ERR("cts_stmt_step() Failed(%d)", ret);
+			break;
+		}
+
+		if (cnt) {
+			int err = cts_change_feed_dispatch(changes, cnt, field, cb, user_data);
+			if (CTS_ERR_FINISH_ITER == err) {
+				ret = CTS_SUCCESS;
+				break;
+			}
+			else if (CTS_SUCCESS != err) {
+				ERR("cts_change_feed_dispatch() Failed(%d)", err);
+				ret = err;
+				break;
+			}
+		}
+	} while (CTS_TRUE == ret);
+
+	cts_stmt_finalize(stmt);
+
+	if (ret < CTS_SUCCESS)
+		return ret;
+	return CTS_SUCCESS;
+}
+
 static inline int cts_get_updated_groups(int addressbook_id, int version,
 		CTSiter *iter)
 {
@@ -1082,6 +1258,10 @@ static inline int cts_get_updated_groups(int addressbook_id, int version,
 	}
 
 	iter->info->head = result = cts_updated_info_add_mempool();
+	if (NULL == result) {
+		cts_stmt_finalize(stmt);
+		return CTS_ERR_OUT_OF_MEMORY;
+	}
 	do {
 		result->type = cts_stmt_get_int(stmt, 0);
 		result->id = cts_stmt_get_int(stmt, 1);
@@ -1262,10 +1442,7 @@ API int contacts_svc_smartsearch_excl(const char *search_str, int limit, int off
 	else
 		display = CTS_SCHEMA_DATA_NAME_LOOKUP;
 
-	if (cts_restriction_get_permit())
-		data = CTS_TABLE_DATA;
-	else
-		data = CTS_TABLE_RESTRICTED_DATA_VIEW;
+	data = cts_addressbook_get_visible_data();
 
 	if (cts_is_number(search_str)) {
 		len = snprintf(query, sizeof(query),
@@ -1324,7 +1501,7 @@ static inline int cts_group_get_relation_changes(int addressbook_id, int version
 	ret = snprintf(query, sizeof(query),
 			"SELECT group_id, type, ver, addrbook_id FROM %s, %s USING (group_id) "
 			"WHERE ver > %d ",
-			"group_relations_log", CTS_TABLE_GROUPS, version);
+			CTS_TABLE_GROUP_RELATIONS_LOG, CTS_TABLE_GROUPS, version);
 
 	if (0 <= addressbook_id)
 	{
@@ -1344,6 +1521,10 @@ static inline int cts_group_get_relation_changes(int addressbook_id, int version
 	}
 
 	iter->info->head = result = cts_updated_info_add_mempool();
+	if (NULL == result) {
+		cts_stmt_finalize(stmt);
+		return CTS_ERR_OUT_OF_MEMORY;
+	}
 	do {
 		result->id = cts_stmt_get_int(stmt, 0);
 		result->type = cts_stmt_get_int(stmt, 1);
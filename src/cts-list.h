@@ -46,9 +46,12 @@ enum
 	CTS_ITER_UPDATED_INFO_AFTER_VER,
 	CTS_ITER_PLOGS_OF_PERSON_ID,
 	CTS_ITER_OSP,
+	CTS_ITER_UPDATED_CONTACTS_AFTER_CHECKPOINT,
 	CTS_ITER_MAX
 };
 
+#define CTS_MALLOC_DEFAULT_NUM 256 //4Kbytes
+
 typedef struct _updated_record {
 	int type;
 	int id;
@@ -86,7 +89,8 @@ struct _cts_iter {
 /**
  * CTSiter is an opaque type.
  * Iterator can get by contacts_svc_get_list(), contacts_svc_get_list_with_int(),
- * contacts_svc_get_list_with_str(), contacts_svc_get_list_with_filter(), contacts_svc_get_updated_contacts().
+ * contacts_svc_get_list_with_str(), contacts_svc_get_list_with_filter(), contacts_svc_get_updated_contacts(),
+ * contacts_svc_get_updated_contacts_after().
  * \n And Iterator can handle by contacts_svc_iter_next(), contacts_svc_iter_remove(), contacts_svc_iter_get_info().
  */
 typedef struct _cts_iter CTSiter;
@@ -451,6 +455,95 @@ int contacts_svc_get_list_with_int(cts_get_list_int_op op_code, unsigned int sea
 int contacts_svc_get_updated_contacts(int addressbook_id,
       int version, CTSiter **iter);
 
+/**
+ * This function gets iterator of the changes of contacts after the checkpoint(last_ver, last_id).
+ * Unlike contacts_svc_get_updated_contacts(), the changes are not gathered on memory.
+ * The iterator walks the changes in order of (version, contact index)
+ * and stops after max_count changes.
+ * To get the next chunk, pass #CTS_LIST_CHANGE_VER_INT and #CTS_LIST_CHANGE_ID_INT
+ * of the last change gotten from the previous chunk as the checkpoint.
+ * If there is no more change, contacts_svc_iter_next() returns #CTS_ERR_FINISH_ITER at first.
+ * Obtained iterator should be free using by contacts_svc_iter_remove().
+ *
+ * @param[in] addressbook_id The index of addressbook. Negative value means all addressbooks.
+ * @param[in] last_ver The version of the checkpoint. 0 means the beginning.
+ * @param[in] last_id The contact index of the checkpoint. 0 means all changes of last_ver are not gotten.
+ * @param[in] max_count The maximum number of changes in the iterator. 0 means no limit.
+ * @param[out] iter Point of data iterator to be got(#CHANGELIST)
+ * @return #CTS_SUCCESS on success, Negative value(#cts_error) on error
+ * @see #CHANGELIST, contacts_svc_get_updated_contacts()
+ * @par example
+ * @code
+  void sync_data(int *last_ver, int *last_id)
+  {
+     int count;
+     CTSiter *iter;
+     CTSvalue *row_info;
+
+     do {
+        if (CTS_SUCCESS != contacts_svc_get_updated_contacts_after(-1, *last_ver, *last_id, 100, &iter))
+           return;
+
+        count = 0;
+        while (CTS_SUCCESS == contacts_svc_iter_next(iter)) {
+           row_info = contacts_svc_iter_get_info(iter);
+           *last_ver = contacts_svc_value_get_int(row_info, CTS_LIST_CHANGE_VER_INT);
+           *last_id = contacts_svc_value_get_int(row_info, CTS_LIST_CHANGE_ID_INT);
+           // handle the change and save the checkpoint
+           contacts_svc_value_free(row_info);
+           count++;
+        }
+        contacts_svc_iter_remove(iter);
+     } while (100 == count);
+  }
+ * @endcode
+ */
+int contacts_svc_get_updated_contacts_after(int addressbook_id,
+      int last_ver, int last_id, int max_count, CTSiter **iter);
+
+/**
+ * Use for contacts_svc_updated_contacts_foreach()
+ */
+typedef enum {
+	CTS_CHANGE_PAYLOAD_NONE, /**< The contact is not loaded */
+	CTS_CHANGE_PAYLOAD_NAME, /**< The base information and the name */
+	CTS_CHANGE_PAYLOAD_NAME_NUMBER_EMAIL, /**< The base information, the name, numbers and emails */
+	CTS_CHANGE_PAYLOAD_ALL, /**< All information which contacts_svc_get_contact() gets */
+}cts_change_payload_type;
+
+/**
+ * This is the signature of a callback function added with contacts_svc_updated_contacts_foreach().
+ * \n change and contact are freed after this function returns.
+ * \n If this function doesn't return #CTS_SUCCESS, foreach function is terminated.
+ *
+ * @param[in] change The change of a contact(#CHANGELIST)
+ * @param[in] contact The contact of the change. It is NULL for #CTS_OPERATION_DELETED
+ * or #CTS_CHANGE_PAYLOAD_NONE.
+ * @param[in] user_data The data which is set by contacts_svc_updated_contacts_foreach()
+ * @return #CTS_SUCCESS on success, other value on error
+ */
+typedef int (*cts_change_foreach_fn)(CTSvalue *change, CTSstruct *contact, void *user_data);
+
+/**
+ * This function calls #cts_change_foreach_fn for each change of contacts after the checkpoint(last_ver, last_id)
+ * in the same order as contacts_svc_get_updated_contacts_after().
+ * The inserted and updated contacts are loaded with the changes in one read transaction.
+ * Their data rows are read in batches instead of calling contacts_svc_get_contact() for each change.
+ *
+ * @param[in] addressbook_id The index of addressbook. Negative value means all addressbooks.
+ * @param[in] last_ver The version of the checkpoint. 0 means the beginning.
+ * @param[in] last_id The contact index of the checkpoint. 0 means all changes of last_ver are not gotten.
+ * @param[in] max_count The maximum number of changes. 0 means no limit.
+ * @param[in] payload The information of contact to be loaded(#cts_change_payload_type)
+ * @param[in] cb callback function pointer(#cts_change_foreach_fn)
+ * @param[in] user_data data which is passed to callback function
+ * @return #CTS_SUCCESS on success, Negative value(#cts_error) on error
+ * @see contacts_svc_get_updated_contacts_after()
+ */
+int contacts_svc_updated_contacts_foreach(int addressbook_id,
+      int last_ver, int last_id, int max_count, cts_change_payload_type payload,
+      cts_change_foreach_fn cb, void *user_data);
+
 /**
  * This function reads information from the iterator.
  * Obtained information should be free using by contacts_svc_value_free().
@@ -0,0 +1,188 @@
+/*
+ * Contacts Service
+ *
+ * Copyright (c) 2010 - 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Youngjae Shin <yj99.shin@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "cts-internal.h"
+#include "cts-list.h"
+#include "cts-pthread.h"
+#include "cts-utils.h"
+#include "cts-mempool.h"
+
+typedef struct _cts_mempool_node {
+	struct _cts_mempool_node *next;
+}cts_mempool_node;
+
+typedef struct {
+	cts_mempool_node *head;
+	int count;
+	int cap;
+	size_t size;
+	unsigned int hit;
+	unsigned int miss;
+	unsigned int dropped;
+}cts_mempool;
+
+/* The free objects are chained through their own first bytes.
+ * Every pool is protected by CTS_MUTEX_MEMPOOL. */
+static cts_mempool cts_mempools[CTS_MEMPOOL_MAX] = {
+	[CTS_MEMPOOL_LIST_CONTACT] = {NULL, 0, CTS_MEMPOOL_DEFAULT_CAP, sizeof(contact_list)},
+	[CTS_MEMPOOL_LIST_PLOG] = {NULL, 0, CTS_MEMPOOL_DEFAULT_CAP, sizeof(plog_list)},
+	[CTS_MEMPOOL_LIST_CHANGE] = {NULL, 0, CTS_MEMPOOL_DEFAULT_CAP, sizeof(change_list)},
+	[CTS_MEMPOOL_LIST_CUSTOM_NUM_TYPE] = {NULL, 0, CTS_MEMPOOL_DEFAULT_CAP, sizeof(numtype_list)},
+	[CTS_MEMPOOL_LIST_SHORTCUT] = {NULL, 0, CTS_MEMPOOL_DEFAULT_CAP, sizeof(shortcut_list)},
+	[CTS_MEMPOOL_LIST_GROUP] = {NULL, 0, CTS_MEMPOOL_DEFAULT_CAP, sizeof(cts_group)},
+	[CTS_MEMPOOL_LIST_ADDRBOOK] = {NULL, 0, CTS_MEMPOOL_DEFAULT_CAP, sizeof(cts_addrbook)},
+	[CTS_MEMPOOL_LIST_SDN] = {NULL, 0, CTS_MEMPOOL_DEFAULT_CAP, sizeof(sdn_list)},
+	[CTS_MEMPOOL_LIST_OSP] = {NULL, 0, CTS_MEMPOOL_DEFAULT_CAP, sizeof(osp_list)},
+	[CTS_MEMPOOL_UPDATED_INFO] = {NULL, 0, CTS_MEMPOOL_DEFAULT_CAP,
+		CTS_MALLOC_DEFAULT_NUM * sizeof(updated_record)},
+};
+
+void* cts_mempool_get(int type)
+{
+	void *ret_val;
+	cts_mempool *pool;
+
+	retvm_if(type < 0 || CTS_MEMPOOL_MAX <= type, NULL, "Invalid type(%d)", type);
+	pool = &cts_mempools[type];
+
+	cts_mutex_lock(CTS_MUTEX_MEMPOOL);
+	ret_val = pool->head;
+	if (ret_val) {
+		pool->head = pool->head->next;
+		pool->count--;
+		pool->hit++;
+	}
+	else
+		pool->miss++;
+	cts_mutex_unlock(CTS_MUTEX_MEMPOOL);
+
+	if (ret_val)
+		memset(ret_val, 0x00, pool->size);
+	else
+		ret_val = calloc(1, pool->size);
+
+	return ret_val;
+}
+
+void cts_mempool_put(int type, void *ptr)
+{
+	cts_mempool *pool;
+	cts_mempool_node *node = ptr;
+
+	ret_if(NULL == ptr);
+	if (type < 0 || CTS_MEMPOOL_MAX <= type) {
+		ERR("Invalid type(%d)", type);
+		free(ptr);
+		return;
+	}
+	pool = &cts_mempools[type];
+
+	cts_mutex_lock(CTS_MUTEX_MEMPOOL);
+	if (pool->count < pool->cap) {
+		node->next = pool->head;
+		pool->head = node;
+		pool->count++;
+		node = NULL;
+	}
+	else
+		pool->dropped++;
+	cts_mutex_unlock(CTS_MUTEX_MEMPOOL);
+
+	free(node);
+}
+
+static inline void cts_mempool_free_nodes(cts_mempool_node *node)
+{
+	cts_mempool_node *tmp;
+
+	while (node) {
+		tmp = node->next;
+		free(node);
+		node = tmp;
+	}
+}
+
+void cts_mempool_trim(void)
+{
+	int i;
+	cts_mempool_node *nodes[CTS_MEMPOOL_MAX];
+
+	cts_mutex_lock(CTS_MUTEX_MEMPOOL);
+	for (i=0;i<CTS_MEMPOOL_MAX;i++) {
+		nodes[i] = cts_mempools[i].head;
+		cts_mempools[i].head = NULL;
+		cts_mempools[i].count = 0;
+	}
+	cts_mutex_unlock(CTS_MUTEX_MEMPOOL);
+
+	for (i=0;i<CTS_MEMPOOL_MAX;i++)
+		cts_mempool_free_nodes(nodes[i]);
+}
+
+API int contacts_svc_mempool_set_cap(cts_mempool_type type, int cap)
+{
+	cts_mempool_node *extra = NULL;
+	cts_mempool *pool;
+
+	retvm_if(type < 0 || CTS_MEMPOOL_MAX <= type, CTS_ERR_ARG_INVALID,
+			"Invalid type(%d)", type);
+	retvm_if(cap < 0, CTS_ERR_ARG_INVALID, "Invalid cap(%d)", cap);
+	pool = &cts_mempools[type];
+
+	cts_mutex_lock(CTS_MUTEX_MEMPOOL);
+	pool->cap = cap;
+	while (cap < pool->count) {
+		cts_mempool_node *node = pool->head;
+		pool->head = node->next;
+		node->next = extra;
+		extra = node;
+		pool->count--;
+	}
+	cts_mutex_unlock(CTS_MUTEX_MEMPOOL);
+
+	cts_mempool_free_nodes(extra);
+	return CTS_SUCCESS;
+}
+
+API int contacts_svc_mempool_get_stats(cts_mempool_type type,
+		cts_mempool_stats *stats)
+{
+	cts_mempool *pool;
+
+	retv_if(NULL == stats, CTS_ERR_ARG_NULL);
+	retvm_if(type < 0 || CTS_MEMPOOL_MAX <= type, CTS_ERR_ARG_INVALID,
+			"Invalid type(%d)", type);
+	pool = &cts_mempools[type];
+
+	cts_mutex_lock(CTS_MUTEX_MEMPOOL);
+	stats->cached = pool->count;
+	stats->cap = pool->cap;
+	stats->hit = pool->hit;
+	stats->miss = pool->miss;
+	stats->dropped = pool->dropped;
+	cts_mutex_unlock(CTS_MUTEX_MEMPOOL);
+
+	return CTS_SUCCESS;
+}
+
+API void contacts_svc_trim_memory(void)
+{
+	cts_mempool_trim();
+}
@@ -0,0 +1,31 @@
+/*
+ * Contacts Service
+ *
+ * Copyright (c) 2010 - 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * Contact: Youngjae Shin <yj99.shin@samsung.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef __CTS_MEMPOOL_H__
+#define __CTS_MEMPOOL_H__
+
+#define CTS_MEMPOOL_DEFAULT_CAP 8
+
+void* cts_mempool_get(int type);
+void cts_mempool_put(int type, void *ptr);
+void cts_mempool_trim(void);
+
+#endif //__CTS_MEMPOOL_H__
+
@@ -18,63 +18,254 @@
  * limitations under the License.
  *
  */
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
 #include "cts-internal.h"
 #include "cts-utils.h"
 #include "cts-sqlite.h"
 #include "cts-schema.h"
 #include "cts-struct-ext.h"
+#include "cts-list.h"
 #include "cts-normalize.h"
 #include "cts-restriction.h"
+#include "cts-addressbook.h"
 #include "cts-person.h"
 
-API int contacts_svc_link_person(int base_person_id, int sub_person_id)
+enum {
+	CTS_LINK_STMT_MOVE_CONTACTS,
+	CTS_LINK_STMT_MOVE_CONTACT,
+	CTS_LINK_STMT_MERGE_OUTGOING,
+	CTS_LINK_STMT_GET_OUTGOING,
+	CTS_LINK_STMT_GET_PRIMARY,
+	CTS_LINK_STMT_INSERT_PERSON,
+	CTS_LINK_STMT_MOVE_PERSON,
+	CTS_LINK_STMT_DELETE_PERSON,
+	CTS_LINK_STMT_GET_CONTACTS,
+	CTS_LINK_STMT_MAX
+};
+
+typedef struct {
+	cts_stmt stmts[CTS_LINK_STMT_MAX];
+}cts_link_info;
+
+static void cts_person_link_finalize(cts_link_info *info)
+{
+	int i;
+
+	for (i=0;i<CTS_LINK_STMT_MAX;i++) {
+		if (info->stmts[i])
+			cts_stmt_finalize(info->stmts[i]);
+		info->stmts[i] = NULL;
+	}
+}
+
+static int cts_person_link_prepare(cts_link_info *info)
+{
+	int i;
+	char query[CTS_LINK_STMT_MAX][CTS_SQL_MIN_LEN];
+
+	snprintf(query[CTS_LINK_STMT_MOVE_CONTACTS], CTS_SQL_MIN_LEN,
+			"UPDATE %s SET person_id = ?1 WHERE person_id = ?2", CTS_TABLE_CONTACTS);
+	snprintf(query[CTS_LINK_STMT_MOVE_CONTACT], CTS_SQL_MIN_LEN,
+			"UPDATE %s SET person_id = ?1 WHERE contact_id = ?2", CTS_TABLE_CONTACTS);
+	snprintf(query[CTS_LINK_STMT_MERGE_OUTGOING], CTS_SQL_MIN_LEN,
+			"UPDATE %s SET outgoing_count = "
+			"(SELECT MAX(outgoing_count) FROM %s WHERE person_id IN (?1, ?2)) "
+			"WHERE person_id = ?1", CTS_TABLE_PERSONS, CTS_TABLE_PERSONS);
+	snprintf(query[CTS_LINK_STMT_GET_OUTGOING], CTS_SQL_MIN_LEN,
+			"SELECT outgoing_count FROM %s WHERE person_id = ?1", CTS_TABLE_PERSONS);
+	snprintf(query[CTS_LINK_STMT_GET_PRIMARY], CTS_SQL_MIN_LEN,
+			"SELECT B.contact_id "
+			"FROM %s A, %s B ON A.contact_id = B.contact_id "
+			"WHERE A.datatype = %d AND B.person_id = ?1 AND B.contact_id != ?1 "
+			"ORDER BY data1, %s",
+			CTS_TABLE_DATA, CTS_TABLE_CONTACTS, CTS_DATA_NAME,
+			CTS_SCHEMA_DATA_NAME_SORTING_KEY);
+	snprintf(query[CTS_LINK_STMT_INSERT_PERSON], CTS_SQL_MIN_LEN,
+			"INSERT INTO %s(person_id, outgoing_count) VALUES(?1, ?2)", CTS_TABLE_PERSONS);
+	snprintf(query[CTS_LINK_STMT_MOVE_PERSON], CTS_SQL_MIN_LEN,
+			"UPDATE %s SET person_id = ?1 WHERE person_id = ?2", CTS_TABLE_PERSONS);
+	snprintf(query[CTS_LINK_STMT_DELETE_PERSON], CTS_SQL_MIN_LEN,
+			"DELETE FROM %s WHERE person_id = ?1", CTS_TABLE_PERSONS);
+	snprintf(query[CTS_LINK_STMT_GET_CONTACTS], CTS_SQL_MIN_LEN,
+			"SELECT contact_id FROM %s WHERE person_id = ?1", CTS_TABLE_CONTACTS);
+
+	for (i=0;i<CTS_LINK_STMT_MAX;i++) {
+		info->stmts[i] = cts_query_prepare(query[i]);
+		if (NULL == info->stmts[i]) {
+			ERR("cts_query_prepare() Failed");
+			cts_person_link_finalize(info);
+			return CTS_ERR_DB_FAILED;
+		}
+	}
+
+	return CTS_SUCCESS;
+}
+
+static int cts_person_link_exec(cts_link_info *info, int type,
+		int param_cnt, int param1, int param2)
+{
+	int ret;
+	cts_stmt stmt = info->stmts[type];
+
+	cts_stmt_bind_int(stmt, 1, param1);
+	if (1 < param_cnt)
+		cts_stmt_bind_int(stmt, 2, param2);
+
+	ret = cts_stmt_step(stmt);
+	cts_stmt_reset(stmt);
+
+	return ret;
+}
+
+static int cts_person_link_get(cts_link_info *info, int type, int param)
+{
+	int ret;
+	cts_stmt stmt = info->stmts[type];
+
+	cts_stmt_bind_int(stmt, 1, param);
+
+	ret = cts_stmt_step(stmt);
+	if (CTS_TRUE == ret)
+		ret = cts_stmt_get_int(stmt, 0);
+	else if (CTS_SUCCESS == ret)
+		ret = CTS_ERR_DB_RECORD_NOT_FOUND;
+	cts_stmt_reset(stmt);
+
+	return ret;
+}
+
+/* adds the change records of the contacts of the person */
+static int cts_person_link_noti(cts_link_info *info, int person_id)
+{
+	int ret;
+	cts_stmt stmt = info->stmts[CTS_LINK_STMT_GET_CONTACTS];
+
+	cts_stmt_bind_int(stmt, 1, person_id);
+
+	while (CTS_TRUE == (ret = cts_stmt_step(stmt)))
+		cts_add_change_noti(CTS_CHANGE_TABLE_CONTACT, cts_stmt_get_int(stmt, 0),
+				CTS_OPERATION_UPDATED);
+	cts_stmt_reset(stmt);
+
+	return ret;
+}
+
+static int cts_person_link(cts_link_info *info, int base_person_id, int sub_person_id)
 {
 	int ret;
-	char query[CTS_SQL_MIN_LEN];
 
 	retvm_if(base_person_id == sub_person_id, CTS_ERR_ARG_INVALID,
 		"base_person_id(%d), sub_person_id(%d)", base_person_id, sub_person_id);
 
+	ret = cts_person_link_noti(info, sub_person_id);
+	retvm_if(CTS_SUCCESS != ret, ret, "cts_person_link_noti() Failed(%d)", ret);
+
+	ret = cts_person_link_exec(info, CTS_LINK_STMT_MOVE_CONTACTS, 2, base_person_id, sub_person_id);
+	retvm_if(CTS_SUCCESS != ret, ret, "cts_person_link_exec() Failed(%d)", ret);
+
+	ret = cts_person_link_exec(info, CTS_LINK_STMT_MERGE_OUTGOING, 2, base_person_id, sub_person_id);
+	retvm_if(CTS_SUCCESS != ret, ret, "cts_person_link_exec() Failed(%d)", ret);
+
+	ret = cts_person_link_exec(info, CTS_LINK_STMT_DELETE_PERSON, 1, sub_person_id, 0);
+	retvm_if(CTS_SUCCESS != ret, ret, "cts_person_link_exec() Failed(%d)", ret);
+
+	return CTS_SUCCESS;
+}
+
+static int cts_person_unlink(cts_link_info *info, int person_id, int contact_id)
+{
+	int ret, outgoing_cnt, new_person;
+
+	outgoing_cnt = cts_person_link_get(info, CTS_LINK_STMT_GET_OUTGOING, person_id);
+	retvm_if(outgoing_cnt < CTS_SUCCESS, outgoing_cnt,
+			"cts_person_link_get() Failed(%d)", outgoing_cnt);
+
+	if (person_id == contact_id) {
+		new_person = cts_person_link_get(info, CTS_LINK_STMT_GET_PRIMARY, person_id);
+		retvm_if(new_person < CTS_SUCCESS, new_person,
+				"cts_person_link_get() Failed(%d)", new_person);
+
+		/* all contacts of the person move to the new person */
+		ret = cts_person_link_noti(info, person_id);
+		retvm_if(CTS_SUCCESS != ret, ret, "cts_person_link_noti() Failed(%d)", ret);
+
+		ret = cts_person_link_exec(info, CTS_LINK_STMT_MOVE_CONTACTS, 2, new_person, person_id);
+		retvm_if(CTS_SUCCESS != ret, ret, "cts_person_link_exec() Failed(%d)", ret);
+
+		ret = cts_person_link_exec(info, CTS_LINK_STMT_MOVE_PERSON, 2, new_person, person_id);
+		retvm_if(CTS_SUCCESS != ret, ret, "cts_person_link_exec() Failed(%d)", ret);
+	}
+	else {
+		cts_add_change_noti(CTS_CHANGE_TABLE_CONTACT, contact_id, CTS_OPERATION_UPDATED);
+	}
+
+	ret = cts_person_link_exec(info, CTS_LINK_STMT_INSERT_PERSON, 2, contact_id, outgoing_cnt);
+	retvm_if(CTS_SUCCESS != ret, ret, "cts_person_link_exec() Failed(%d)", ret);
+
+	ret = cts_person_link_exec(info, CTS_LINK_STMT_MOVE_CONTACT, 2, contact_id, contact_id);
+	retvm_if(CTS_SUCCESS != ret, ret, "cts_person_link_exec() Failed(%d)", ret);
+
+	return CTS_SUCCESS;
+}
+
+API int contacts_svc_link_persons(const cts_person_link_op *ops, int count)
+{
+	int i, ret;
+	cts_link_info info = {{0}};
+
+	retv_if(NULL == ops, CTS_ERR_ARG_NULL);
+	retvm_if(count <= 0, CTS_ERR_ARG_INVALID, "count(%d) is invalid", count);
+
 	ret = contacts_svc_begin_trans();
 	retvm_if(ret, ret, "contacts_svc_begin_trans() Failed(%d)", ret);
 
-	snprintf(query, sizeof(query),
-			"UPDATE %s SET person_id=%d WHERE person_id=%d",
-			CTS_TABLE_CONTACTS, base_person_id, sub_person_id);
-	ret = cts_query_exec(query);
+	ret = cts_person_link_prepare(&info);
 	if (CTS_SUCCESS != ret) {
-		ERR("cts_query_exec() Failed(%d)", ret);
+		ERR("cts_person_link_prepare() Failed(%d)", ret);
 		contacts_svc_end_trans(false);
 		return ret;
 	}
 
-	snprintf(query, sizeof(query),
-			"UPDATE %s "
-			"SET outgoing_count=(SELECT MAX(outgoing_count) FROM %s WHERE person_id IN (%d, %d))"
-			"WHERE person_id=%d",
-			CTS_TABLE_PERSONS,
-			CTS_TABLE_PERSONS, base_person_id, sub_person_id,
-			base_person_id);
-	ret = cts_query_exec(query);
-	if (CTS_SUCCESS != ret) {
-		ERR("cts_query_exec() Failed(%d)", ret);
-		contacts_svc_end_trans(false);
-		return ret;
+	for (i=0;i<count;i++) {
+		switch (ops[i].type) {
+		case CTS_PERSON_OP_LINK:
+			ret = cts_person_link(&info, ops[i].person_id, ops[i].id);
+			break;
+		case CTS_PERSON_OP_UNLINK:
+			ret = cts_person_unlink(&info, ops[i].person_id, ops[i].id);
+			break;
+		default:
+			ERR("Invalid parameter : The type(%d) of %dth op is not supported", ops[i].type, i);
+			ret = CTS_ERR_ARG_INVALID;
+			break;
+		}
+		if (CTS_SUCCESS != ret) {
+			ERR("The %dth op(%d, %d, %d) Failed(%d)", i,
+					ops[i].type, ops[i].person_id, ops[i].id, ret);
+			cts_person_link_finalize(&info);
+			contacts_svc_end_trans(false);
+			return ret;
+		}
 	}
+	cts_person_link_finalize(&info);
 
-	snprintf(query, sizeof(query), "DELETE FROM %s WHERE person_id = %d",
-			CTS_TABLE_PERSONS, sub_person_id);
-	ret = cts_query_exec(query);
-	if (CTS_SUCCESS != ret) {
-		ERR("cts_query_exec() Failed(%d)", ret);
-		contacts_svc_end_trans(false);
+	cts_set_link_noti();
+	ret = contacts_svc_end_trans(true);
+	if (ret < CTS_SUCCESS)
 		return ret;
-	}
+	else
+		return CTS_SUCCESS;
+}
 
-	cts_set_link_noti();
-	contacts_svc_end_trans(true);
+API int contacts_svc_link_person(int base_person_id, int sub_person_id)
+{
+	cts_person_link_op op = {CTS_PERSON_OP_LINK, base_person_id, sub_person_id};
 
-	return CTS_SUCCESS;
+	return contacts_svc_link_persons(&op, 1);
 }
 
 
@@ -138,49 +329,9 @@ int cts_person_change_primary_contact(int person_id)
 
 API int contacts_svc_unlink_person(int person_id, int contact_id)
 {
-	int ret, outgoing_cnt;
-	char query[CTS_SQL_MIN_LEN];
-
-	snprintf(query, sizeof(query),
-			"SELECT outgoing_count FROM %s WHERE person_id = %d",
-			CTS_TABLE_PERSONS, person_id);
+	cts_person_link_op op = {CTS_PERSON_OP_UNLINK, person_id, contact_id};
 
-	outgoing_cnt = cts_query_get_first_int_result(query);
-	retvm_if(outgoing_cnt < CTS_SUCCESS, outgoing_cnt,
-		"cts_query_get_first_int_result() Failed(%d)", outgoing_cnt);
-
-	ret = contacts_svc_begin_trans();
-	retvm_if(ret, ret, "contacts_svc_begin_trans() Failed(%d)", ret);
-
-	if (person_id == contact_id) {
-		ret = cts_person_change_primary_contact(person_id);
-		if (CTS_SUCCESS != ret) {
-			ERR("cts_person_change_primary_contact() Failed(%d)", ret);
-			contacts_svc_end_trans(false);
-			return ret;
-		}
-	}
-
-	ret = cts_insert_person(contact_id, outgoing_cnt);
-	if (CTS_SUCCESS != ret) {
-		ERR("cts_insert_person() Failed(%d)", ret);
-		contacts_svc_end_trans(false);
-		return ret;
-	}
-
-	snprintf(query, sizeof(query),
-			"UPDATE %s SET person_id=%d WHERE contact_id=%d",
-			CTS_TABLE_CONTACTS, contact_id, contact_id);
-	ret = cts_query_exec(query);
-	if (CTS_SUCCESS != ret) {
-		ERR("cts_query_exec() Failed(%d)", ret);
-		contacts_svc_end_trans(false);
-		return ret;
-	}
-	cts_set_link_noti();
-	contacts_svc_end_trans(true);
-
-	return CTS_SUCCESS;
+	return contacts_svc_link_persons(&op, 1);
 }
 
 
@@ -232,23 +383,481 @@ API int contacts_svc_get_person(int person_id, CTSstruct **person)
 	return CTS_SUCCESS;
 }
 
-/**
- * The Number can be made with a set of values by specifying one or more values.
- * \n Example : CTS_SIMILAR_NAME|CTS_SIMILAR_NUMBER
- */
-typedef enum {
-	CTS_SIMILAR_NONE = 0,
-	CTS_SIMILAR_NAME = 1<<0,
-	CTS_SIMILAR_NUMBER = 1<<1,
-	CTS_SIMILAR_EMAIL = 1<<2,
-}cts_similar_op;
+#define CTS_SIMILAR_KEY_MAX 32
+#define CTS_SIMILAR_KEY_LEN 128
+#define CTS_SIMILAR_NUMBER_SUFFIX 7
+#define CTS_SIMILAR_WEIGHT_NAME 1
+#define CTS_SIMILAR_WEIGHT_OTHER 2
+#define CTS_SIMILAR_SCORE_DEFAULT 2
+#define CTS_SIMILAR_BLOCK_MAX 64 // a larger block is a too common key(ex. "john")
+#define CTS_SIMILAR_WORKER_MAX 4
+
+typedef struct {
+	char keys[CTS_SIMILAR_KEY_MAX][CTS_SIMILAR_KEY_LEN];
+	int cnt;
+}cts_similar_keys;
+
+static void cts_similar_add_key(cts_similar_keys *info, char prefix,
+		const char *src, int suffix_len)
+{
+	int i, len;
+	char *key;
+
+	if (NULL == src || CTS_SIMILAR_KEY_MAX <= info->cnt) return;
+
+	// same with trim() and lower() of sqlite(trg_data_similar_insert)
+	while (' ' == *src) src++;
+	len = strlen(src);
+	while (len && ' ' == src[len-1]) len--;
+	if (0 < suffix_len && suffix_len < len) {
+		src += len - suffix_len;
+		len = suffix_len;
+	}
+	if (0 == len || CTS_SIMILAR_KEY_LEN <= len + 2) return;
+
+	key = info->keys[info->cnt];
+	key[0] = prefix;
+	key[1] = ':';
+	for (i=0;i<len;i++)
+		key[i+2] = ('A' <= src[i] && src[i] <= 'Z') ? src[i] - 'A' + 'a' : src[i];
+	key[len+2] = '\0';
+
+	for (i=0;i<info->cnt;i++)
+		if (!strcmp(info->keys[i], key)) return;
+	info->cnt++;
+}
 
+static void cts_similar_make_keys(cts_similar_op op_code, contact_t *contact,
+		cts_similar_keys *info)
+{
+	int ret;
+	GSList *cursor;
+	char clean_num[CTS_NUMBER_MAX_LEN];
 
-API int contacts_svc_find_similar_person(cts_similar_op op_code, CTSstruct *contact)
+	if (CTS_SIMILAR_NAME & op_code && contact->name && !contact->name->deleted) {
+		cts_similar_add_key(info, 'n', contact->name->first, 0);
+		cts_similar_add_key(info, 'n', contact->name->last, 0);
+		cts_similar_add_key(info, 'n', contact->name->display, 0);
+	}
+	if (CTS_SIMILAR_NUMBER & op_code) {
+		for (cursor=contact->numbers;cursor;cursor=cursor->next) {
+			cts_number *number = cursor->data;
+			if (NULL == number || number->deleted || NULL == number->number) continue;
+			ret = cts_clean_number(number->number, clean_num, sizeof(clean_num));
+			if (0 < ret)
+				cts_similar_add_key(info, 'p', cts_normalize_number(clean_num),
+						CTS_SIMILAR_NUMBER_SUFFIX);
+		}
+	}
+	if (CTS_SIMILAR_EMAIL & op_code) {
+		for (cursor=contact->emails;cursor;cursor=cursor->next) {
+			cts_email *email = cursor->data;
+			if (NULL == email || email->deleted) continue;
+			cts_similar_add_key(info, 'e', email->email_addr, 0);
+		}
+	}
+}
+
+static inline void cts_similar_restricted_cond(char *cond, int cond_size)
+{
+	if (cts_restriction_get_permit())
+		cond[0] = '\0';
+	else
+		snprintf(cond, cond_size,
+				"AND C.contact_id NOT IN (SELECT member FROM %s WHERE kind = %d AND scope = 0)",
+				CTS_TABLE_COUNTER_REFS, CTS_SCHEMA_COUNTER_RESTRICTED_CONTACTS);
+}
+
+API int contacts_svc_find_similar_person(cts_similar_op op_code, CTSstruct *contact,
+		cts_similar_fn cb, void *user_data)
 {
+	int i, ret, len;
+	cts_stmt stmt;
+	contact_t *record = (contact_t *)contact;
+	cts_similar_keys info;
+	char cond[CTS_SQL_MIN_LEN];
+	char query[CTS_SQL_MAX_LEN];
+
+	retv_if(NULL == contact, CTS_ERR_ARG_NULL);
+	retv_if(NULL == cb, CTS_ERR_ARG_NULL);
+	retvm_if(CTS_STRUCT_CONTACT != record->s_type, CTS_ERR_ARG_INVALID,
+			"The contact(%d) must be type of CTS_STRUCT_CONTACT.", record->s_type);
+
+	info.cnt = 0;
+	cts_similar_make_keys(op_code, record, &info);
+	retvm_if(0 == info.cnt, CTS_ERR_DB_RECORD_NOT_FOUND, "No key to find");
+
+	cts_similar_restricted_cond(cond, sizeof(cond));
+
+	// Candidates are only the persons which share a key. The key index makes it sub-linear.
+	len = snprintf(query, sizeof(query),
+			"SELECT person_id, SUM(weight) FROM "
+			"(SELECT DISTINCT C.person_id, K.key, "
+			"CASE substr(K.key, 1, 1) WHEN 'n' THEN %d ELSE %d END weight "
+			"FROM %s K, %s C WHERE K.contact_id = C.contact_id AND C.person_id != %d %s "
+			"AND K.key IN (?",
+			CTS_SIMILAR_WEIGHT_NAME, CTS_SIMILAR_WEIGHT_OTHER,
+			CTS_TABLE_SIMILAR_KEYS, CTS_TABLE_CONTACTS,
+			record->base ? record->base->person_id : 0, cond);
+	for (i=1;i<info.cnt;i++)
+		len += snprintf(query+len, sizeof(query)-len, ", ?");
+	snprintf(query+len, sizeof(query)-len, ")) GROUP BY person_id ORDER BY 2 DESC");
+
+	stmt = cts_query_prepare(query);
+	retvm_if(NULL == stmt, CTS_ERR_DB_FAILED, "cts_query_prepare() Failed");
+
+	for (i=0;i<info.cnt;i++)
+		cts_stmt_bind_text(stmt, i+1, info.keys[i]);
+
+	ret = cts_stmt_step(stmt);
+	if (CTS_TRUE != ret) {
+		warn_if(CTS_SUCCESS != ret, "cts_stmt_step() Failed(%d)", ret);
+		cts_stmt_finalize(stmt);
+		return CTS_ERR_DB_RECORD_NOT_FOUND;
+	}
+	do {
+		if (cb(cts_stmt_get_int(stmt, 0), cts_stmt_get_int(stmt, 1), user_data))
+			break;
+	} while (CTS_TRUE == cts_stmt_step(stmt));
+	cts_stmt_finalize(stmt);
+
+	return CTS_SUCCESS;
+}
+
+typedef struct {
+	int start; // the offset of ids
+	int cnt;
+	int weight;
+}cts_similar_block;
+
+typedef struct {
+	int a; // a < b
+	int b;
+	int weight;
+}cts_similar_pair;
+
+typedef struct {
+	int *ids;
+	int id_cnt;
+	cts_similar_block *blocks;
+	int block_cnt;
+	int next; /* the next block to be scored */
+	pthread_mutex_t mutex;
+}cts_similar_job;
+
+typedef struct {
+	pthread_t thread;
+	cts_similar_job *job;
+	cts_similar_pair *pairs;
+	int cnt;
+	int size;
+	int ret;
+}cts_similar_worker;
+
+static inline int cts_similar_grow(void **array, int *size, int cnt, int elem_size)
+{
+	void *tmp;
+
+	if (cnt < *size) return CTS_SUCCESS;
+
+	tmp = realloc(*array, (*size ? *size * 2 : CTS_SIMILAR_BLOCK_MAX) * elem_size);
+	retvm_if(NULL == tmp, CTS_ERR_OUT_OF_MEMORY, "realloc() Failed");
+	*size = *size ? *size * 2 : CTS_SIMILAR_BLOCK_MAX;
+	*array = tmp;
+
 	return CTS_SUCCESS;
 }
 
+static inline int cts_similar_get_blocks(cts_similar_op op_code, cts_similar_job *job)
+{
+	int ret, id_size = 0, block_size = 0;
+	int start, cnt, weight;
+	cts_stmt stmt;
+	const char *key;
+	char last_key[CTS_SIMILAR_KEY_LEN] = {0};
+	char cond[CTS_SQL_MIN_LEN];
+	char query[CTS_SQL_MAX_LEN];
+
+	cts_similar_restricted_cond(cond, sizeof(cond));
+	snprintf(query, sizeof(query),
+			"SELECT DISTINCT K.key, C.person_id FROM %s K, %s C "
+			"WHERE K.contact_id = C.contact_id %s ORDER BY K.key",
+			CTS_TABLE_SIMILAR_KEYS, CTS_TABLE_CONTACTS, cond);
+
+	stmt = cts_query_prepare(query);
+	retvm_if(NULL == stmt, CTS_ERR_DB_FAILED, "cts_query_prepare() Failed");
+
+	start = cnt = weight = 0;
+	while (CTS_TRUE == (ret = cts_stmt_step(stmt))) {
+		key = cts_stmt_get_text(stmt, 0);
+		if (NULL == key) continue;
+		if (('n' == key[0] && !(CTS_SIMILAR_NAME & op_code))
+				|| ('p' == key[0] && !(CTS_SIMILAR_NUMBER & op_code))
+				|| ('e' == key[0] && !(CTS_SIMILAR_EMAIL & op_code)))
+			continue;
+
+		if (strcmp(last_key, key)) {
+			if (1 < cnt && cnt <= CTS_SIMILAR_BLOCK_MAX) {
+				ret = cts_similar_grow((void **)&job->blocks, &block_size,
+						job->block_cnt, sizeof(cts_similar_block));
+				if (CTS_SUCCESS != ret) break;
+				job->blocks[job->block_cnt].start = start;
+				job->blocks[job->block_cnt].cnt = cnt;
+				job->blocks[job->block_cnt].weight = weight;
+				job->block_cnt++;
+			}
+			else
+				job->id_cnt = start; // the ids are not used
+
+			snprintf(last_key, sizeof(last_key), "%s", key);
+			start = job->id_cnt;
+			cnt = 0;
+			weight = ('n' == key[0]) ? CTS_SIMILAR_WEIGHT_NAME : CTS_SIMILAR_WEIGHT_OTHER;
+		}
+
+		ret = cts_similar_grow((void **)&job->ids, &id_size, job->id_cnt, sizeof(int));
+		if (CTS_SUCCESS != ret) break;
+		job->ids[job->id_cnt++] = cts_stmt_get_int(stmt, 1);
+		cnt++;
+	}
+	cts_stmt_finalize(stmt);
+	retvm_if(CTS_SUCCESS != ret, ret, "cts_stmt_step() Failed(%d)", ret);
+
+	if (1 < cnt && cnt <= CTS_SIMILAR_BLOCK_MAX) {
+		ret = cts_similar_grow((void **)&job->blocks, &block_size,
+				job->block_cnt, sizeof(cts_similar_block));
+		retv_if(CTS_SUCCESS != ret, ret);
+		job->blocks[job->block_cnt].start = start;
+		job->blocks[job->block_cnt].cnt = cnt;
+		job->blocks[job->block_cnt].weight = weight;
+		job->block_cnt++;
+	}
+
+	return CTS_SUCCESS;
+}
+
+static void* cts_similar_worker_fn(void *data)
+{
+	int i, j, index;
+	int *ids;
+	cts_similar_pair *pair;
+	cts_similar_worker *worker = data;
+	cts_similar_job *job = worker->job;
+
+	while (1) {
+		pthread_mutex_lock(&job->mutex);
+		index = job->next++;
+		pthread_mutex_unlock(&job->mutex);
+		if (job->block_cnt <= index) break;
+
+		ids = job->ids + job->blocks[index].start;
+		for (i=0;i<job->blocks[index].cnt;i++) {
+			for (j=i+1;j<job->blocks[index].cnt;j++) {
+				worker->ret = cts_similar_grow((void **)&worker->pairs, &worker->size,
+						worker->cnt, sizeof(cts_similar_pair));
+				if (CTS_SUCCESS != worker->ret) return NULL;
+
+				pair = worker->pairs + worker->cnt++;
+				pair->a = ids[i] < ids[j] ? ids[i] : ids[j];
+				pair->b = ids[i] < ids[j] ? ids[j] : ids[i];
+				pair->weight = job->blocks[index].weight;
+			}
+		}
+	}
+
+	return NULL;
+}
+
+static int cts_similar_pair_cmp(const void *a, const void *b)
+{
+	const cts_similar_pair *p1 = a, *p2 = b;
+
+	if (p1->a != p2->a)
+		return p1->a < p2->a ? -1 : 1;
+	if (p1->b != p2->b)
+		return p1->b < p2->b ? -1 : 1;
+	return 0;
+}
+
+static int cts_similar_int_cmp(const void *a, const void *b)
+{
+	const int *i1 = a, *i2 = b;
+	return *i1 < *i2 ? -1 : (*i1 > *i2);
+}
+
+static inline int cts_similar_find_root(int *parents, int i)
+{
+	while (parents[i] != i) {
+		parents[i] = parents[parents[i]];
+		i = parents[i];
+	}
+	return i;
+}
+
+static inline int cts_similar_index(int *persons, int cnt, int person_id)
+{
+	int *found = bsearch(&person_id, persons, cnt, sizeof(int), cts_similar_int_cmp);
+	return found - persons;
+}
+
+static inline int cts_similar_emit_clusters(cts_similar_pair *pairs, int pair_cnt,
+		int min_score, cts_cluster_fn cb, void *user_data)
+{
+	int i, j, a, b, cnt, start, person_cnt;
+	int *persons, *parents, *members, *ends;
+
+	// merge the scores of a same pair and keep the pairs over min_score
+	qsort(pairs, pair_cnt, sizeof(cts_similar_pair), cts_similar_pair_cmp);
+	for (i=0,cnt=0;i<pair_cnt;i=j) {
+		pairs[cnt] = pairs[i];
+		for (j=i+1;j<pair_cnt && !cts_similar_pair_cmp(pairs+i, pairs+j);j++)
+			pairs[cnt].weight += pairs[j].weight;
+		if (min_score <= pairs[cnt].weight)
+			cnt++;
+	}
+	pair_cnt = cnt;
+	retv_if(0 == pair_cnt, CTS_SUCCESS);
+
+	persons = malloc(pair_cnt * 2 * sizeof(int));
+	parents = malloc(pair_cnt * 2 * sizeof(int));
+	members = malloc(pair_cnt * 2 * sizeof(int));
+	ends = calloc(pair_cnt * 2 + 1, sizeof(int));
+	if (NULL == persons || NULL == parents || NULL == members || NULL == ends) {
+		ERR("malloc() Failed");
+		free(persons);
+		free(parents);
+		free(members);
+		free(ends);
+		return CTS_ERR_OUT_OF_MEMORY;
+	}
+
+	for (i=0;i<pair_cnt;i++) {
+		persons[i*2] = pairs[i].a;
+		persons[i*2+1] = pairs[i].b;
+	}
+	qsort(persons, pair_cnt * 2, sizeof(int), cts_similar_int_cmp);
+	for (i=1,person_cnt=1;i<pair_cnt*2;i++)
+		if (persons[i] != persons[person_cnt-1])
+			persons[person_cnt++] = persons[i];
+
+	for (i=0;i<person_cnt;i++)
+		parents[i] = i;
+	for (i=0;i<pair_cnt;i++) {
+		a = cts_similar_find_root(parents, cts_similar_index(persons, person_cnt, pairs[i].a));
+		b = cts_similar_find_root(parents, cts_similar_index(persons, person_cnt, pairs[i].b));
+		if (a < b)
+			parents[b] = a;
+		else if (b < a)
+			parents[a] = b;
+	}
+
+	// The root of a cluster is its smallest index. Members are placed in the order of roots.
+	for (i=0;i<person_cnt;i++) {
+		parents[i] = cts_similar_find_root(parents, i);
+		ends[parents[i]+1]++;
+	}
+	for (i=0;i<person_cnt;i++)
+		ends[i+1] += ends[i];
+	for (i=0;i<person_cnt;i++)
+		members[ends[parents[i]]++] = persons[i];
+
+	for (i=0;i<person_cnt;i++) {
+		if (parents[i] != i) continue;
+		start = i ? ends[i-1] : 0;
+		if (cb(members + start, ends[i] - start, user_data))
+			break;
+	}
+
+	free(ends);
+	free(members);
+	free(parents);
+	free(persons);
+	return CTS_SUCCESS;
+}
+
+API int contacts_svc_find_duplicate_clusters(cts_similar_op op_code, int min_score,
+		cts_cluster_fn cb, void *user_data)
+{
+	int i, ret, worker_cnt, created, pair_cnt;
+	cts_similar_job job = {0};
+	cts_similar_worker workers[CTS_SIMILAR_WORKER_MAX] = {{0}};
+	cts_similar_pair *pairs;
+
+	retv_if(NULL == cb, CTS_ERR_ARG_NULL);
+	retvm_if(CTS_SIMILAR_NONE == op_code, CTS_ERR_ARG_INVALID, "op_code is NONE");
+	if (min_score <= 0)
+		min_score = CTS_SIMILAR_SCORE_DEFAULT;
+
+	ret = cts_similar_get_blocks(op_code, &job);
+	if (CTS_SUCCESS != ret || 0 == job.block_cnt) {
+		warn_if(CTS_SUCCESS != ret, "cts_similar_get_blocks() Failed(%d)", ret);
+		free(job.blocks);
+		free(job.ids);
+		return ret;
+	}
+
+	/* The caller thread only reads the database. The pairs of blocks are scored by workers. */
+	pthread_mutex_init(&job.mutex, NULL);
+	worker_cnt = sysconf(_SC_NPROCESSORS_ONLN);
+	if (worker_cnt < 1)
+		worker_cnt = 1;
+	else if (CTS_SIMILAR_WORKER_MAX < worker_cnt)
+		worker_cnt = CTS_SIMILAR_WORKER_MAX;
+	if (job.block_cnt < worker_cnt)
+		worker_cnt = job.block_cnt;
+
+	for (i=0;i<worker_cnt;i++) {
+		workers[i].job = &job;
+		ret = pthread_create(&workers[i].thread, NULL, cts_similar_worker_fn, &workers[i]);
+		if (ret) {
+			ERR("pthread_create() Failed(%d)", ret);
+			break;
+		}
+	}
+	created = i;
+	for (i=0;i<created;i++)
+		pthread_join(workers[i].thread, NULL);
+
+	worker_cnt = created;
+	if (0 == worker_cnt) // score on the caller thread
+		cts_similar_worker_fn(&workers[worker_cnt++]);
+
+	ret = CTS_SUCCESS;
+	pair_cnt = 0;
+	for (i=0;i<worker_cnt;i++) {
+		if (CTS_SUCCESS != workers[i].ret)
+			ret = workers[i].ret;
+		pair_cnt += workers[i].cnt;
+	}
+	pthread_mutex_destroy(&job.mutex);
+	free(job.blocks);
+	free(job.ids);
+
+	pairs = NULL;
+	if (CTS_SUCCESS == ret && pair_cnt) {
+		pairs = malloc(pair_cnt * sizeof(cts_similar_pair));
+		if (pairs) {
+			for (i=0,pair_cnt=0;i<worker_cnt;i++) {
+				memcpy(pairs + pair_cnt, workers[i].pairs, workers[i].cnt * sizeof(cts_similar_pair));
+				pair_cnt += workers[i].cnt;
+			}
+		}
+		else {
+			ERR("malloc() Failed");
+			ret = CTS_ERR_OUT_OF_MEMORY;
+		}
+	}
+	for (i=0;i<worker_cnt;i++)
+		free(workers[i].pairs);
+
+	if (pairs) {
+		ret = cts_similar_emit_clusters(pairs, pair_cnt, min_score, cb, user_data);
+		free(pairs);
+	}
+
+	return ret;
+}
+
 
 /**
  * This function gets index of person related with the contact.
@@ -295,10 +904,7 @@ API int contacts_svc_find_person_by(cts_find_op op_code,
 	CTS_START_TIME_CHECK;
 	retv_if(NULL == user_data, CTS_ERR_ARG_NULL);
 
-	if (cts_restriction_get_permit())
-		data = CTS_TABLE_DATA;
-	else
-		data = CTS_TABLE_RESTRICTED_DATA_VIEW;
+	data = cts_addressbook_get_visible_data();
 
 	switch (op_code)
 	{
@@ -553,45 +1159,60 @@ int cts_delete_person(int index)
 }
 
 
+/*
+ * A person is named after its primary contact. When the primary contact is deleted
+ * (trg_contacts_del records it in person_orphans), the person is renamed after
+ * the smallest remaining contact or deleted if no contact remains.
+ * Only the recorded persons are examined.
+ */
 int cts_person_garbagecollection(void)
 {
 	int ret;
-	cts_stmt stmt = NULL;
 	char query[CTS_SQL_MIN_LEN];
 
-	snprintf(query, sizeof(query), "SELECT MIN(contact_id), person_id FROM %s "
-		"WHERE person_id NOT IN (SELECT person_id FROM %s WHERE contact_id = person_id) "
-		"GROUP BY person_id", CTS_TABLE_CONTACTS, CTS_TABLE_CONTACTS);
+	snprintf(query, sizeof(query),
+			"CREATE TEMP TABLE IF NOT EXISTS %s(old_id INTEGER PRIMARY KEY, new_id INTEGER)",
+			CTS_TABLE_PERSON_REMAPS);
+	ret = cts_query_exec(query);
+	retvm_if(CTS_SUCCESS != ret, ret, "cts_query_exec() Failed(%d)", ret);
 
-	stmt = cts_query_prepare(query);
-	retvm_if(NULL == stmt, CTS_ERR_DB_FAILED, "cts_query_prepare() Failed");
+	snprintf(query, sizeof(query), "DELETE FROM %s", CTS_TABLE_PERSON_REMAPS);
+	ret = cts_query_exec(query);
+	retvm_if(CTS_SUCCESS != ret, ret, "cts_query_exec() Failed(%d)", ret);
 
-	while (CTS_TRUE == cts_stmt_step(stmt)) {
-		int contact_id, person_id;
+	// new_id is NULL when no contact remains
+	snprintf(query, sizeof(query),
+			"INSERT INTO %s SELECT person_id, "
+			"(SELECT MIN(contact_id) FROM %s C WHERE C.person_id = O.person_id) FROM %s O",
+			CTS_TABLE_PERSON_REMAPS, CTS_TABLE_CONTACTS, CTS_TABLE_PERSON_ORPHANS);
+	ret = cts_query_exec(query);
+	retvm_if(CTS_SUCCESS != ret, ret, "cts_query_exec() Failed(%d)", ret);
+	if (0 == cts_db_change())
+		return CTS_SUCCESS;
 
-		contact_id = cts_stmt_get_int(stmt, 0);
-		person_id = cts_stmt_get_int(stmt, 1);
+	snprintf(query, sizeof(query),
+			"UPDATE %s SET person_id = (SELECT new_id FROM %s WHERE old_id = person_id) "
+			"WHERE person_id IN (SELECT old_id FROM %s WHERE new_id NOT NULL)",
+			CTS_TABLE_CONTACTS, CTS_TABLE_PERSON_REMAPS, CTS_TABLE_PERSON_REMAPS);
+	ret = cts_query_exec(query);
+	retvm_if(CTS_SUCCESS != ret, ret, "cts_query_exec() Failed(%d)", ret);
 
-		snprintf(query, sizeof(query),
-				"UPDATE %s SET person_id=%d WHERE person_id=%d",
-				CTS_TABLE_CONTACTS, contact_id, person_id);
-		ret = cts_query_exec(query);
-		if (CTS_SUCCESS != ret) {
-			ERR("cts_query_exec() Failed(%d)", ret);
-			cts_stmt_finalize(stmt);
-			return ret;
-		}
-		snprintf(query, sizeof(query),
-				"UPDATE %s SET person_id=%d WHERE person_id=%d",
-				CTS_TABLE_PERSONS, contact_id, person_id);
-		ret = cts_query_exec(query);
-		if (CTS_SUCCESS != ret) {
-			ERR("cts_query_exec() Failed(%d)", ret);
-			cts_stmt_finalize(stmt);
-			return ret;
-		}
-	}
-	cts_stmt_finalize(stmt);
+	snprintf(query, sizeof(query),
+			"UPDATE %s SET person_id = (SELECT new_id FROM %s WHERE old_id = person_id) "
+			"WHERE person_id IN (SELECT old_id FROM %s WHERE new_id NOT NULL)",
+			CTS_TABLE_PERSONS, CTS_TABLE_PERSON_REMAPS, CTS_TABLE_PERSON_REMAPS);
+	ret = cts_query_exec(query);
+	retvm_if(CTS_SUCCESS != ret, ret, "cts_query_exec() Failed(%d)", ret);
+
+	snprintf(query, sizeof(query),
+			"DELETE FROM %s WHERE person_id IN (SELECT old_id FROM %s WHERE new_id IS NULL)",
+			CTS_TABLE_PERSONS, CTS_TABLE_PERSON_REMAPS);
+	ret = cts_query_exec(query);
+	retvm_if(CTS_SUCCESS != ret, ret, "cts_query_exec() Failed(%d)", ret);
+
+	snprintf(query, sizeof(query), "DELETE FROM %s", CTS_TABLE_PERSON_ORPHANS);
+	ret = cts_query_exec(query);
+	retvm_if(CTS_SUCCESS != ret, ret, "cts_query_exec() Failed(%d)", ret);
 
 	return CTS_SUCCESS;
 }
@@ -624,8 +1245,9 @@ API int contacts_svc_delete_person(int index)
 		return ret;
 	}
 
+	// The person is deleted first, so that it is not recorded as an orphan.
 	snprintf(query, sizeof(query), "DELETE FROM %s WHERE person_id = %d",
-			CTS_TABLE_CONTACTS, index);
+			CTS_TABLE_PERSONS, index);
 	ret = cts_query_exec(query);
 	if (CTS_SUCCESS != ret) {
 		ERR("cts_query_exec() Failed(%d)", ret);
@@ -634,7 +1256,7 @@ API int contacts_svc_delete_person(int index)
 	}
 
 	snprintf(query, sizeof(query), "DELETE FROM %s WHERE person_id = %d",
-			CTS_TABLE_PERSONS, index);
+			CTS_TABLE_CONTACTS, index);
 	ret = cts_query_exec(query);
 	if (CTS_SUCCESS != ret) {
 		ERR("cts_query_exec() Failed(%d)", ret);
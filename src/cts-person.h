@@ -69,6 +69,50 @@ int contacts_svc_link_person(int base_person_id, int sub_person_id);
  */
 int contacts_svc_unlink_person(int person_id, int contact_id);
 
+/**
+ * The type of #cts_person_link_op
+ */
+typedef enum {
+	CTS_PERSON_OP_LINK, /**< links the person(id) to person_id */
+	CTS_PERSON_OP_UNLINK, /**< unlinks the contact(id) from person_id */
+}cts_person_link_type;
+
+/**
+ * An operation of contacts_svc_link_persons()
+ */
+typedef struct {
+	int type; /**< #cts_person_link_type */
+	int person_id; /**< The index of base person(LINK) or the person having the contact(UNLINK) */
+	int id; /**< The index of sub person(LINK) or the contact to unlink(UNLINK) */
+}cts_person_link_op;
+
+/**
+ * This function applies link and unlink operations in order, in one transaction.
+ * If an operation fails, none of them is applied.
+ * The link change is notified once.
+ *
+ * @param[in] ops The array of operations
+ * @param[in] count The number of ops
+ * @return #CTS_SUCCESS on success, Negative value(#cts_error) on error
+ * @par example
+ * @code
+ void merge_persons(void)
+ {
+    int ret;
+    cts_person_link_op ops[] = {
+       {CTS_PERSON_OP_LINK, 1, 2},
+       {CTS_PERSON_OP_LINK, 1, 3},
+       {CTS_PERSON_OP_UNLINK, 4, 5},
+    };
+
+    ret = contacts_svc_link_persons(ops, sizeof(ops)/sizeof(ops[0]));
+    if (CTS_SUCCESS != ret)
+       printf("contacts_svc_link_persons() Failed(%d)\n", ret);
+ }
+ * @endcode
+ */
+int contacts_svc_link_persons(const cts_person_link_op *ops, int count);
+
 /**
  * This function gets person record which has the index from the database.
  * If person has linked contacts, this function return merged record;
@@ -159,6 +203,87 @@ int contacts_svc_get_person(int person_id, CTSstruct **person);
  */
 int contacts_svc_find_person_by(cts_find_op op_code, const char *user_data);
 
+/**
+ * The Number can be made with a set of values by specifying one or more values.
+ * \n Example : CTS_SIMILAR_NAME|CTS_SIMILAR_NUMBER
+ */
+typedef enum {
+	CTS_SIMILAR_NONE = 0,
+	CTS_SIMILAR_NAME = 1<<0, /**< first, last or display name (case-insensitive) */
+	CTS_SIMILAR_NUMBER = 1<<1, /**< the last 7 digits of the normalized number */
+	CTS_SIMILAR_EMAIL = 1<<2, /**< email address (case-insensitive) */
+}cts_similar_op;
+
+/**
+ * This is the signature of a callback function added with contacts_svc_find_similar_person().
+ *
+ * The score is the sum of the matched keys.
+ * A name key counts 1 and a number or an email key counts 2.
+ *
+ * @param[in] person_id The index of the similar person
+ * @param[in] score The similarity score
+ * @param[in] user_data The data which is set by contacts_svc_find_similar_person()
+ * @return #CTS_SUCCESS on success, other value on error(stop)
+ */
+typedef int (*cts_similar_fn)(int person_id, int score, void *user_data);
+
+/**
+ * This function finds persons similar to the contact.
+ * Only the persons sharing a key(#cts_similar_op) with the contact are compared,
+ * so the cost does not depend on the number of contacts.
+ * The callback is called in the descending order of the score.
+ * If the contact is already inserted, its person is excluded.
+ *
+ * @param[in] op_code #cts_similar_op
+ * @param[in] contact The contact record(#CTS_STRUCT_CONTACT)
+ * @param[in] cb callback function pointer(#cts_similar_fn)
+ * @param[in] user_data data which is passed to callback function
+ * @return #CTS_SUCCESS on success, #CTS_ERR_DB_RECORD_NOT_FOUND if no similar person,
+ * Negative value(#cts_error) on error
+ */
+int contacts_svc_find_similar_person(cts_similar_op op_code, CTSstruct *contact,
+		cts_similar_fn cb, void *user_data);
+
+/**
+ * This is the signature of a callback function added with contacts_svc_find_duplicate_clusters().
+ *
+ * @param[in] person_ids The indexes of persons in a cluster. It is valid only in the callback.
+ * @param[in] count The number of person_ids(more than 1)
+ * @param[in] user_data The data which is set by contacts_svc_find_duplicate_clusters()
+ * @return #CTS_SUCCESS on success, other value on error(stop)
+ */
+typedef int (*cts_cluster_fn)(const int *person_ids, int count, void *user_data);
+
+/**
+ * This function finds all clusters of duplicated persons.
+ * Two persons are duplicated when their score(#cts_similar_fn) is not less than min_score,
+ * and a cluster is a connected set of duplicated persons.
+ * Persons are grouped by their keys and the groups are scored by worker threads.
+ * A key shared by too many persons(ex. a common first name) is ignored.
+ *
+ * @param[in] op_code #cts_similar_op
+ * @param[in] min_score The minimum score of duplicated persons. 0 means the default(2).
+ * @param[in] cb callback function pointer(#cts_cluster_fn)
+ * @param[in] user_data data which is passed to callback function
+ * @return #CTS_SUCCESS on success, Negative value(#cts_error) on error
+ * @par example
+ * @code
+ static int print_cluster(const int *person_ids, int count, void *user_data)
+ {
+    int i;
+    for (i=0;i<count;i++)
+       printf("%d ", person_ids[i]);
+    printf("\n");
+    return CTS_SUCCESS;
+ }
+
+ contacts_svc_find_duplicate_clusters(CTS_SIMILAR_NAME|CTS_SIMILAR_NUMBER, 0,
+    print_cluster, NULL);
+ * @endcode
+ */
+int contacts_svc_find_duplicate_clusters(cts_similar_op op_code, int min_score,
+		cts_cluster_fn cb, void *user_data);
+
 /**
  * Use for contacts_svc_get_person_value().
  */
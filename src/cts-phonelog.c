@@ -21,146 +21,287 @@
 
 #include <sys/types.h>
 #include <regex.h>
+#include <time.h>
 
 #include "cts-internal.h"
 #include "cts-schema.h"
 #include "cts-sqlite.h"
 #include "cts-contact.h"
 #include "cts-utils.h"
+#include "cts-list.h"
 #include "cts-types.h"
 #include "cts-normalize.h"
 #include "cts-phonelog.h"
 
 #define CTS_NAME_LEN_MAX 128
+#define CTS_PLOG_STATS_DAY 86400 // must match the day of phonelog_stats in schema.sql
+#define CTS_PLOG_PRUNE_PERIOD 64 // inserts between checking the retention policy
+#define CTS_PLOG_DEL_CHUNK 256
 
-static int cts_phonelog_accumulation_handle(cts_plog *plog)
+static int cts_phonelog_prepare_delete(const char *cond,
+		cts_stmt *select_stmt, cts_stmt *del_stmt)
 {
-	int ret, cnt, duration, total_cnt, total_duration, deal_cnt=0;
-	cts_stmt stmt = NULL;
 	char query[CTS_SQL_MAX_LEN] = {0};
 
-	snprintf(query, sizeof(query), "SELECT * FROM %s WHERE id <= 2",
-			CTS_TABLE_PHONELOG_ACC);
+	snprintf(query, sizeof(query), "SELECT id FROM %s WHERE %s LIMIT %d",
+			CTS_TABLE_PHONELOGS, cond, CTS_PLOG_DEL_CHUNK);
+	*select_stmt = cts_query_prepare(query);
+	retvm_if(NULL == *select_stmt, CTS_ERR_DB_FAILED, "cts_query_prepare() Failed");
 
-	stmt = cts_query_prepare(query);
-	retvm_if(NULL == stmt, CTS_ERR_DB_FAILED, "cts_query_prepare() Failed");
+	snprintf(query, sizeof(query), "DELETE FROM %s WHERE id = ?", CTS_TABLE_PHONELOGS);
+	*del_stmt = cts_query_prepare(query);
+	if (NULL == *del_stmt) {
+		ERR("cts_query_prepare() Failed");
+		cts_stmt_finalize(*select_stmt);
+		return CTS_ERR_DB_FAILED;
+	}
 
-	while (CTS_TRUE == cts_stmt_step(stmt))
-	{
-		ret = cts_stmt_get_int(stmt, 0);
-		if (1 == ret) {
-			cnt = cts_stmt_get_int(stmt, 1);
-			duration = cts_stmt_get_int(stmt, 3);
-			deal_cnt++;
-		}else if (2 == ret) {
-			total_cnt = cts_stmt_get_int(stmt, 1);
-			total_duration = cts_stmt_get_int(stmt, 3);
-			deal_cnt++;
+	return CTS_SUCCESS;
+}
+
+/*
+ * This deletes a chunk of the logs selected by select_stmt and records their deletion.
+ * It should be called in a transaction and returns the number of deleted logs.
+ */
+static int cts_phonelog_delete_chunk(cts_stmt select_stmt, cts_stmt del_stmt)
+{
+	int i, ret, cnt = 0;
+	int ids[CTS_PLOG_DEL_CHUNK];
+
+	while (cnt < CTS_PLOG_DEL_CHUNK && CTS_TRUE == (ret = cts_stmt_step(select_stmt)))
+		ids[cnt++] = cts_stmt_get_int(select_stmt, 0);
+	cts_stmt_reset(select_stmt);
+	retvm_if(ret < CTS_SUCCESS, ret, "cts_stmt_step() Failed(%d)", ret);
+
+	for (i=0;i<cnt;i++) {
+		cts_stmt_bind_int(del_stmt, 1, ids[i]);
+		ret = cts_stmt_step(del_stmt);
+		cts_stmt_reset(del_stmt);
+		retvm_if(CTS_SUCCESS != ret, ret, "cts_stmt_step() Failed(%d)", ret);
+		cts_add_change_noti(CTS_CHANGE_TABLE_PHONELOG, ids[i], CTS_OPERATION_DELETED);
+	}
+
+	return cnt;
+}
+
+/*
+ * This deletes the logs matched with cond by chunks in the index order of cond.
+ * It returns the number of deleted logs.
+ */
+static int cts_phonelog_delete_chunks(const char *cond)
+{
+	int ret, cnt, total = 0;
+	cts_stmt select_stmt = NULL, del_stmt = NULL;
+
+	ret = cts_phonelog_prepare_delete(cond, &select_stmt, &del_stmt);
+	retvm_if(CTS_SUCCESS != ret, ret, "cts_phonelog_prepare_delete() Failed(%d)", ret);
+
+	do {
+		cnt = cts_phonelog_delete_chunk(select_stmt, del_stmt);
+		if (cnt < CTS_SUCCESS) {
+			ERR("cts_phonelog_delete_chunk() Failed(%d)", cnt);
+			total = cnt;
+			break;
 		}
+		total += cnt;
+	} while (CTS_PLOG_DEL_CHUNK <= cnt);
+
+	cts_stmt_finalize(select_stmt);
+	cts_stmt_finalize(del_stmt);
+
+	return total;
+}
+
+static int cts_phonelog_prune_type(int type, int max_cnt, int max_age)
+{
+	int ret, cutoff, total = 0;
+	char cond[CTS_SQL_MIN_LEN];
+	char type_cond[CTS_SQL_MIN_LEN] = "";
+	char query[CTS_SQL_MAX_LEN] = {0};
+
+	if (CTS_PLOG_TYPE_NONE != type)
+		snprintf(type_cond, sizeof(type_cond), "log_type = %d AND ", type);
+
+	if (0 < max_age) {
+		snprintf(cond, sizeof(cond), "%slog_time < %ld",
+				type_cond, (long)time(NULL) - (long)max_age * CTS_PLOG_STATS_DAY);
+		ret = cts_phonelog_delete_chunks(cond);
+		retvm_if(ret < CTS_SUCCESS, ret, "cts_phonelog_delete_chunks() Failed(%d)", ret);
+		total += ret;
 	}
-	cts_stmt_finalize(stmt);
 
-	if (deal_cnt != 2) {
-		ERR("Getting plog accumulation data is Failed");
-		return CTS_ERR_DB_FAILED;
+	if (0 < max_cnt) {
+		if (CTS_PLOG_TYPE_NONE == type)
+			snprintf(query, sizeof(query),
+					"SELECT id FROM %s ORDER BY id DESC LIMIT 1 OFFSET %d",
+					CTS_TABLE_PHONELOGS, max_cnt - 1);
+		else
+			snprintf(query, sizeof(query),
+					"SELECT id FROM %s WHERE log_type = %d ORDER BY id DESC LIMIT 1 OFFSET %d",
+					CTS_TABLE_PHONELOGS, type, max_cnt - 1);
+		cutoff = cts_query_get_first_int_result(query);
+		if (0 < cutoff) {
+			snprintf(cond, sizeof(cond), "%sid < %d", type_cond, cutoff);
+			ret = cts_phonelog_delete_chunks(cond);
+			retvm_if(ret < CTS_SUCCESS, ret, "cts_phonelog_delete_chunks() Failed(%d)", ret);
+			total += ret;
+		}
 	}
 
-	snprintf(query, sizeof(query), "INSERT OR REPLACE INTO %s VALUES(?, ?, NULL, ?)",
-			CTS_TABLE_PHONELOG_ACC);
+	return total;
+}
 
+/*
+ * This enforces phonelog_retention.
+ * It should be called in a transaction and returns the number of deleted logs.
+ * It is done in a savepoint, so a failure deletes nothing
+ * and the caller can keep the rest of its transaction.
+ */
+static int cts_phonelog_prune(void)
+{
+	int ret, err, total = 0;
+	cts_stmt stmt = NULL;
+	char query[CTS_SQL_MAX_LEN] = {0};
+
+	snprintf(query, sizeof(query), "SELECT log_type, max_cnt, max_age FROM %s",
+			CTS_TABLE_PHONELOG_RETENTION);
 	stmt = cts_query_prepare(query);
 	retvm_if(NULL == stmt, CTS_ERR_DB_FAILED, "cts_query_prepare() Failed");
 
-	cts_stmt_bind_int(stmt, 1, 1);
-	cts_stmt_bind_int(stmt, 2, cnt+1);
-	cts_stmt_bind_int(stmt, 3, duration + plog->extra_data1);
-
-	ret = cts_stmt_step(stmt);
-	if (CTS_SUCCESS != ret)
-	{
-		ERR("cts_stmt_step() Failed(%d)", ret);
+	ret = cts_savepoint_begin();
+	if (CTS_SUCCESS != ret) {
+		ERR("cts_savepoint_begin() Failed(%d)", ret);
 		cts_stmt_finalize(stmt);
 		return ret;
 	}
-	cts_stmt_reset(stmt);
 
-	cts_stmt_bind_int(stmt, 1, 2);
-	cts_stmt_bind_int(stmt, 2, total_cnt+1);
-	cts_stmt_bind_int(stmt, 3, total_duration + plog->extra_data1);
+	while (CTS_TRUE == (ret = cts_stmt_step(stmt))) {
+		ret = cts_phonelog_prune_type(cts_stmt_get_int(stmt, 0),
+				cts_stmt_get_int(stmt, 1), cts_stmt_get_int(stmt, 2));
+		if (ret < CTS_SUCCESS) {
+			ERR("cts_phonelog_prune_type() Failed(%d)", ret);
+			break;
+		}
+		total += ret;
+	}
+	cts_stmt_finalize(stmt);
 
-	ret = cts_stmt_step(stmt);
-	if (CTS_SUCCESS != ret)
-	{
-		ERR("cts_stmt_step() Failed(%d)", ret);
-		cts_stmt_finalize(stmt);
+	if (ret < CTS_SUCCESS) {
+		err = cts_savepoint_end(false);
+		warn_if(CTS_SUCCESS != err, "cts_savepoint_end() Failed(%d)", err);
 		return ret;
 	}
 
-	cts_stmt_finalize(stmt);
+	ret = cts_savepoint_end(true);
+	retvm_if(CTS_SUCCESS != ret, ret, "cts_savepoint_end() Failed(%d)", ret);
 
-	return CTS_SUCCESS;
+	if (total)
+		cts_set_missed_call_noti();
+
+	return total;
 }
 
-//extra_data1 : duration, message_id, email_id
-//extra_data2 : short message, email subject
-static inline int cts_insert_phonelog(cts_plog *plog)
+static inline cts_stmt cts_phonelog_prepare_insert(void)
+{
+	char query[CTS_SQL_MAX_LEN] = {0};
+
+	snprintf(query, sizeof(query), "INSERT INTO %s("
+			"number, normal_num, related_id, log_type, log_time, data1, data2) "
+			"VALUES(?, ?, ?, ?, ?, ?, ?)", CTS_TABLE_PHONELOGS);
+
+	return cts_query_prepare(query);
+}
+
+/*
+ * Logs of a burst usually come from a few numbers in a row,
+ * so the last cleaned and normalized number is reused.
+ */
+static const char* cts_phonelog_normalize(const char *number,
+		char *last_num, char *normal_num, int size)
 {
 	int ret;
-	cts_stmt stmt = NULL;
 	char clean_num[CTS_NUMBER_MAX_LEN] = {0};
-	char query[CTS_SQL_MAX_LEN] = {0};
-	const char *normal_num;
+
+	if (*last_num && 0 == strcmp(number, last_num))
+		return *normal_num ? normal_num : NULL;
+
+	*last_num = '\0';
+	*normal_num = '\0';
+	ret = cts_clean_number(number, clean_num, sizeof(clean_num));
+	if (0 < ret)
+		snprintf(normal_num, size, "%s", cts_normalize_number(clean_num));
+	if (strlen(number) < size)
+		snprintf(last_num, size, "%s", number);
+
+	return *normal_num ? normal_num : NULL;
+}
+
+//extra_data1 : duration, message_id, email_id
+//extra_data2 : short message, email subject
+static int cts_phonelog_insert_stmt(cts_stmt stmt, cts_plog *plog,
+		char *last_num, char *normal_num)
+{
+	int ret, plog_id;
+	const char *normalized;
 
 	retvm_if(plog->log_type <= CTS_PLOG_TYPE_NONE
 			|| CTS_PLOG_TYPE_MAX <= plog->log_type,
 			CTS_ERR_ARG_INVALID, "phonelog type(%d) is invaid", plog->log_type);
 
-	snprintf(query, sizeof(query), "INSERT INTO %s("
-			"number, normal_num, related_id, log_type, log_time, data1, data2) "
-			"VALUES(?, ?, ?, %d, %d, %d, ?)",
-			CTS_TABLE_PHONELOGS, plog->log_type,
-			plog->log_time, plog->extra_data1);
-
-	stmt = cts_query_prepare(query);
-	retvm_if(NULL == stmt, CTS_ERR_DB_FAILED, "cts_query_prepare() Failed");
-
 	if (plog->number) {
 		cts_stmt_bind_text(stmt, 1, plog->number);
 		if (plog->log_type < CTS_PLOG_TYPE_EMAIL_RECEIVED) {
-			ret = cts_clean_number(plog->number, clean_num, sizeof(clean_num));
-			if (0 < ret) {
-				normal_num = cts_normalize_number(clean_num);
-				cts_stmt_bind_text(stmt, 2, normal_num);
-			}
+			normalized = cts_phonelog_normalize(plog->number, last_num, normal_num,
+					CTS_NUMBER_MAX_LEN);
+			if (normalized)
+				cts_stmt_bind_text(stmt, 2, normalized);
 		}
 	}
 
 	if (0 < plog->related_id)
 		cts_stmt_bind_int(stmt, 3, plog->related_id);
 
+	cts_stmt_bind_int(stmt, 4, plog->log_type);
+	cts_stmt_bind_int(stmt, 5, plog->log_time);
+	cts_stmt_bind_int(stmt, 6, plog->extra_data1);
+
 	if (plog->extra_data2)
-		cts_stmt_bind_text(stmt, 4, plog->extra_data2);
+		cts_stmt_bind_text(stmt, 7, plog->extra_data2);
 
 	ret = cts_stmt_step(stmt);
-	if (CTS_SUCCESS != ret)
-	{
-		ERR("cts_stmt_step() Failed(%d)", ret);
-		cts_stmt_finalize(stmt);
-		return ret;
-	}
-	cts_stmt_finalize(stmt);
+	cts_stmt_reset(stmt);
+	retvm_if(CTS_SUCCESS != ret, ret, "cts_stmt_step() Failed(%d)", ret);
 
-	if (CTS_PLOG_TYPE_VOICE_OUTGOING == plog->log_type
-			|| CTS_PLOG_TYPE_VIDEO_OUTGOING == plog->log_type)
-	{
-		ret = cts_phonelog_accumulation_handle(plog);
-		retvm_if(CTS_SUCCESS != ret, ret, "cts_phonelog_accumulation_handle() Failed");
-	}
+	plog_id = cts_db_get_last_insert_id();
+	cts_add_change_noti(CTS_CHANGE_TABLE_PHONELOG, plog_id, CTS_OPERATION_INSERTED);
 
+	/* phonelog_accumulation, phonelog_groups and phonelog_stats are maintained by triggers */
 	if (CTS_PLOG_TYPE_VOICE_INCOMMING_UNSEEN == plog->log_type ||
 			CTS_PLOG_TYPE_VIDEO_INCOMMING_UNSEEN == plog->log_type)
 		cts_set_missed_call_noti();
 
+	return plog_id;
+}
+
+static inline int cts_insert_phonelog(cts_plog *plog)
+{
+	int ret;
+	cts_stmt stmt = NULL;
+	char last_num[CTS_NUMBER_MAX_LEN] = {0};
+	char normal_num[CTS_NUMBER_MAX_LEN] = {0};
+
+	stmt = cts_phonelog_prepare_insert();
+	retvm_if(NULL == stmt, CTS_ERR_DB_FAILED, "cts_query_prepare() Failed");
+
+	ret = cts_phonelog_insert_stmt(stmt, plog, last_num, normal_num);
+	cts_stmt_finalize(stmt);
+	retvm_if(ret < CTS_SUCCESS, ret, "cts_phonelog_insert_stmt() Failed(%d)", ret);
+
+	if (0 == ret % CTS_PLOG_PRUNE_PERIOD) {
+		ret = cts_phonelog_prune();
+		warn_if(ret < CTS_SUCCESS, "cts_phonelog_prune() Failed(%d)", ret);
+	}
+
 	cts_set_plog_noti();
 	return CTS_SUCCESS;
 }
@@ -196,10 +337,93 @@ API int contacts_svc_insert_phonelog(CTSvalue* phone_log)
 		return CTS_SUCCESS;
 }
 
+API int contacts_svc_insert_phonelogs(CTSvalue **phone_logs, int count)
+{
+	int i, ret, first_id = 0, last_id = 0;
+	cts_stmt stmt = NULL;
+	cts_plog *plog;
+	char last_num[CTS_NUMBER_MAX_LEN] = {0};
+	char normal_num[CTS_NUMBER_MAX_LEN] = {0};
+
+	retv_if(NULL == phone_logs, CTS_ERR_ARG_NULL);
+	retvm_if(count <= 0, CTS_ERR_ARG_INVALID, "count(%d) is invalid", count);
+
+	for (i=0;i<count;i++) {
+		plog = (cts_plog *)phone_logs[i];
+		retvm_if(NULL == plog, CTS_ERR_ARG_NULL, "The %dth phone_log is NULL", i);
+		retvm_if(plog->id, CTS_ERR_ARG_INVALID, "The phone_log has ID(%d)", plog->id);
+	}
+
+	ret = contacts_svc_begin_trans();
+	retvm_if(ret, ret, "contacts_svc_begin_trans() Failed(%d)", ret);
+
+	stmt = cts_phonelog_prepare_insert();
+	if (NULL == stmt) {
+		ERR("cts_query_prepare() Failed");
+		contacts_svc_end_trans(false);
+		return CTS_ERR_DB_FAILED;
+	}
+
+	for (i=0;i<count;i++) {
+		plog = (cts_plog *)phone_logs[i];
+		ret = cts_phonelog_insert_stmt(stmt, plog, last_num, normal_num);
+		if (ret < CTS_SUCCESS) {
+			ERR("cts_phonelog_insert_stmt() Failed(%d)", ret);
+			cts_stmt_finalize(stmt);
+			contacts_svc_end_trans(false);
+			return ret;
+		}
+		if (0 == first_id)
+			first_id = ret;
+		last_id = ret;
+
+		if (0 < plog->related_id) {
+			ret = cts_increase_outgoing_count(plog->related_id);
+			warn_if(CTS_SUCCESS != ret, "cts_increase_outgoing_count() Failed(%d)", ret);
+		}
+	}
+	cts_stmt_finalize(stmt);
+
+	/* The retention is checked once if the ids passed a period */
+	if (first_id / CTS_PLOG_PRUNE_PERIOD != last_id / CTS_PLOG_PRUNE_PERIOD
+			|| 0 == first_id % CTS_PLOG_PRUNE_PERIOD) {
+		ret = cts_phonelog_prune();
+		warn_if(ret < CTS_SUCCESS, "cts_phonelog_prune() Failed(%d)", ret);
+	}
+	cts_set_plog_noti();
+
+	ret = contacts_svc_end_trans(true);
+	if (ret < CTS_SUCCESS)
+		return ret;
+	else
+		return CTS_SUCCESS;
+}
+
+/*
+ * This records a change of each log matched with cond.
+ * It should be called in the transaction of the change, before the change.
+ */
+static int cts_phonelog_add_change_records(const char *cond, int op)
+{
+	cts_stmt stmt = NULL;
+	char query[CTS_SQL_MAX_LEN] = {0};
+
+	snprintf(query, sizeof(query), "SELECT id FROM %s WHERE %s", CTS_TABLE_PHONELOGS, cond);
+	stmt = cts_query_prepare(query);
+	retvm_if(NULL == stmt, CTS_ERR_DB_FAILED, "cts_query_prepare() Failed");
+
+	while (CTS_TRUE == cts_stmt_step(stmt))
+		cts_add_change_noti(CTS_CHANGE_TABLE_PHONELOG, cts_stmt_get_int(stmt, 0), op);
+	cts_stmt_finalize(stmt);
+
+	return CTS_SUCCESS;
+}
+
 API int contacts_svc_delete_phonelog(cts_del_plog_op op_code, ...)
 {
 	int id, ret;
 	char *number;
+	char cond[CTS_SQL_MIN_LEN];
 	char query[CTS_SQL_MAX_LEN];
 	va_list args;
 
@@ -209,38 +433,41 @@ API int contacts_svc_delete_phonelog(cts_del_plog_op op_code, ...)
 		va_start(args, op_code);
 		id = va_arg(args, int);
 		va_end(args);
-		snprintf(query, sizeof(query), "DELETE FROM %s WHERE id = %d",
-				CTS_TABLE_PHONELOGS, id);
+		snprintf(cond, sizeof(cond), "id = %d", id);
 		break;
 	case CTS_PLOG_DEL_BY_NUMBER:
 		va_start(args, op_code);
 		number = va_arg(args, char *);
 		va_end(args);
 		retv_if(NULL == number, CTS_ERR_ARG_NULL);
-		snprintf(query, sizeof(query), "DELETE FROM %s WHERE number = '%s'",
-				CTS_TABLE_PHONELOGS, number);
+		snprintf(cond, sizeof(cond), "number = '%s'", number);
 		break;
 	case CTS_PLOG_DEL_BY_MSGID:
 		va_start(args, op_code);
 		id = va_arg(args, int);
 		va_end(args);
-		snprintf(query, sizeof(query), "DELETE FROM %s "
-				"WHERE data1 = %d AND %d <= log_type AND log_type <= %d",
-				CTS_TABLE_PHONELOGS,
+		snprintf(cond, sizeof(cond), "data1 = %d AND %d <= log_type AND log_type <= %d",
 				id, CTS_PLOG_TYPE_MMS_INCOMMING, CTS_PLOG_TYPE_MMS_BLOCKED);
 		break;
 	case CTS_PLOG_DEL_NO_NUMBER:
-		snprintf(query, sizeof(query), "DELETE FROM %s WHERE number ISNULL",
-				CTS_TABLE_PHONELOGS);
+		snprintf(cond, sizeof(cond), "number ISNULL");
 		break;
 	default:
 		ERR("Invalid op_code. Your op_code(%d) is not supported.", op_code);
 		return CTS_ERR_ARG_INVALID;
 	}
+	snprintf(query, sizeof(query), "DELETE FROM %s WHERE %s", CTS_TABLE_PHONELOGS, cond);
 
 	ret = contacts_svc_begin_trans();
 	retvm_if(ret, ret, "contacts_svc_begin_trans() Failed(%d)", ret);
 
+	ret = cts_phonelog_add_change_records(cond, CTS_OPERATION_DELETED);
+	if (CTS_SUCCESS != ret) {
+		ERR("cts_phonelog_add_change_records() Failed(%d)", ret);
+		contacts_svc_end_trans(false);
+		return ret;
+	}
+
 	ret = cts_query_exec(query);
 	if (CTS_SUCCESS != ret) {
 		ERR("cts_query_exec() Failed(%d)", ret);
@@ -258,6 +485,142 @@ API int contacts_svc_delete_phonelog(cts_del_plog_op op_code, ...)
 		return CTS_SUCCESS;
 }
 
+API int contacts_svc_delete_phonelog_by_time(int start_time, int end_time)
+{
+	int ret, cnt, total = 0;
+	cts_stmt select_stmt = NULL, del_stmt = NULL;
+	char cond[CTS_SQL_MIN_LEN] = {0};
+
+	retvm_if(end_time < start_time, CTS_ERR_ARG_INVALID,
+			"end_time(%d) is before start_time(%d)", end_time, start_time);
+
+	snprintf(cond, sizeof(cond), "%d <= log_time AND log_time <= %d", start_time, end_time);
+	ret = cts_phonelog_prepare_delete(cond, &select_stmt, &del_stmt);
+	retvm_if(CTS_SUCCESS != ret, ret, "cts_phonelog_prepare_delete() Failed(%d)", ret);
+
+	/* Each chunk is committed separately not to block other writers for a long time */
+	do {
+		ret = contacts_svc_begin_trans();
+		if (ret) {
+			ERR("contacts_svc_begin_trans() Failed(%d)", ret);
+			break;
+		}
+
+		cnt = cts_phonelog_delete_chunk(select_stmt, del_stmt);
+		if (cnt < CTS_SUCCESS) {
+			ERR("cts_phonelog_delete_chunk() Failed(%d)", cnt);
+			contacts_svc_end_trans(false);
+			ret = cnt;
+			break;
+		}
+		total += cnt;
+		if (cnt) {
+			cts_set_plog_noti();
+			cts_set_missed_call_noti();
+		}
+
+		ret = contacts_svc_end_trans(true);
+		if (ret < CTS_SUCCESS) {
+			ERR("contacts_svc_end_trans() Failed(%d)", ret);
+			break;
+		}
+		ret = CTS_SUCCESS;
+	} while (CTS_PLOG_DEL_CHUNK <= cnt);
+
+	cts_stmt_finalize(select_stmt);
+	cts_stmt_finalize(del_stmt);
+
+	CTS_DBG("%d logs are deleted", total);
+	return ret;
+}
+
+API int contacts_svc_phonelog_set_retention(int log_type, int max_count, int max_days)
+{
+	int ret;
+	char query[CTS_SQL_MAX_LEN] = {0};
+
+	retvm_if(log_type < CTS_PLOG_TYPE_NONE || CTS_PLOG_TYPE_MAX <= log_type,
+			CTS_ERR_ARG_INVALID, "phonelog type(%d) is invalid", log_type);
+	retvm_if(max_count < 0 || max_days < 0, CTS_ERR_ARG_INVALID,
+			"max_count(%d) or max_days(%d) is invalid", max_count, max_days);
+
+	if (0 == max_count && 0 == max_days)
+		snprintf(query, sizeof(query), "DELETE FROM %s WHERE log_type = %d",
+				CTS_TABLE_PHONELOG_RETENTION, log_type);
+	else
+		snprintf(query, sizeof(query), "INSERT OR REPLACE INTO %s VALUES(%d, %d, %d)",
+				CTS_TABLE_PHONELOG_RETENTION, log_type, max_count, max_days);
+
+	ret = contacts_svc_begin_trans();
+	retvm_if(ret, ret, "contacts_svc_begin_trans() Failed(%d)", ret);
+
+	ret = cts_query_exec(query);
+	if (CTS_SUCCESS != ret) {
+		ERR("cts_query_exec() Failed(%d)", ret);
+		contacts_svc_end_trans(false);
+		return ret;
+	}
+
+	ret = contacts_svc_end_trans(true);
+	if (ret < CTS_SUCCESS)
+		return ret;
+	else
+		return CTS_SUCCESS;
+}
+
+API int contacts_svc_phonelog_prune(void)
+{
+	int ret;
+
+	ret = contacts_svc_begin_trans();
+	retvm_if(ret, ret, "contacts_svc_begin_trans() Failed(%d)", ret);
+
+	ret = cts_phonelog_prune();
+	if (ret < CTS_SUCCESS) {
+		ERR("cts_phonelog_prune() Failed(%d)", ret);
+		contacts_svc_end_trans(false);
+		return ret;
+	}
+	if (ret)
+		cts_set_plog_noti();
+
+	ret = contacts_svc_end_trans(true);
+	if (ret < CTS_SUCCESS)
+		return ret;
+	else
+		return CTS_SUCCESS;
+}
+
+API int contacts_svc_phonelog_get_unseen_missed_call(int *count, int *version)
+{
+	int ret;
+	cts_stmt stmt = NULL;
+	char query[CTS_SQL_MAX_LEN] = {0};
+
+	retv_if(NULL == count, CTS_ERR_ARG_NULL);
+
+	snprintf(query, sizeof(query),
+			"SELECT SUM(log_cnt), SUM(ver) FROM %s WHERE log_type = %d OR log_type = %d",
+			CTS_TABLE_PHONELOG_COUNTS,
+			CTS_PLOG_TYPE_VOICE_INCOMMING_UNSEEN, CTS_PLOG_TYPE_VIDEO_INCOMMING_UNSEEN);
+
+	stmt = cts_query_prepare(query);
+	retvm_if(NULL == stmt, CTS_ERR_DB_FAILED, "cts_query_prepare() Failed");
+
+	ret = cts_stmt_step(stmt);
+	if (CTS_TRUE != ret) {
+		ERR("cts_stmt_step() Failed(%d)", ret);
+		cts_stmt_finalize(stmt);
+		return CTS_ERR_DB_FAILED;
+	}
+	*count = cts_stmt_get_int(stmt, 0);
+	if (version)
+		*version = cts_stmt_get_int(stmt, 1);
+	cts_stmt_finalize(stmt);
+
+	return CTS_SUCCESS;
+}
+
 API int contacts_svc_get_phonelog(int plog_id, CTSvalue **phonelog)
 {
 	int ret;
@@ -309,6 +672,7 @@ API int contacts_svc_get_phonelog(int plog_id, CTSvalue **phonelog)
 API int contacts_svc_phonelog_set_seen(int index, int type)
 {
 	int ret;
+	char cond[CTS_SQL_MIN_LEN] = {0};
 	char query[CTS_SQL_MAX_LEN] = {0};
 
 	retvm_if(CTS_PLOG_TYPE_VOICE_INCOMMING_UNSEEN != type &&
@@ -319,22 +683,34 @@ API int contacts_svc_phonelog_set_seen(int index, int type)
 			" or CTS_PLOG_TYPE_VIDEO_INCOMMING_UNSEEN");
 
 	if (0 == index) {
-		if (CTS_PLOG_TYPE_NONE == type)
-			snprintf(query, sizeof(query), "UPDATE %s SET log_type = log_type + 1 WHERE log_type = %d OR log_type = %d",
-					CTS_TABLE_PHONELOGS, CTS_PLOG_TYPE_VOICE_INCOMMING_UNSEEN,
-					CTS_PLOG_TYPE_VIDEO_INCOMMING_UNSEEN);
-		else
-			snprintf(query, sizeof(query), "UPDATE %s SET log_type = %d WHERE log_type = %d",
-					CTS_TABLE_PHONELOGS, type+1, type);
+		if (CTS_PLOG_TYPE_NONE == type) {
+			snprintf(cond, sizeof(cond), "log_type = %d OR log_type = %d",
+					CTS_PLOG_TYPE_VOICE_INCOMMING_UNSEEN, CTS_PLOG_TYPE_VIDEO_INCOMMING_UNSEEN);
+			snprintf(query, sizeof(query), "UPDATE %s SET log_type = log_type + 1 WHERE %s",
+					CTS_TABLE_PHONELOGS, cond);
+		}
+		else {
+			snprintf(cond, sizeof(cond), "log_type = %d", type);
+			snprintf(query, sizeof(query), "UPDATE %s SET log_type = %d WHERE %s",
+					CTS_TABLE_PHONELOGS, type+1, cond);
+		}
 	}
 	else {
-		snprintf(query, sizeof(query), "UPDATE %s SET log_type = %d WHERE id = %d",
-				CTS_TABLE_PHONELOGS, type+1, index);
+		snprintf(cond, sizeof(cond), "id = %d", index);
+		snprintf(query, sizeof(query), "UPDATE %s SET log_type = %d WHERE %s",
+				CTS_TABLE_PHONELOGS, type+1, cond);
 	}
 
 	ret = contacts_svc_begin_trans();
 	retvm_if(ret, ret, "contacts_svc_begin_trans() Failed(%d)", ret);
 
+	ret = cts_phonelog_add_change_records(cond, CTS_OPERATION_UPDATED);
+	if (CTS_SUCCESS != ret) {
+		ERR("cts_phonelog_add_change_records() Failed(%d)", ret);
+		contacts_svc_end_trans(false);
+		return ret;
+	}
+
 	ret = cts_query_exec(query);
 	if (CTS_SUCCESS != ret) {
 		ERR("cts_query_exec() Failed(%d)", ret);
@@ -444,3 +820,48 @@ API char* contacts_svc_phonelog_get_last_number(cts_plog_get_last_op op)
 
 	return number;
 }
+
+API int contacts_svc_phonelog_get_stats(cts_plog_stats_op op, int start_time,
+		int end_time, cts_plog_stats_fn cb, void *user_data)
+{
+	int ret;
+	cts_stmt stmt = NULL;
+	char query[CTS_SQL_MAX_LEN] = {0};
+
+	retv_if(NULL == cb, CTS_ERR_ARG_NULL);
+	retvm_if(end_time < start_time, CTS_ERR_ARG_INVALID,
+			"end_time(%d) is before start_time(%d)", end_time, start_time);
+
+	switch (op) {
+	case CTS_PLOG_STATS_BY_DAY:
+		snprintf(query, sizeof(query),
+				"SELECT day, log_type, log_cnt, duration FROM %s "
+				"WHERE %d <= day AND day <= %d AND 0 < log_cnt ORDER BY day, log_type",
+				CTS_TABLE_PHONELOG_STATS,
+				start_time / CTS_PLOG_STATS_DAY, end_time / CTS_PLOG_STATS_DAY);
+		break;
+	case CTS_PLOG_STATS_BY_TYPE:
+		snprintf(query, sizeof(query),
+				"SELECT -1, log_type, SUM(log_cnt), SUM(duration) FROM %s "
+				"WHERE %d <= day AND day <= %d GROUP BY log_type HAVING 0 < SUM(log_cnt)",
+				CTS_TABLE_PHONELOG_STATS,
+				start_time / CTS_PLOG_STATS_DAY, end_time / CTS_PLOG_STATS_DAY);
+		break;
+	default:
+		ERR("Invalid op(%d)", op);
+		return CTS_ERR_ARG_INVALID;
+	}
+
+	stmt = cts_query_prepare(query);
+	retvm_if(NULL == stmt, CTS_ERR_DB_FAILED, "cts_query_prepare() Failed");
+
+	while (CTS_TRUE == (ret = cts_stmt_step(stmt))) {
+		if (cb(cts_stmt_get_int(stmt, 0), cts_stmt_get_int(stmt, 1),
+					cts_stmt_get_int(stmt, 2), cts_stmt_get_int(stmt, 3), user_data))
+			break;
+	}
+	cts_stmt_finalize(stmt);
+	retvm_if(ret < CTS_SUCCESS, ret, "cts_stmt_step() Failed(%d)", ret);
+
+	return CTS_SUCCESS;
+}
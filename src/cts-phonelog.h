@@ -81,6 +81,38 @@ typedef enum{
 	CTS_PLOG_DEL_NO_NUMBER, /**< .*/
 	CTS_PLOG_DEL_BY_MSGID, /**< .*/
 }cts_del_plog_op;
+/**
+ * This function inserts phone logs to database at once.
+ * \n It is for inserting many logs(ex. synchronizing messages).
+ * All logs are inserted in one transaction with one prepared statement,
+ * and the change is notified once.
+ * If one of them fails, nothing is inserted.
+ *
+ * @param[in] phone_logs The array of phone logs created by contacts_svc_value_new(CTS_VALUE_PHONELOG).
+ * @param[in] count The number of phone_logs
+ * @return #CTS_SUCCESS on success, Negative value(#cts_error) on error
+ * @par example
+ * @code
+ void insert_sms_logs(const char **numbers, int count)
+ {
+    int i;
+    CTSvalue *logs[count];
+
+    for (i=0;i<count;i++) {
+       logs[i] = contacts_svc_value_new(CTS_VALUE_PHONELOG);
+       contacts_svc_value_set_str(logs[i], CTS_PLOG_VAL_ADDRESS_STR, numbers[i]);
+       contacts_svc_value_set_int(logs[i], CTS_PLOG_VAL_LOG_TIME_INT, (int)time(NULL));
+       contacts_svc_value_set_int(logs[i], CTS_PLOG_VAL_LOG_TYPE_INT, CTS_PLOG_TYPE_SMS_INCOMMING);
+    }
+    contacts_svc_insert_phonelogs(logs, count);
+
+    for (i=0;i<count;i++)
+       contacts_svc_value_free(logs[i]);
+ }
+ * @endcode
+ */
+int contacts_svc_insert_phonelogs(CTSvalue **phone_logs, int count);
+
 /**
  * This function deletes a phone log with op_code(#CTS_PLOG_DEL_BY_ID, #CTS_PLOG_DEL_BY_NUMBER).
  * @par int contacts_svc_delete_phonelog(CTS_PLOG_DEL_BY_ID, int index)
@@ -99,6 +131,50 @@ typedef enum{
  */
 int contacts_svc_delete_phonelog(cts_del_plog_op op_code, ...);
 
+/**
+ * This function deletes the phone logs whose log time is from start_time to end_time.
+ * \n The logs are deleted by chunks and each chunk is committed separately,
+ * so other writers are not blocked until all logs are deleted.
+ * If it is called in a transaction, the chunks are committed with the transaction.
+ *
+ * @param[in] start_time The time since the Epoch
+ * @param[in] end_time The time since the Epoch(inclusive)
+ * @return #CTS_SUCCESS on success, Negative value(#cts_error) on error
+ * @par example
+ * @code
+ // deletes the logs older than 30 days
+ contacts_svc_delete_phonelog_by_time(0, time(NULL) - 30*86400);
+ * @endcode
+ */
+int contacts_svc_delete_phonelog_by_time(int start_time, int end_time);
+
+/**
+ * This function sets the retention policy of phone logs.
+ * \n The policy is kept in the database and checked periodically when phone logs are inserted.
+ * contacts_svc_phonelog_prune() applies it at once.
+ * If both max_count and max_days are 0, the policy of the log_type is removed.
+ *
+ * @param[in] log_type #PLOGTYPE, or #CTS_PLOG_TYPE_NONE for all phone logs
+ * @param[in] max_count The maximum number of logs to keep(0 is unlimited)
+ * @param[in] max_days The logs older than this are deleted(0 is unlimited)
+ * @return #CTS_SUCCESS on success, Negative value(#cts_error) on error
+ * @par example
+ * @code
+ contacts_svc_phonelog_set_retention(CTS_PLOG_TYPE_NONE, 1000, 0);
+ contacts_svc_phonelog_set_retention(CTS_PLOG_TYPE_VOICE_INCOMMING_SEEN, 100, 30);
+ * @endcode
+ */
+int contacts_svc_phonelog_set_retention(int log_type, int max_count, int max_days);
+
+/**
+ * This function deletes the phone logs exceeding the retention policy
+ * set by contacts_svc_phonelog_set_retention().
+ * \n It can be called by a background job.
+ *
+ * @return #CTS_SUCCESS on success, Negative value(#cts_error) on error
+ */
+int contacts_svc_phonelog_prune(void);
+
 /**
  * This function modifies a phone log from unseen to seen.
  * \n Type should be #CTS_PLOG_TYPE_VOICE_INCOMMING_UNSEEN or #CTS_PLOG_TYPE_VIDEO_INCOMMING_UNSEEN
@@ -112,6 +188,35 @@ int contacts_svc_delete_phonelog(cts_del_plog_op op_code, ...);
  */
 int contacts_svc_phonelog_set_seen(int index, int type);
 
+/**
+ * This function gets the count of unseen missed calls.
+ * \n The count is kept while phone logs are inserted, deleted and set seen,
+ * so this doesn't scan the phone logs.
+ * The version is increased whenever the count is changed.
+ * A client which keeps the version of its data(ex. badge, missed call list)
+ * can skip reloading it when the version is not changed.
+ *
+ * @param[out] count The count of unseen missed calls
+ * @param[out] version The version of the count. It can be NULL.
+ * @return #CTS_SUCCESS on success, Negative value(#cts_error) on error
+ * @par example
+ * @code
+ static int badge_ver = -1;
+
+ void missed_call_changed_cb(void *data)
+ {
+    int count, version;
+
+    contacts_svc_phonelog_get_unseen_missed_call(&count, &version);
+    if (version == badge_ver) return;
+
+    badge_ver = version;
+    printf("unseen missed calls : %d\n", count);
+ }
+ * @endcode
+ */
+int contacts_svc_phonelog_get_unseen_missed_call(int *count, int *version);
+
 /**
  * Use for contacts_svc_phonelog_get_last_number().
  */
@@ -164,6 +269,53 @@ char* contacts_svc_phonelog_get_last_number(cts_plog_get_last_op op);
  */
 int contacts_svc_get_phonelog(int plog_id, CTSvalue **phonelog);
 
+/**
+ * Use for contacts_svc_phonelog_get_stats().
+ */
+typedef enum{
+	CTS_PLOG_STATS_BY_DAY, /**< a row per day and log type */
+	CTS_PLOG_STATS_BY_TYPE, /**< a row per log type summed over the range. day is -1 */
+}cts_plog_stats_op;
+
+/**
+ * This is the signature of a callback function added with contacts_svc_phonelog_get_stats().
+ * \n If this function doesn't return #CTS_SUCCESS, the iteration is terminated.
+ *
+ * @param[in] day The day since the Epoch(log_time / 86400, UTC), or -1 for #CTS_PLOG_STATS_BY_TYPE
+ * @param[in] log_type #PLOGTYPE
+ * @param[in] count The number of logs
+ * @param[in] duration The sum of durations in seconds. It is 0 except for call types.
+ * @param[in] user_data The data which is set by contacts_svc_phonelog_get_stats()
+ * @return #CTS_SUCCESS on success, other value on error
+ */
+typedef int (*cts_plog_stats_fn)(int day, int log_type, int count, int duration, void *user_data);
+
+/**
+ * This function gets the phone log statistics of the days from start_time to end_time.
+ * \n The statistics are kept per day(UTC) and log type while logs are inserted, updated and deleted,
+ * so this doesn't scan the phone logs.
+ *
+ * @param[in] op #cts_plog_stats_op
+ * @param[in] start_time The time since the Epoch. The day including it is the first day.
+ * @param[in] end_time The time since the Epoch. The day including it is the last day.
+ * @param[in] cb callback function pointer(#cts_plog_stats_fn)
+ * @param[in] user_data data which is passed to callback function
+ * @return #CTS_SUCCESS on success, Negative value(#cts_error) on error
+ * @par example
+ * @code
+ int print_stats(int day, int log_type, int count, int duration, void *user_data)
+ {
+    printf("day %d, type %d : %d logs, %d seconds\n", day, log_type, count, duration);
+    return CTS_SUCCESS;
+ }
+
+ time_t now = time(NULL);
+ contacts_svc_phonelog_get_stats(CTS_PLOG_STATS_BY_DAY, now - 7*86400, now, print_stats, NULL);
+ * @endcode
+ */
+int contacts_svc_phonelog_get_stats(cts_plog_stats_op op, int start_time,
+		int end_time, cts_plog_stats_fn cb, void *user_data);
+
 /**
  * @}
  */
@@ -37,6 +37,7 @@ static cts_thread_fns cts_thread_funtions =
 static pthread_mutex_t conn_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_mutex_t sockfd_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_mutex_t trans_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t mempool_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 
 static inline pthread_mutex_t* cts_pthread_get_mutex(int type)
@@ -53,6 +54,9 @@ static inline pthread_mutex_t* cts_pthread_get_mutex(int type)
 	case CTS_MUTEX_TRANSACTION:
 		ret_val = &trans_mutex;
 		break;
+	case CTS_MUTEX_MEMPOOL:
+		ret_val = &mempool_mutex;
+		break;
 	default:
 		ERR("unknown type(%d)", type);
 		ret_val = NULL;
@@ -26,6 +26,7 @@ enum {
 	CTS_MUTEX_UPDTATED_LIST_MEMPOOL,
 	CTS_MUTEX_SOCKET_FD,
 	CTS_MUTEX_TRANSACTION,
+	CTS_MUTEX_MEMPOOL,
 };
 
 void cts_mutex_lock(int type);
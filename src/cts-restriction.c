@@ -30,6 +30,9 @@ static int cts_restriction_permit;
 
 int cts_restriction_init(void)
 {
+	int ret;
+	char query[CTS_SQL_MIN_LEN];
+
 	if (!cts_restriction_permit) {
 		int fd = open(CTS_RESTRICTION_CHECK_FILE, O_RDONLY);
 		if (0 <= fd) {
@@ -40,13 +43,20 @@ int cts_restriction_init(void)
 		}
 	}
 	if (!cts_restriction_permit) {
-		int ret;
-		const char *query;
-		query = "CREATE TEMP VIEW "CTS_TABLE_RESTRICTED_DATA_VIEW" AS SELECT * FROM "CTS_TABLE_DATA" WHERE is_restricted != 1";
-
-		ret = cts_query_exec(query);
+		ret = cts_query_exec("CREATE TEMP VIEW "CTS_TABLE_RESTRICTED_DATA_VIEW" AS SELECT * FROM "CTS_TABLE_DATA" WHERE is_restricted != 1");
 		retvm_if(CTS_SUCCESS != ret, ret, "cts_query_exec() Failed(%d)", ret);
 	}
+
+	/* It is used only while an addressbook is being deleted(cts_addressbook_get_visible_data()) */
+	snprintf(query, sizeof(query), "CREATE TEMP VIEW %s AS SELECT * FROM %s "
+			"WHERE contact_id NOT IN (SELECT contact_id FROM %s "
+			"WHERE addrbook_id IN (SELECT addrbook_id FROM %s WHERE deleting = 1))",
+			CTS_TABLE_VISIBLE_DATA_VIEW,
+			cts_restriction_permit?CTS_TABLE_DATA:CTS_TABLE_RESTRICTED_DATA_VIEW,
+			CTS_TABLE_CONTACTS, CTS_TABLE_ADDRESSBOOKS);
+	ret = cts_query_exec(query);
+	retvm_if(CTS_SUCCESS != ret, ret, "cts_query_exec() Failed(%d)", ret);
+
 	return CTS_SUCCESS;
 }
 
@@ -33,6 +33,8 @@
 
 // Tables
 #define CTS_TABLE_PERSONS "persons"
+#define CTS_TABLE_PERSON_ORPHANS "person_orphans"
+#define CTS_TABLE_PERSON_REMAPS "temp.person_remaps"
 #define CTS_TABLE_CONTACTS "contacts"
 #define CTS_TABLE_GROUPS "groups"
 #define CTS_TABLE_ADDRESSBOOKS "addressbooks"
@@ -40,22 +42,43 @@
 #define CTS_TABLE_FAVORITES "favorites"
 #define CTS_TABLE_PHONELOGS "phonelogs"
 #define CTS_TABLE_PHONELOG_ACC "phonelog_accumulation"
+#define CTS_TABLE_PHONELOG_STATS "phonelog_stats"
+#define CTS_TABLE_PHONELOG_COUNTS "phonelog_counts"
+#define CTS_TABLE_PHONELOG_GROUPS "phonelog_groups"
+#define CTS_TABLE_PHONELOG_RETENTION "phonelog_retention"
 #define CTS_TABLE_GROUPING_INFO "group_relations"
 #define CTS_TABLE_DELETEDS "deleteds"
 #define CTS_TABLE_GROUP_DELETEDS "group_deleteds"
+#define CTS_TABLE_GROUP_RELATIONS_LOG "group_relations_log"
 #define CTS_TABLE_CUSTOM_TYPES "custom_types"
 #define CTS_TABLE_SIM_SERVICES "sim_services"
 #define CTS_TABLE_SPEEDDIALS "speeddials"
 #define CTS_TABLE_VERSION "cts_version"
 #define CTS_TABLE_MY_PROFILES "my_profiles"
+#define CTS_TABLE_COUNTERS "counters"
+#define CTS_TABLE_COUNTER_REFS "counter_refs"
+#define CTS_TABLE_SIMILAR_KEYS "similar_keys"
 
 #define CTS_TABLE_RESTRICTED_DATA_VIEW "restricted_data"
+#define CTS_TABLE_VISIBLE_DATA_VIEW "visible_data"
 
 #define CTS_SCHEMA_DATA_NAME_LANG_INFO "data1"
 #define CTS_SCHEMA_DATA_NAME_LOOKUP "data8"
 #define CTS_SCHEMA_DATA_NAME_REVERSE_LOOKUP "data9"
 #define CTS_SCHEMA_DATA_NAME_SORTING_KEY "data10"
 
+#define CTS_SCHEMA_PLOG_GROUP_ALL 0 // calls and messages
+#define CTS_SCHEMA_PLOG_GROUP_CALL 1
+#define CTS_SCHEMA_PLOG_GROUP_MSG 2
+
+// The kinds of counters and counter_refs(schema.sql)
+#define CTS_SCHEMA_COUNTER_PERSONS 1
+#define CTS_SCHEMA_COUNTER_PERSONS_IN_ADDRESSBOOK 2
+#define CTS_SCHEMA_COUNTER_PERSONS_IN_GROUP 3
+#define CTS_SCHEMA_COUNTER_NO_GROUP_PERSONS_IN_ADDRESSBOOK 4
+#define CTS_SCHEMA_COUNTER_GROUPS_IN_ADDRESSBOOK 5
+#define CTS_SCHEMA_COUNTER_RESTRICTED_CONTACTS 6
+
 #define CTS_SCHEMA_SQLITE_SEQ "sqlite_sequence"
 
 
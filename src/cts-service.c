@@ -30,6 +30,7 @@
 #include "cts-list.h"
 #include "cts-pthread.h"
 #include "cts-restriction.h"
+#include "cts-mempool.h"
 #include "cts-service.h"
 
 static int cts_conn_refcnt = 0;
@@ -96,6 +97,7 @@ API int contacts_svc_disconnect(void)
 		cts_deregister_noti();
 		cts_db_close();
 		cts_restriction_final();
+		cts_mempool_trim();
 		cts_conn_refcnt--;
 	}
 	else
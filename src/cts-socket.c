@@ -71,7 +71,7 @@ static int cts_socket_handle_return(int fd, cts_socket_msg *msg)
 	ret = cts_safe_read(fd, (char *)msg, sizeof(cts_socket_msg));
 	retvm_if(-1 == ret, CTS_ERR_SOCKET_FAILED, "cts_safe_read() Failed(errno = %d)", errno);
 
-	warn_if(CTS_REQUEST_RETURN_VALUE != msg->type,
+	warn_if(CTS_REQUEST_RETURN_VALUE != msg->type && CTS_REQUEST_PROGRESS != msg->type,
 			"Unknown Type(%d), ret=%d, attach_num= %d,"
 			"attach1 = %d, attach2 = %d, attach3 = %d, attach4 = %d",
 			msg->type, msg->val, msg->attach_num,
@@ -113,7 +113,8 @@ static void cts_remove_invalid_msg(int fd, int size)
 	}
 }
 
-int cts_request_sim_import(void)
+int cts_request_sim_import(void (*progress_cb)(int imported, int total, void *data),
+		void *user_data)
 {
 	int i, ret;
 	cts_socket_msg msg={0};
@@ -121,11 +122,17 @@ int cts_request_sim_import(void)
 	retvm_if(-1 == cts_csockfd, CTS_ERR_ENV_INVALID, "socket is not connected");
 
 	msg.type = CTS_REQUEST_IMPORT_SIM;
+	msg.val = progress_cb ? 1 : 0; /* The helper sends progress before the return */
 	ret = cts_safe_write(cts_csockfd, (char *)&msg, sizeof(msg));
 	retvm_if(-1 == ret, CTS_ERR_SOCKET_FAILED, "cts_safe_write() Failed(errno = %d)", errno);
 
-	ret = cts_socket_handle_return(cts_csockfd, &msg);
-	retvm_if(CTS_SUCCESS != ret, ret, "cts_socket_handle_return() Failed(%d)", ret);
+	do {
+		ret = cts_socket_handle_return(cts_csockfd, &msg);
+		retvm_if(CTS_SUCCESS != ret, ret, "cts_socket_handle_return() Failed(%d)", ret);
+
+		if (CTS_REQUEST_PROGRESS == msg.type && progress_cb)
+			progress_cb(msg.val, msg.attach_sizes[0], user_data);
+	} while (CTS_REQUEST_PROGRESS == msg.type);
 	CTS_DBG("attach_num = %d", msg.attach_num);
 
 	for (i=0;i<msg.attach_num;i++)
@@ -34,6 +34,7 @@ enum{
 	CTS_REQUEST_NORMALIZE_STR,
 	CTS_REQUEST_NORMALIZE_NAME,
 	CTS_REQUEST_EXPORT_SIM,
+	CTS_REQUEST_PROGRESS, /* val = done, attach_sizes[0] = total(It is not attachment) */
 };
 //#define CTS_REQUEST_IMPORT_SIM "cts_request_import_sim"
 //#define CTS_REQUEST_NORMALIZE_STR "cts_request_normalize_str"
@@ -53,7 +54,8 @@ typedef struct{
 int cts_socket_init(void);
 int cts_request_normalize_name(char dest[][CTS_SQL_MAX_LEN]);
 int cts_request_normalize_str(const char * src, char * dest, int dest_size);
-int cts_request_sim_import(void);
+int cts_request_sim_import(void (*progress_cb)(int imported, int total, void *data),
+		void *user_data);
 int cts_request_sim_export(int index);
 void cts_socket_final(void);
 
@@ -24,16 +24,7 @@
 #include "cts-internal.h"
 #include "cts-list.h"
 #include "cts-utils.h"
-
-static contact_list *contact_list_mempool=NULL;
-static plog_list *plog_list_mempool=NULL;
-static change_list *change_list_mempool=NULL;
-static numtype_list *numtype_list_mempool=NULL;
-static shortcut_list *favorite_list_mempool=NULL;
-static cts_group *group_list_mempool=NULL;
-static cts_addrbook *addrbook_list_mempool=NULL;
-static sdn_list *sdn_list_mempool=NULL;
-static osp_list *osp_list_mempool=NULL;
+#include "cts-mempool.h"
 
 
 API CTSstruct* contacts_svc_struct_new(cts_struct_type type)
@@ -1022,85 +1013,31 @@ API CTSvalue* contacts_svc_value_new(cts_value_type type)
 		ret_val = (CTSvalue*)calloc(1, sizeof(cts_addrbook));
 		break;
 	case CTS_VALUE_LIST_CONTACT:
-		if (contact_list_mempool) {
-			memset(contact_list_mempool, 0x00, sizeof(contact_list));
-			ret_val = (CTSvalue*)contact_list_mempool;
-			contact_list_mempool = NULL;
-		}
-		else
-			ret_val = (CTSvalue*)calloc(1, sizeof(contact_list));
+		ret_val = (CTSvalue*)cts_mempool_get(CTS_MEMPOOL_LIST_CONTACT);
 		break;
 	case CTS_VALUE_LIST_PLOG:
-		if (plog_list_mempool) {
-			memset(plog_list_mempool, 0x00, sizeof(plog_list));
-			ret_val = (CTSvalue*)plog_list_mempool;
-			plog_list_mempool = NULL;
-		}
-		else
-			ret_val = (CTSvalue*)calloc(1, sizeof(plog_list));
+		ret_val = (CTSvalue*)cts_mempool_get(CTS_MEMPOOL_LIST_PLOG);
 		break;
 	case CTS_VALUE_LIST_CUSTOM_NUM_TYPE:
-		if (numtype_list_mempool) {
-			memset(numtype_list_mempool, 0x00, sizeof(numtype_list));
-			ret_val = (CTSvalue*)numtype_list_mempool;
-			numtype_list_mempool = NULL;
-		}
-		else
-			ret_val = (CTSvalue*)calloc(1, sizeof(numtype_list));
+		ret_val = (CTSvalue*)cts_mempool_get(CTS_MEMPOOL_LIST_CUSTOM_NUM_TYPE);
 		break;
 	case CTS_VALUE_LIST_CHANGE:
-		if (change_list_mempool) {
-			memset(change_list_mempool, 0x00, sizeof(change_list));
-			ret_val = (CTSvalue*)change_list_mempool;
-			change_list_mempool = NULL;
-		}
-		else
-			ret_val = (CTSvalue*)calloc(1, sizeof(change_list));
+		ret_val = (CTSvalue*)cts_mempool_get(CTS_MEMPOOL_LIST_CHANGE);
 		break;
 	case CTS_VALUE_LIST_ADDRBOOK:
-		if (addrbook_list_mempool) {
-			memset(addrbook_list_mempool, 0x00, sizeof(cts_addrbook));
-			ret_val = (CTSvalue*)addrbook_list_mempool;
-			addrbook_list_mempool = NULL;
-		}
-		else
-			ret_val = (CTSvalue*)calloc(1, sizeof(cts_addrbook));
+		ret_val = (CTSvalue*)cts_mempool_get(CTS_MEMPOOL_LIST_ADDRBOOK);
 		break;
 	case CTS_VALUE_LIST_GROUP:
-		if (group_list_mempool) {
-			memset(group_list_mempool, 0x00, sizeof(cts_group));
-			ret_val = (CTSvalue*)group_list_mempool;
-			group_list_mempool = NULL;
-		}
-		else
-			ret_val = (CTSvalue*)calloc(1, sizeof(cts_group));
+		ret_val = (CTSvalue*)cts_mempool_get(CTS_MEMPOOL_LIST_GROUP);
 		break;
 	case CTS_VALUE_LIST_SHORTCUT:
-		if (favorite_list_mempool) {
-			memset(favorite_list_mempool, 0x00, sizeof(shortcut_list));
-			ret_val = (CTSvalue*)favorite_list_mempool;
-			favorite_list_mempool = NULL;
-		}
-		else
-			ret_val = (CTSvalue*)calloc(1, sizeof(shortcut_list));
+		ret_val = (CTSvalue*)cts_mempool_get(CTS_MEMPOOL_LIST_SHORTCUT);
 		break;
 	case CTS_VALUE_LIST_SDN:
-		if (sdn_list_mempool) {
-			memset(sdn_list_mempool, 0x00, sizeof(sdn_list));
-			ret_val = (CTSvalue*)sdn_list_mempool;
-			sdn_list_mempool = NULL;
-		}
-		else
-			ret_val = (CTSvalue*)calloc(1, sizeof(sdn_list));
+		ret_val = (CTSvalue*)cts_mempool_get(CTS_MEMPOOL_LIST_SDN);
 		break;
 	case CTS_VALUE_LIST_OSP:
-		if (osp_list_mempool) {
-			memset(osp_list_mempool, 0x00, sizeof(osp_list));
-			ret_val = (CTSvalue*)osp_list_mempool;
-			osp_list_mempool = NULL;
-		}
-		else
-			ret_val = (CTSvalue*)calloc(1, sizeof(osp_list));
+		ret_val = (CTSvalue*)cts_mempool_get(CTS_MEMPOOL_LIST_OSP);
 		break;
 	default:
 		ERR("your type is Not supported");
@@ -1140,12 +1077,7 @@ static inline void cts_internal_value_info_free(CTSvalue *value)
 		free(contact->connect);
 		free(contact->normalize);
 
-		if (!contact_list_mempool) {
-			contact_list_mempool = contact;
-		}
-		else
-			if (contact_list_mempool != contact)
-				free(contact);
+		cts_mempool_put(CTS_MEMPOOL_LIST_CONTACT, contact);
 		break;
 	case CTS_VALUE_LIST_OSP:
 		osp = (osp_list *)value;
@@ -1157,12 +1089,7 @@ static inline void cts_internal_value_info_free(CTSvalue *value)
 		free(osp->def_email);
 		free(osp->normalize);
 
-		if (!osp_list_mempool) {
-			osp_list_mempool = osp;
-		}
-		else
-			if (osp_list_mempool != osp)
-				free(osp);
+		cts_mempool_put(CTS_MEMPOOL_LIST_OSP, osp);
 		break;
 	case CTS_VALUE_LIST_PLOG:
 		plog = (plog_list *)value;
@@ -1171,31 +1098,16 @@ static inline void cts_internal_value_info_free(CTSvalue *value)
 		free(plog->display);
 		free(plog->img_path);
 
-		if (!plog_list_mempool) {
-			plog_list_mempool = plog;
-		}
-		else
-			if (plog_list_mempool != plog)
-				free(plog);
+		cts_mempool_put(CTS_MEMPOOL_LIST_PLOG, plog);
 		break;
 	case CTS_VALUE_LIST_CUSTOM_NUM_TYPE:
 		numtype = (numtype_list *)value;
 		free(numtype->name);
-		if (!numtype_list_mempool) {
-			numtype_list_mempool = numtype;
-		}
-		else
-			if (numtype_list_mempool != numtype)
-				free(numtype);
+		cts_mempool_put(CTS_MEMPOOL_LIST_CUSTOM_NUM_TYPE, numtype);
 		break;
 	case CTS_VALUE_LIST_CHANGE:
 		change = (change_list *)value;
-		if (!change_list_mempool) {
-			change_list_mempool = change;
-		}
-		else
-			if (change_list_mempool != change)
-				free(change);
+		cts_mempool_put(CTS_MEMPOOL_LIST_CHANGE, change);
 		break;
 	case CTS_VALUE_LIST_GROUP:
 		group = (cts_group *)value;
@@ -1204,23 +1116,13 @@ static inline void cts_internal_value_info_free(CTSvalue *value)
 		free(group->img_path);
 		free(group->vcard_group);
 
-		if (!group_list_mempool) {
-			group_list_mempool = group;
-		}
-		else
-			if (group_list_mempool != group)
-				free(group);
+		cts_mempool_put(CTS_MEMPOOL_LIST_GROUP, group);
 		break;
 	case CTS_VALUE_LIST_ADDRBOOK:
 		ab = (cts_addrbook *)value;
 		free(ab->name);
 
-		if (!addrbook_list_mempool) {
-			addrbook_list_mempool = ab;
-		}
-		else
-			if (addrbook_list_mempool != ab)
-				free(ab);
+		cts_mempool_put(CTS_MEMPOOL_LIST_ADDRBOOK, ab);
 		break;
 	case CTS_VALUE_LIST_SHORTCUT:
 		favorite = (shortcut_list *)value;
@@ -1230,24 +1132,14 @@ static inline void cts_internal_value_info_free(CTSvalue *value)
 		free(favorite->number);
 		free(favorite->img_path);
 
-		if (!favorite_list_mempool) {
-			favorite_list_mempool = favorite;
-		}
-		else
-			if (favorite_list_mempool != favorite)
-				free(favorite);
+		cts_mempool_put(CTS_MEMPOOL_LIST_SHORTCUT, favorite);
 		break;
 	case CTS_VALUE_LIST_SDN:
 		sdn = (sdn_list *)value;
 		free(sdn->name);
 		free(sdn->number);
 
-		if (!sdn_list_mempool) {
-			sdn_list_mempool = sdn;
-		}
-		else
-			if (sdn_list_mempool != sdn)
-				free(sdn);
+		cts_mempool_put(CTS_MEMPOOL_LIST_SDN, sdn);
 		break;
 	case CTS_VALUE_RDONLY_NAME:
 		cts_name_free((cts_name *)value);
@@ -96,6 +96,7 @@ typedef struct {
 	bool ringtone_changed;
 	bool note_changed;
 	bool is_favorite;
+	bool vcard_img_movable; /* vcard_img_path is moved instead of copied when inserting */
 	int id;
 	int person_id;
 	int changed_time;
@@ -18,13 +18,18 @@
  * limitations under the License.
  *
  */
+#define _GNU_SOURCE
 #include <sys/time.h>
 #include <sys/stat.h>
+#include <sys/file.h>
+#include <sys/syscall.h>
 #include <vconf.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <ctype.h>
 #include <dirent.h>
+#include <pthread.h>
 
 #include "cts-internal.h"
 #include "cts-schema.h"
@@ -36,6 +41,7 @@
 #include "cts-pthread.h"
 #include "cts-types.h"
 #include "cts-restriction.h"
+#include "cts-addressbook.h"
 #include "cts-utils.h"
 
 static const char *CTS_NOTI_CONTACT_CHANGED=CTS_NOTI_CONTACT_CHANGED_DEF;
@@ -47,6 +53,7 @@ static const char *CTS_NOTI_GROUP_CHANGED="/opt/data/contacts-svc/.CONTACTS_SVC_
 static const char *CTS_NOTI_GROUP_RELATION_CHANGED="/opt/data/contacts-svc/.CONTACTS_SVC_GROUP_REL_CHANGED";
 static const char *CTS_NOTI_MISSED_CALL_CHANGED="/opt/data/contacts-svc/.CONTACTS_SVC_MISSED_CHANGED";
 static const char *CTS_NOTI_LINK_CHANGED="/opt/data/contacts-svc/.CONTACTS_SVC_LINK_CHANGED";
+static const char *CTS_NOTI_CHANGE_LOG="/opt/data/contacts-svc/.CONTACTS_SVC_CHANGE_LOG";
 
 static const char *CTS_VCONF_SORTING_ORDER=VCONFKEY_CONTACTS_SVC_NAME_SORTING_ORDER;
 static const char *CTS_VCONF_DISPLAY_ORDER=VCONFKEY_CONTACTS_SVC_NAME_DISPLAY_ORDER;
@@ -65,6 +72,63 @@ static bool group_change=false;
 static bool group_rel_change=false;
 static bool link_change=false;
 
+enum {
+	CTS_NOTI_CONTACT = 1<<0,
+	CTS_NOTI_PLOG = 1<<1,
+	CTS_NOTI_MISSED_CALL = 1<<2,
+	CTS_NOTI_FAVORITE = 1<<3,
+	CTS_NOTI_SPEEDDIAL = 1<<4,
+	CTS_NOTI_ADDRBOOK = 1<<5,
+	CTS_NOTI_GROUP = 1<<6,
+	CTS_NOTI_GROUP_RELATION = 1<<7,
+	CTS_NOTI_LINK = 1<<8,
+};
+
+/* The notifications which are committed in contacts_svc_begin_noti_batch() */
+static int noti_batch_count = 0;
+static unsigned int held_changes = 0;
+/* The notifications which are failed to be published */
+static unsigned int pending_changes = 0;
+static cts_change_record *held_records;
+static int held_records_cnt;
+static int held_records_size;
+static bool held_records_lost=false;
+
+#define CTS_CHANGE_LOG_MAGIC 0x43544c47
+#define CTS_CHANGE_LOG_SIZE_MAX (4096 * sizeof(cts_change_record))
+#define CTS_CHANGE_LOG_BATCH 64
+
+/* The change log file is a header and cts_change_record array.
+ * When it is full, it is truncated and the generation is increased. */
+typedef struct {
+	int magic;
+	int generation;
+	int reserved[2];
+}cts_change_log_header;
+
+typedef struct {
+	cts_change_record_fn cb;
+	void *user_data;
+	int generation;
+	off_t offset;
+}cts_change_log_sub;
+
+static cts_change_record *change_records;
+static int change_records_cnt;
+static int change_records_size;
+static bool change_records_lost=false;
+static GSList *change_log_subs;
+
+typedef struct {
+	int type;
+	void (*cb)(void *);
+	void *user_data;
+	int interval;
+	guint timer;
+}cts_debounce_sub;
+
+static GSList *debounce_subs;
+
 static int name_sorting_order = -1;
 static int name_display_order = -1;
 static int default_lang = -1;
@@ -126,86 +190,311 @@ void cts_set_link_noti(void)
 {
 	link_change = true;
 }
+void cts_add_change_noti(int table, int id, int op)
+{
+	cts_change_record *tmp;
+
+	if (change_records_size <= change_records_cnt) {
+		int size = change_records_size?change_records_size*2:CTS_CHANGE_LOG_BATCH;
+		tmp = realloc(change_records, size * sizeof(cts_change_record));
+		if (NULL == tmp) {
+			ERR("realloc() Failed");
+			change_records_lost = true;
+			return;
+		}
+		change_records = tmp;
+		change_records_size = size;
+	}
 
-static inline void cts_noti_publish_contact_change(void)
+	change_records[change_records_cnt].table = table;
+	change_records[change_records_cnt].id = id;
+	change_records[change_records_cnt].op = op;
+	change_records_cnt++;
+}
+
+static inline int cts_noti_publish_contact_change(void)
 {
 	int fd = open(CTS_NOTI_CONTACT_CHANGED, O_TRUNC | O_RDWR);
-	if (0 <= fd) {
-		close(fd);
-		contact_change = false;
-	}
+	retvm_if(fd < 0, CTS_ERR_IO_ERR, "open(%s) Failed(%d)", CTS_NOTI_CONTACT_CHANGED, errno);
+	close(fd);
+	return CTS_SUCCESS;
 }
 
-static inline void cts_noti_publish_plog_change(void)
+static inline int cts_noti_publish_plog_change(void)
 {
 	int fd = open(CTS_NOTI_PLOG_CHANGED, O_TRUNC | O_RDWR);
-	if (0 <= fd) {
-		close(fd);
-		plog_change = false;
-	}
+	retvm_if(fd < 0, CTS_ERR_IO_ERR, "open(%s) Failed(%d)", CTS_NOTI_PLOG_CHANGED, errno);
+	close(fd);
+	return CTS_SUCCESS;
 }
 
-static inline void cts_noti_publish_missed_call_change(void)
+static inline int cts_noti_publish_missed_call_change(void)
 {
 	int fd = open(CTS_NOTI_MISSED_CALL_CHANGED, O_TRUNC | O_RDWR);
-	if (0 <= fd) {
-		close(fd);
-		missed_change = false;
-	}
+	retvm_if(fd < 0, CTS_ERR_IO_ERR, "open(%s) Failed(%d)", CTS_NOTI_MISSED_CALL_CHANGED, errno);
+	close(fd);
+	return CTS_SUCCESS;
 }
 
-static inline void cts_noti_publish_favor_change(void)
+static inline int cts_noti_publish_favor_change(void)
 {
 	int fd = open(CTS_NOTI_FAVORITE_CHANGED, O_TRUNC | O_RDWR);
-	if (0 <= fd) {
-		close(fd);
-		favor_change = false;
-	}
+	retvm_if(fd < 0, CTS_ERR_IO_ERR, "open(%s) Failed(%d)", CTS_NOTI_FAVORITE_CHANGED, errno);
+	close(fd);
+	return CTS_SUCCESS;
 }
 
-static inline void cts_noti_publish_speed_change(void)
+static inline int cts_noti_publish_speed_change(void)
 {
 	int fd = open(CTS_NOTI_SPEEDDIAL_CHANGED, O_TRUNC | O_RDWR);
-	if (0 <= fd) {
-		close(fd);
-		speed_change = false;
-	}
+	retvm_if(fd < 0, CTS_ERR_IO_ERR, "open(%s) Failed(%d)", CTS_NOTI_SPEEDDIAL_CHANGED, errno);
+	close(fd);
+	return CTS_SUCCESS;
 }
 
-static inline void cts_noti_publish_addrbook_change(void)
+static inline int cts_noti_publish_addrbook_change(void)
 {
 	int fd = open(CTS_NOTI_ADDRBOOK_CHANGED, O_TRUNC | O_RDWR);
-	if (0 <= fd) {
-		close(fd);
-		addrbook_change = false;
-	}
+	retvm_if(fd < 0, CTS_ERR_IO_ERR, "open(%s) Failed(%d)", CTS_NOTI_ADDRBOOK_CHANGED, errno);
+	close(fd);
+	return CTS_SUCCESS;
 }
 
-static inline void cts_noti_publish_group_change(void)
+/* Every publish of the addressbook notification changes its modification time */
+int cts_get_addrbook_noti_time(struct timespec *dest)
+{
+	int ret;
+	struct stat buf;
+
+	ret = stat(CTS_NOTI_ADDRBOOK_CHANGED, &buf);
+	retvm_if(ret < 0, CTS_ERR_IO_ERR, "stat(%s) Failed(%d)", CTS_NOTI_ADDRBOOK_CHANGED, errno);
+
+	*dest = buf.st_mtim;
+	return CTS_SUCCESS;
+}
+
+static inline int cts_noti_publish_group_change(void)
 {
 	int fd = open(CTS_NOTI_GROUP_CHANGED, O_TRUNC | O_RDWR);
-	if (0 <= fd) {
-		close(fd);
-		group_change = false;
-	}
+	retvm_if(fd < 0, CTS_ERR_IO_ERR, "open(%s) Failed(%d)", CTS_NOTI_GROUP_CHANGED, errno);
+	close(fd);
+	return CTS_SUCCESS;
 }
 
-static inline void cts_noti_publish_group_rel_change(void)
+static inline int cts_noti_publish_group_rel_change(void)
 {
 	int fd = open(CTS_NOTI_GROUP_RELATION_CHANGED, O_TRUNC | O_RDWR);
-	if (0 <= fd) {
-		close(fd);
-		group_rel_change = false;
-	}
+	retvm_if(fd < 0, CTS_ERR_IO_ERR, "open(%s) Failed(%d)", CTS_NOTI_GROUP_RELATION_CHANGED, errno);
+	close(fd);
+	return CTS_SUCCESS;
 }
 
-static inline void cts_noti_publish_link_change(void)
+static inline int cts_noti_publish_link_change(void)
 {
 	int fd = open(CTS_NOTI_LINK_CHANGED, O_TRUNC | O_RDWR);
-	if (0 <= fd) {
-		close(fd);
-		link_change = false;
+	retvm_if(fd < 0, CTS_ERR_IO_ERR, "open(%s) Failed(%d)", CTS_NOTI_LINK_CHANGED, errno);
+	close(fd);
+	return CTS_SUCCESS;
+}
+
+static inline void cts_noti_publish_change_records(cts_change_record *records,
+		int cnt, bool rotate)
+{
+	int fd, ret;
+	struct stat buf;
+	cts_change_log_header header = {0};
+
+	fd = open(CTS_NOTI_CHANGE_LOG, O_RDWR);
+	retm_if(fd < 0, "open(%s) Failed(%d)", CTS_NOTI_CHANGE_LOG, errno);
+	flock(fd, LOCK_EX);
+
+	ret = fstat(fd, &buf);
+	if (0 == ret && sizeof(header) <= buf.st_size)
+		ret = pread(fd, &header, sizeof(header), 0);
+	if (sizeof(header) != ret || CTS_CHANGE_LOG_MAGIC != header.magic) {
+		header.generation = 0;
+		rotate = true;
+	}
+	else if (CTS_CHANGE_LOG_SIZE_MAX < buf.st_size + cnt * sizeof(cts_change_record))
+		rotate = true;
+
+	if (rotate) {
+		ret = ftruncate(fd, 0);
+		warn_if(0 != ret, "ftruncate() Failed(%d)", errno);
+		header.magic = CTS_CHANGE_LOG_MAGIC;
+		header.generation++;
+		if (header.generation <= 0)
+			header.generation = 1;
+		ret = pwrite(fd, &header, sizeof(header), 0);
+		warn_if(sizeof(header) != ret, "pwrite() Failed(%d)", errno);
+	}
+
+	if (0 < cnt) {
+		lseek(fd, 0, SEEK_END);
+		ret = write(fd, records, cnt * sizeof(cts_change_record));
+		warn_if(cnt * sizeof(cts_change_record) != ret, "write() Failed(%d)", errno);
+	}
+
+	flock(fd, LOCK_UN);
+	close(fd);
+}
+
+static inline unsigned int cts_noti_take_changes(void)
+{
+	unsigned int changes = pending_changes;
+
+	pending_changes = 0;
+	if (contact_change) changes |= CTS_NOTI_CONTACT;
+	if (plog_change) changes |= CTS_NOTI_PLOG;
+	if (missed_change) changes |= CTS_NOTI_MISSED_CALL;
+	if (favor_change) changes |= CTS_NOTI_FAVORITE;
+	if (speed_change) changes |= CTS_NOTI_SPEEDDIAL;
+	if (addrbook_change) changes |= CTS_NOTI_ADDRBOOK;
+	if (group_change) changes |= CTS_NOTI_GROUP;
+	if (group_rel_change) changes |= CTS_NOTI_GROUP_RELATION;
+	if (link_change) changes |= CTS_NOTI_LINK;
+
+	contact_change = false;
+	plog_change = false;
+	missed_change = false;
+	favor_change = false;
+	speed_change = false;
+	addrbook_change = false;
+	group_change = false;
+	group_rel_change = false;
+	link_change = false;
+
+	return changes;
+}
+
+/* It returns the changes which are failed to be published */
+static inline unsigned int cts_noti_publish_changes(unsigned int changes)
+{
+	unsigned int failed = 0;
+
+	if ((changes & CTS_NOTI_CONTACT) && cts_noti_publish_contact_change())
+		failed |= CTS_NOTI_CONTACT;
+	if ((changes & CTS_NOTI_PLOG) && cts_noti_publish_plog_change())
+		failed |= CTS_NOTI_PLOG;
+	if ((changes & CTS_NOTI_MISSED_CALL) && cts_noti_publish_missed_call_change())
+		failed |= CTS_NOTI_MISSED_CALL;
+	if ((changes & CTS_NOTI_FAVORITE) && cts_noti_publish_favor_change())
+		failed |= CTS_NOTI_FAVORITE;
+	if ((changes & CTS_NOTI_SPEEDDIAL) && cts_noti_publish_speed_change())
+		failed |= CTS_NOTI_SPEEDDIAL;
+	if ((changes & CTS_NOTI_ADDRBOOK) && cts_noti_publish_addrbook_change())
+		failed |= CTS_NOTI_ADDRBOOK;
+	if ((changes & CTS_NOTI_GROUP) && cts_noti_publish_group_change())
+		failed |= CTS_NOTI_GROUP;
+	if ((changes & CTS_NOTI_GROUP_RELATION) && cts_noti_publish_group_rel_change())
+		failed |= CTS_NOTI_GROUP_RELATION;
+	if ((changes & CTS_NOTI_LINK) && cts_noti_publish_link_change())
+		failed |= CTS_NOTI_LINK;
+
+	return failed;
+}
+
+/* The failed notifications are published again with the next committed changes */
+static inline void cts_noti_publish_pending(unsigned int changes)
+{
+	unsigned int failed;
+
+	failed = cts_noti_publish_changes(changes);
+	if (failed) {
+		cts_mutex_lock(CTS_MUTEX_TRANSACTION);
+		pending_changes |= failed;
+		cts_mutex_unlock(CTS_MUTEX_TRANSACTION);
+	}
+}
+
+static inline void cts_noti_hold_records(cts_change_record *records,
+		int cnt, bool lost)
+{
+	cts_change_record *tmp;
+
+	held_records_lost |= lost;
+	if (0 == cnt) {
+		free(records);
+		return;
+	}
+
+	if (NULL == held_records) {
+		held_records = records;
+		held_records_cnt = held_records_size = cnt;
+		return;
+	}
+
+	if (held_records_size < held_records_cnt + cnt) {
+		int size = held_records_size * 2;
+		if (size < held_records_cnt + cnt)
+			size = held_records_cnt + cnt;
+		tmp = realloc(held_records, size * sizeof(cts_change_record));
+		if (NULL == tmp) {
+			ERR("realloc() Failed");
+			held_records_lost = true;
+			free(records);
+			return;
+		}
+		held_records = tmp;
+		held_records_size = size;
+	}
+	memcpy(held_records + held_records_cnt, records, cnt * sizeof(cts_change_record));
+	held_records_cnt += cnt;
+	free(records);
+}
+
+API int contacts_svc_begin_noti_batch(void)
+{
+	cts_mutex_lock(CTS_MUTEX_TRANSACTION);
+	noti_batch_count++;
+	cts_mutex_unlock(CTS_MUTEX_TRANSACTION);
+
+	return CTS_SUCCESS;
+}
+
+static void cts_noti_release_held(void)
+{
+	int records_cnt;
+	bool records_lost;
+	unsigned int changes;
+	cts_change_record *records;
+
+	cts_mutex_lock(CTS_MUTEX_TRANSACTION);
+	changes = held_changes;
+	records = held_records;
+	records_cnt = held_records_cnt;
+	records_lost = held_records_lost;
+	held_changes = 0;
+	held_records = NULL;
+	held_records_cnt = held_records_size = 0;
+	held_records_lost = false;
+	cts_mutex_unlock(CTS_MUTEX_TRANSACTION);
+
+	cts_noti_publish_pending(changes);
+	if (records_cnt || records_lost)
+		cts_noti_publish_change_records(records, records_cnt, records_lost);
+	free(records);
+}
+
+API int contacts_svc_end_noti_batch(void)
+{
+	cts_mutex_lock(CTS_MUTEX_TRANSACTION);
+	if (noti_batch_count <= 0) {
+		ERR("contacts_svc_begin_noti_batch() is not called");
+		cts_mutex_unlock(CTS_MUTEX_TRANSACTION);
+		return CTS_ERR_ENV_INVALID;
+	}
+
+	noti_batch_count--;
+	if (0 < noti_batch_count) {
+		cts_mutex_unlock(CTS_MUTEX_TRANSACTION);
+		return CTS_SUCCESS;
 	}
+	cts_mutex_unlock(CTS_MUTEX_TRANSACTION);
+
+	cts_noti_release_held();
+
+	return CTS_SUCCESS;
 }
 
 #define CTS_COMMIT_TRY_MAX 500000 // For 3second
@@ -253,11 +542,16 @@ static inline void cts_cancel_changes(void)
 	group_change = false;
 	group_rel_change = false;
 	link_change = false;
+	change_records_cnt = 0;
+	change_records_lost = false;
 }
 
 API int contacts_svc_end_trans(bool is_success)
 {
-	int ret = -1, progress;
+	int i, ret = -1, progress, records_cnt;
+	bool records_lost;
+	unsigned int changes;
+	cts_change_record *records;
 	char query[CTS_SQL_MIN_LEN];
 
 	cts_mutex_lock(CTS_MUTEX_TRANSACTION);
@@ -302,21 +596,80 @@ API int contacts_svc_end_trans(bool is_success)
 		cts_mutex_unlock(CTS_MUTEX_TRANSACTION);
 		return ret;
 	}
+	records = change_records;
+	records_cnt = change_records_cnt;
+	records_lost = change_records_lost;
+	change_records = NULL;
+	change_records_cnt = change_records_size = 0;
+	change_records_lost = false;
+	for (i=0;i<records_cnt;i++)
+		records[i].version = transaction_ver;
+
+	changes = cts_noti_take_changes();
+	if (0 < noti_batch_count) {
+		held_changes |= changes;
+		cts_noti_hold_records(records, records_cnt, records_lost);
+		cts_mutex_unlock(CTS_MUTEX_TRANSACTION);
+		return transaction_ver;
+	}
 	cts_mutex_unlock(CTS_MUTEX_TRANSACTION);
 
-	if (contact_change) cts_noti_publish_contact_change();
-	if (plog_change) cts_noti_publish_plog_change();
-	if (missed_change) cts_noti_publish_missed_call_change();
-	if (favor_change) cts_noti_publish_favor_change();
-	if (speed_change) cts_noti_publish_speed_change();
-	if (addrbook_change) cts_noti_publish_addrbook_change();
-	if (group_change) cts_noti_publish_group_change();
-	if (group_rel_change) cts_noti_publish_group_rel_change();
-	if (link_change) cts_noti_publish_link_change();
+	cts_noti_publish_pending(changes);
+	if (records_cnt || records_lost)
+		cts_noti_publish_change_records(records, records_cnt, records_lost);
+	free(records);
 
 	return transaction_ver;
 }
 
+/* The nested contacts_svc_end_trans(false) cannot roll back the part of the transaction.
+ * A savepoint lets a batch roll back a failing part alone. It cannot be nested. */
+static int savepoint_records_cnt;
+
+int cts_savepoint_begin(void)
+{
+	int ret;
+
+	cts_mutex_lock(CTS_MUTEX_TRANSACTION);
+	if (transaction_count <= 0) {
+		ERR("There is no transaction");
+		cts_mutex_unlock(CTS_MUTEX_TRANSACTION);
+		return CTS_ERR_ENV_INVALID;
+	}
+
+	ret = cts_query_exec("SAVEPOINT cts_savepoint");
+	if (CTS_SUCCESS == ret)
+		savepoint_records_cnt = change_records_cnt;
+	else
+		ERR("cts_query_exec(SAVEPOINT) Failed(%d)", ret);
+	cts_mutex_unlock(CTS_MUTEX_TRANSACTION);
+
+	return ret;
+}
+
+int cts_savepoint_end(bool is_success)
+{
+	int ret;
+
+	cts_mutex_lock(CTS_MUTEX_TRANSACTION);
+	if (!is_success) {
+		ret = cts_query_exec("ROLLBACK TO cts_savepoint");
+		if (CTS_SUCCESS != ret) {
+			ERR("cts_query_exec(ROLLBACK TO) Failed(%d)", ret);
+			cts_mutex_unlock(CTS_MUTEX_TRANSACTION);
+			return ret;
+		}
+		if (savepoint_records_cnt < change_records_cnt)
+			change_records_cnt = savepoint_records_cnt;
+	}
+
+	ret = cts_query_exec("RELEASE cts_savepoint");
+	warn_if(CTS_SUCCESS != ret, "cts_query_exec(RELEASE) Failed(%d)", ret);
+	cts_mutex_unlock(CTS_MUTEX_TRANSACTION);
+
+	return ret;
+}
+
 int cts_get_next_ver(void)
 {
 	const char *query;
@@ -333,9 +686,28 @@ int cts_get_next_ver(void)
 void cts_deregister_noti(void)
 {
 	int ret;
+	GSList *it;
+
+	if (noti_batch_count) {
+		noti_batch_count = 0;
+		cts_noti_release_held();
+	}
 
 	cts_inotify_close();
 
+	g_slist_foreach(change_log_subs, (GFunc)free, NULL);
+	g_slist_free(change_log_subs);
+	change_log_subs = NULL;
+
+	for (it=debounce_subs;it;it=it->next) {
+		cts_debounce_sub *sub = it->data;
+		if (sub->timer)
+			g_source_remove(sub->timer);
+		free(sub);
+	}
+	g_slist_free(debounce_subs);
+	debounce_subs = NULL;
+
 	ret = vconf_ignore_key_changed(CTS_VCONF_SORTING_ORDER, cts_vconf_callback);
 	retm_if(ret<0,"vconf_ignore_key_changed(%s) Failed(%d)",CTS_VCONF_SORTING_ORDER,ret);
 	ret = vconf_ignore_key_changed(CTS_VCONF_DISPLAY_ORDER, cts_vconf_callback);
@@ -490,18 +862,96 @@ API int contacts_svc_subscribe_change(cts_subscribe_type noti_type,
 	return CTS_SUCCESS;
 }
 
+static gboolean cts_debounce_timeout_cb(gpointer data)
+{
+	cts_debounce_sub *sub = data;
+
+	sub->timer = 0;
+	sub->cb(sub->user_data);
+
+	return FALSE;
+}
+
+static void cts_debounce_noti_cb(void *data)
+{
+	cts_debounce_sub *sub = data;
+
+	if (0 == sub->timer)
+		sub->timer = g_timeout_add(sub->interval, cts_debounce_timeout_cb, sub);
+}
+
+API int contacts_svc_subscribe_change_debounced(cts_subscribe_type noti_type,
+		void (*cb)(void *), void *user_data, int interval)
+{
+	int ret;
+	const char *noti;
+	cts_debounce_sub *sub;
+
+	retv_if(NULL == cb, CTS_ERR_ARG_NULL);
+	retvm_if(interval < 0, CTS_ERR_ARG_INVALID, "interval(%d) is invalid", interval);
+
+	noti = cts_noti_get_file_path(noti_type);
+	retvm_if(NULL == noti, CTS_ERR_ARG_INVALID,
+			"cts_noti_get_file_path(%d) Failed", noti_type);
+
+	sub = calloc(1, sizeof(cts_debounce_sub));
+	retvm_if(NULL == sub, CTS_ERR_OUT_OF_MEMORY, "calloc() Failed");
+	sub->type = noti_type;
+	sub->cb = cb;
+	sub->user_data = user_data;
+	sub->interval = interval;
+
+	ret = cts_inotify_subscribe(noti, cts_debounce_noti_cb, sub);
+	if (CTS_SUCCESS != ret) {
+		ERR("cts_inotify_subscribe(%d) Failed(%d)", noti_type, ret);
+		free(sub);
+		return ret;
+	}
+	debounce_subs = g_slist_append(debounce_subs, sub);
+
+	return CTS_SUCCESS;
+}
+
+static inline int cts_noti_del_debounced(int type, void (*cb)(void *),
+		bool with_data, void *user_data)
+{
+	int cnt = 0;
+	GSList *it;
+	cts_debounce_sub *sub;
+	const char *noti = cts_noti_get_file_path(type);
+
+	it = debounce_subs;
+	while (it) {
+		sub = it->data;
+		it = it->next;
+		if (type != sub->type || (cb && cb != sub->cb)
+				|| (with_data && user_data != sub->user_data))
+			continue;
+
+		cts_inotify_unsubscribe_with_data(noti, cts_debounce_noti_cb, sub);
+		if (sub->timer)
+			g_source_remove(sub->timer);
+		debounce_subs = g_slist_remove(debounce_subs, sub);
+		free(sub);
+		cnt++;
+	}
+
+	return cnt;
+}
+
 API int contacts_svc_unsubscribe_change(cts_subscribe_type noti_type,
 		void (*cb)(void *))
 {
-	int ret;
+	int ret, cnt;
 	const char *noti;
 
 	noti = cts_noti_get_file_path(noti_type);
 	retvm_if(NULL == noti, CTS_ERR_ARG_INVALID,
 			"cts_noti_get_file_path(%d) Failed", noti_type);
 
+	cnt = cts_noti_del_debounced(noti_type, cb, false, NULL);
 	ret = cts_inotify_unsubscribe(noti, cb);
-	retvm_if(CTS_SUCCESS != ret, ret,
+	retvm_if(CTS_SUCCESS != ret && 0 == cnt, ret,
 			"cts_inotify_unsubscribe(%d) Failed(%d)", noti_type, ret);
 
 	return CTS_SUCCESS;
@@ -510,20 +960,152 @@ API int contacts_svc_unsubscribe_change(cts_subscribe_type noti_type,
 API int contacts_svc_unsubscribe_change_with_data(cts_subscribe_type noti_type,
 		void (*cb)(void *), void *user_data)
 {
-	int ret;
+	int ret, cnt;
 	const char *noti;
 
 	noti = cts_noti_get_file_path(noti_type);
 	retvm_if(NULL == noti, CTS_ERR_ARG_INVALID,
 			"cts_noti_get_file_path(%d) Failed", noti_type);
 
+	cnt = cts_noti_del_debounced(noti_type, cb, true, user_data);
 	ret = cts_inotify_unsubscribe_with_data(noti, cb, user_data);
-	retvm_if(CTS_SUCCESS != ret, ret,
+	retvm_if(CTS_SUCCESS != ret && 0 == cnt, ret,
 			"cts_inotify_unsubscribe_with_data(%d) Failed(%d)", noti_type, ret);
 
 	return CTS_SUCCESS;
 }
 
+static void cts_change_log_cb(void *data)
+{
+	int fd, i, ret, cnt;
+	bool lost = false;
+	struct stat buf;
+	cts_change_log_header header;
+	cts_change_record *records = NULL;
+	cts_change_log_sub *sub = data;
+	cts_change_record_fn cb = sub->cb;
+	void *user_data = sub->user_data;
+
+	fd = open(CTS_NOTI_CHANGE_LOG, O_RDONLY);
+	retm_if(fd < 0, "open(%s) Failed(%d)", CTS_NOTI_CHANGE_LOG, errno);
+	flock(fd, LOCK_SH);
+
+	ret = pread(fd, &header, sizeof(header), 0);
+	if (sizeof(header) != ret || CTS_CHANGE_LOG_MAGIC != header.magic
+			|| 0 != fstat(fd, &buf)) {
+		flock(fd, LOCK_UN);
+		close(fd);
+		return;
+	}
+
+	if (header.generation != sub->generation || buf.st_size < sub->offset) {
+		/* The log is created after subscription, if it is the first generation. */
+		if (sub->generation || 1 != header.generation)
+			lost = true;
+		sub->generation = header.generation;
+		sub->offset = sizeof(header);
+	}
+
+	cnt = (buf.st_size - sub->offset) / (int)sizeof(cts_change_record);
+	if (0 < cnt) {
+		records = malloc(cnt * sizeof(cts_change_record));
+		if (records) {
+			ret = pread(fd, records, cnt * sizeof(cts_change_record), sub->offset);
+			cnt = (0 < ret)?ret/sizeof(cts_change_record):0;
+		}
+		else {
+			ERR("malloc() Failed");
+			lost = true;
+		}
+		sub->offset += cnt * sizeof(cts_change_record);
+	}
+	flock(fd, LOCK_UN);
+	close(fd);
+
+	if (lost)
+		cb(NULL, 0, user_data);
+
+	if (records) {
+		for (i=0;i<cnt;i+=CTS_CHANGE_LOG_BATCH)
+			cb(records+i, (cnt-i < CTS_CHANGE_LOG_BATCH)?cnt-i:CTS_CHANGE_LOG_BATCH, user_data);
+		free(records);
+	}
+}
+
+API int contacts_svc_subscribe_change_records(cts_change_record_fn cb,
+		void *user_data)
+{
+	int fd, ret;
+	GSList *it;
+	struct stat buf;
+	cts_change_log_sub *sub;
+	cts_change_log_header header;
+
+	retv_if(NULL == cb, CTS_ERR_ARG_NULL);
+
+	for (it=change_log_subs;it;it=it->next) {
+		sub = it->data;
+		retvm_if(sub->cb == cb && sub->user_data == user_data, CTS_ERR_ALREADY_EXIST,
+				"The same callback is already exist");
+	}
+
+	sub = calloc(1, sizeof(cts_change_log_sub));
+	retvm_if(NULL == sub, CTS_ERR_OUT_OF_MEMORY, "calloc() Failed");
+	sub->cb = cb;
+	sub->user_data = user_data;
+
+	fd = open(CTS_NOTI_CHANGE_LOG, O_RDONLY);
+	if (fd < 0) {
+		ERR("open(%s) Failed(%d)", CTS_NOTI_CHANGE_LOG, errno);
+		free(sub);
+		return CTS_ERR_IO_ERR;
+	}
+	flock(fd, LOCK_SH);
+	ret = pread(fd, &header, sizeof(header), 0);
+	if (sizeof(header) == ret && CTS_CHANGE_LOG_MAGIC == header.magic
+			&& 0 == fstat(fd, &buf)) {
+		sub->generation = header.generation;
+		sub->offset = buf.st_size;
+	}
+	flock(fd, LOCK_UN);
+	close(fd);
+
+	ret = cts_inotify_subscribe(CTS_NOTI_CHANGE_LOG, cts_change_log_cb, sub);
+	if (CTS_SUCCESS != ret) {
+		ERR("cts_inotify_subscribe() Failed(%d)", ret);
+		free(sub);
+		return ret;
+	}
+	change_log_subs = g_slist_append(change_log_subs, sub);
+
+	return CTS_SUCCESS;
+}
+
+API int contacts_svc_unsubscribe_change_records(cts_change_record_fn cb,
+		void *user_data)
+{
+	int ret;
+	GSList *it;
+	cts_change_log_sub *sub;
+
+	retv_if(NULL == cb, CTS_ERR_ARG_NULL);
+
+	for (it=change_log_subs;it;it=it->next) {
+		sub = it->data;
+		if (sub->cb == cb && sub->user_data == user_data)
+			break;
+	}
+	retvm_if(NULL == it, CTS_ERR_NO_DATA, "The callback is not subscribed");
+
+	ret = cts_inotify_unsubscribe_with_data(CTS_NOTI_CHANGE_LOG, cts_change_log_cb, sub);
+	warn_if(ret < CTS_SUCCESS, "cts_inotify_unsubscribe_with_data() Failed(%d)", ret);
+
+	change_log_subs = g_slist_remove(change_log_subs, sub);
+	free(sub);
+
+	return CTS_SUCCESS;
+}
+
 int cts_exist_file(char *path)
 {
 	int fd = open(path, O_RDONLY);
@@ -534,6 +1116,8 @@ int cts_exist_file(char *path)
 }
 
 #define CTS_COPY_SIZE_MAX 4096
+#define CTS_COPY_RANGE_MAX (1024*1024)
+#define CTS_IMAGE_HASH_LEN 40
 API int contacts_svc_get_image(cts_img_t img_type, int index, char **img_path)
 {
 	int ret;
@@ -605,19 +1189,71 @@ int cts_contact_delete_image_file(int img_type, int index)
 	if (tmp_path) {
 		char full_path[CTS_IMG_PATH_SIZE_MAX];
 		snprintf(full_path, sizeof(full_path), "%s/%s", CTS_IMAGE_LOCATION, tmp_path);
-		ret = unlink(full_path);
-		warn_if (ret < 0, "unlink(%s) Failed(%d)", full_path, errno);
+		ret = cts_image_release(full_path);
+		warn_if (ret < 0, "cts_image_release(%s) Failed(%d)", full_path, ret);
 	}
 	cts_stmt_finalize(stmt);
 	return CTS_SUCCESS;
 }
 
+static int cts_copy_fd(int src_fd, int dest_fd)
+{
+	int ret, size, written;
+	char buf[CTS_COPY_SIZE_MAX];
+
+#ifdef __NR_copy_file_range
+	/* copy_file_range() of glibc is 2.27 or later, so the system call is used */
+	bool in_kernel = true;
+
+	while (in_kernel) {
+		/* The data is copied in the kernel without the user buffer */
+		ret = syscall(__NR_copy_file_range, src_fd, NULL, dest_fd, NULL,
+				(size_t)CTS_COPY_RANGE_MAX, 0U);
+		if (0 == ret)
+			return CTS_SUCCESS;
+		if (ret < 0) {
+			if (EINTR == errno)
+				continue;
+			else if (ENOSYS == errno || EXDEV == errno || EINVAL == errno
+					|| EOPNOTSUPP == errno)
+				in_kernel = false;
+			else {
+				ERR("copy_file_range() Failed(%d)", errno);
+				return (ENOSPC == errno) ? CTS_ERR_NO_SPACE : CTS_ERR_IO_ERR;
+			}
+		}
+	}
+#endif
+
+	/* copying continues from the current offsets */
+	while ((size = read(src_fd, buf, CTS_COPY_SIZE_MAX))) {
+		if (size < 0) {
+			if (EINTR == errno)
+				continue;
+			ERR("read() Failed(%d)", errno);
+			return CTS_ERR_IO_ERR;
+		}
+
+		written = 0;
+		while (written < size) {
+			ret = write(dest_fd, buf + written, size - written);
+			if (ret <= 0) {
+				if (EINTR == errno)
+					continue;
+				ERR("write() Failed(%d)", errno);
+				return (ENOSPC == errno) ? CTS_ERR_NO_SPACE : CTS_ERR_IO_ERR;
+			}
+			written += ret;
+		}
+	}
+
+	return CTS_SUCCESS;
+}
+
 static int cts_copy_file(const char *src, const char *dest)
 {
 	int ret;
-	int size;
 	int src_fd, dest_fd;
-	char buf[CTS_COPY_SIZE_MAX];
 
 	src_fd = open(src, O_RDONLY);
 	retvm_if(src_fd < 0, CTS_ERR_IO_ERR, "Open(%s) Failed(%d)", src, errno);
@@ -628,23 +1264,13 @@ static int cts_copy_file(const char *src, const char *dest)
 		return CTS_ERR_FAIL;
 	}
 
-	while ((size = read(src_fd, buf, CTS_COPY_SIZE_MAX)) > 0) {
-		ret = write(dest_fd, buf, size);
-		if (ret <= 0) {
-			if (EINTR == errno)
-				continue;
-			else {
-				ERR("write() Failed(%d)", errno);
-				if (ENOSPC == errno)
-					ret = CTS_ERR_NO_SPACE;
-				else
-					ret = CTS_ERR_IO_ERR;
-				close(src_fd);
-				close(dest_fd);
-				unlink(dest);
-				return ret;
-			}
-		}
+	ret = cts_copy_fd(src_fd, dest_fd);
+	if (CTS_SUCCESS != ret) {
+		ERR("cts_copy_fd() Failed(%d)", ret);
+		close(src_fd);
+		close(dest_fd);
+		unlink(dest);
+		return ret;
 	}
 
 	fchown(dest_fd, getuid(), CTS_SECURITY_FILE_GROUP);
@@ -655,10 +1281,303 @@ static int cts_copy_file(const char *src, const char *dest)
 	return CTS_SUCCESS;
 }
 
-int cts_contact_add_image_file(int img_type, int index, char *src_img, char *dest_name, int dest_size)
+/* The hex string of SHA1 is used for the name in the image store */
+int cts_image_hash(const char *path, char *dest, int dest_size)
+{
+	int fd, size;
+	GChecksum *checksum;
+	guchar buf[CTS_COPY_SIZE_MAX];
+
+	fd = open(path, O_RDONLY);
+	retvm_if(fd < 0, CTS_ERR_IO_ERR, "open(%s) Failed(%d)", path, errno);
+
+	checksum = g_checksum_new(G_CHECKSUM_SHA1);
+	while ((size = read(fd, buf, sizeof(buf)))) {
+		if (size < 0) {
+			if (EINTR == errno)
+				continue;
+			ERR("read(%s) Failed(%d)", path, errno);
+			g_checksum_free(checksum);
+			close(fd);
+			return CTS_ERR_IO_ERR;
+		}
+		g_checksum_update(checksum, buf, size);
+	}
+	close(fd);
+
+	snprintf(dest, dest_size, "%s", g_checksum_get_string(checksum));
+	g_checksum_free(checksum);
+
+	return CTS_SUCCESS;
+}
+
+/*
+ * The name of stored image is "index-type.hash.ext".
+ * returns the hash in the name, or NULL if the name doesn't have it.
+ */
+static char* cts_image_name_hash(const char *path, char *dest, int dest_size)
+{
+	int i;
+	const char *name;
+
+	name = strrchr(path, '/');
+	name = name ? name + 1 : path;
+	name = strchr(name, '.');
+	retv_if(NULL == name, NULL);
+
+	name++;
+	for (i=0;i<CTS_IMAGE_HASH_LEN;i++) {
+		if (!isxdigit(name[i]))
+			return NULL;
+	}
+	if ('.' != name[i] && '\0' != name[i])
+		return NULL;
+	retv_if(dest_size <= CTS_IMAGE_HASH_LEN, NULL);
+
+	memcpy(dest, name, CTS_IMAGE_HASH_LEN);
+	dest[CTS_IMAGE_HASH_LEN] = '\0';
+
+	return dest;
+}
+
+/*
+ * The thumbnails of an image which doesn't have the hash in the name are
+ * keyed on its path, size and modification time not to read the whole image.
+ */
+static void cts_image_stat_hash(const char *path, const struct stat *buf,
+		char *dest, int dest_size)
+{
+	gchar *checksum;
+	char key[CTS_IMG_PATH_SIZE_MAX + 64];
+
+	snprintf(key, sizeof(key), "%s:%lld:%ld.%09ld", path, (long long)buf->st_size,
+			(long)buf->st_mtim.tv_sec, (long)buf->st_mtim.tv_nsec);
+	checksum = g_compute_checksum_for_string(G_CHECKSUM_SHA1, key, -1);
+	snprintf(dest, dest_size, "%s", checksum);
+	g_free(checksum);
+}
+
+static cts_thumbnail_fn cts_thumbnail_maker;
+static void *cts_thumbnail_maker_data;
+
+/* The thumbnails of an image are in CTS_THUMBNAIL_LOCATION/hash/ */
+static void cts_thumbnail_remove(const char *hash)
+{
+	DIR *dp;
+	struct dirent *file_info;
+	char dir[CTS_IMG_PATH_SIZE_MAX];
+	char path[CTS_IMG_PATH_SIZE_MAX];
+
+	snprintf(dir, sizeof(dir), "%s/%s", CTS_THUMBNAIL_LOCATION, hash);
+	dp = opendir(dir);
+	if (NULL == dp)
+		return;
+
+	while ((file_info = readdir(dp))) {
+		if ('.' == *file_info->d_name)
+			continue;
+		snprintf(path, sizeof(path), "%s/%s", dir, file_info->d_name);
+		unlink(path);
+	}
+	closedir(dp);
+	rmdir(dir);
+}
+
+/*
+ * CTS_THUMBNAIL_LOCATION/path-hash.path is the symbolic link to the stat hash of an image
+ * which is not stored by contacts service. It finds the thumbnails of the older content.
+ */
+static void cts_thumbnail_path_link(const char *path, char *dest, int dest_size)
+{
+	gchar *checksum;
+
+	checksum = g_compute_checksum_for_string(G_CHECKSUM_SHA1, path, -1);
+	snprintf(dest, dest_size, "%s/%s.path", CTS_THUMBNAIL_LOCATION, checksum);
+	g_free(checksum);
+}
+
+static void cts_thumbnail_set_path_link(const char *path, const char *hash)
+{
+	ssize_t len;
+	char old[64];
+	char link_path[CTS_IMG_PATH_SIZE_MAX];
+	char tmp[CTS_IMG_PATH_SIZE_MAX];
+
+	cts_thumbnail_path_link(path, link_path, sizeof(link_path));
+
+	len = readlink(link_path, old, sizeof(old) - 1);
+	if (0 < len) {
+		old[len] = '\0';
+		if (0 == strcmp(old, hash))
+			return;
+		cts_thumbnail_remove(old);
+	}
+
+	snprintf(tmp, sizeof(tmp), "%s.%d-%lu", link_path, getpid(), (unsigned long)pthread_self());
+	if (0 == symlink(hash, tmp) && 0 == rename(tmp, link_path))
+		return;
+	ERR("symlink/rename(%s) Failed(%d)", link_path, errno);
+	unlink(tmp);
+}
+
+static int cts_image_store_add(const char *src, const char *blob, bool owned)
+{
+	int ret;
+	char tmp[CTS_IMG_PATH_SIZE_MAX];
+
+	ret = mkdir(CTS_IMAGE_STORE_LOCATION, 0770);
+	retvm_if(ret < 0 && EEXIST != errno, CTS_ERR_IO_ERR,
+			"mkdir(%s) Failed(%d)", CTS_IMAGE_STORE_LOCATION, errno);
+
+	if (owned) {
+		if (0 == rename(src, blob) || 0 == link(src, blob)) {
+			chown(blob, getuid(), CTS_SECURITY_FILE_GROUP);
+			chmod(blob, CTS_SECURITY_DEFAULT_PERMISSION);
+			return CTS_SUCCESS;
+		}
+		warn_if(EXDEV != errno, "rename/link(%s) Failed(%d)", src, errno);
+	}
+
+	/* The blob appears at once, because another process can store the same image */
+	snprintf(tmp, sizeof(tmp), "%s.%d-%lu", blob, getpid(), (unsigned long)pthread_self());
+	ret = cts_copy_file(src, tmp);
+	retvm_if(CTS_SUCCESS != ret, ret, "cts_copy_file() Failed(%d)", ret);
+
+	ret = rename(tmp, blob);
+	if (ret < 0) {
+		ERR("rename(%s) Failed(%d)", tmp, errno);
+		unlink(tmp);
+		return CTS_ERR_IO_ERR;
+	}
+
+	return CTS_SUCCESS;
+}
+
+/*
+ * The content of image is kept once in the image store and
+ * dest is a hard link of it. So the same images share the data.
+ * The hash should be gotten by cts_image_hash(src).
+ * If owned is true, src is taken(renamed or linked) and removed after storing.
+ */
+int cts_image_store(const char *src, const char *hash, const char *dest, bool owned)
+{
+	int ret, i;
+	char blob[CTS_IMG_PATH_SIZE_MAX];
+
+	snprintf(blob, sizeof(blob), "%s/%s", CTS_IMAGE_STORE_LOCATION, hash);
+
+	unlink(dest);
+	/* The blob can be released by another process between adding and linking */
+	for (i=0;i<2;i++) {
+		if (0 != access(blob, F_OK)) {
+			ret = cts_image_store_add(src, blob, owned);
+			retvm_if(CTS_SUCCESS != ret, ret, "cts_image_store_add() Failed(%d)", ret);
+		}
+
+		ret = link(blob, dest);
+		if (0 == ret || ENOENT != errno)
+			break;
+	}
+
+	if (ret < 0) {
+		/* The file system which doesn't support hard link */
+		ERR("link(%s) Failed(%d)", dest, errno);
+		ret = cts_copy_file(blob, dest);
+		retvm_if(CTS_SUCCESS != ret, ret, "cts_copy_file() Failed(%d)", ret);
+	}
+
+	if (owned)
+		unlink(src);
+
+	return CTS_SUCCESS;
+}
+
+/*
+ * On the file system without hard link, the stored images are copies of the blob.
+ * They are found by the hash in their names("index-type.hash.ext").
+ */
+static bool cts_image_referred(const char *hash)
+{
+	DIR *dp;
+	bool found = false;
+	struct dirent *file_info;
+	char name_hash[64];
+
+	dp = opendir(CTS_IMAGE_LOCATION);
+	retvm_if(NULL == dp, true, "opendir(%s) Failed(%d)", CTS_IMAGE_LOCATION, errno);
+
+	while ((file_info = readdir(dp))) {
+		if ('.' == *file_info->d_name)
+			continue;
+		if (cts_image_name_hash(file_info->d_name, name_hash, sizeof(name_hash))
+				&& 0 == strcmp(name_hash, hash)) {
+			found = true;
+			break;
+		}
+	}
+	closedir(dp);
+
+	return found;
+}
+
+/*
+ * This function removes the image which is stored by cts_image_store().
+ * The content in the image store is removed with its last link,
+ * or with its last copy on the file system without hard link.
+ */
+int cts_image_release(const char *path)
+{
+	int ret;
+	bool named, unused = false;
+	struct stat buf, blob_buf;
+	char hash[64];
+	char stat_hash[64];
+	char blob[CTS_IMG_PATH_SIZE_MAX];
+	char link_path[CTS_IMG_PATH_SIZE_MAX];
+
+	ret = stat(path, &buf);
+	retvm_if(ret < 0, CTS_ERR_IO_ERR, "stat(%s) Failed(%d)", path, errno);
+
+	named = (NULL != cts_image_name_hash(path, hash, sizeof(hash)));
+	if (!named)
+		cts_image_stat_hash(path, &buf, stat_hash, sizeof(stat_hash));
+
+	blob[0] = '\0';
+	/* the link of path and the link in the image store */
+	if (named || (2 == buf.st_nlink
+				&& CTS_SUCCESS == cts_image_hash(path, hash, sizeof(hash))))
+		snprintf(blob, sizeof(blob), "%s/%s", CTS_IMAGE_STORE_LOCATION, hash);
+
+	ret = unlink(path);
+	retvm_if(ret < 0, CTS_ERR_IO_ERR, "unlink(%s) Failed(%d)", path, errno);
+
+	if (!named) {
+		cts_thumbnail_remove(stat_hash);
+		cts_thumbnail_path_link(path, link_path, sizeof(link_path));
+		unlink(link_path);
+	}
+
+	if (*blob && 0 == stat(blob, &blob_buf) && 1 == blob_buf.st_nlink) {
+		if (blob_buf.st_ino == buf.st_ino && blob_buf.st_dev == buf.st_dev)
+			unused = true;
+		else /* path was a copy of the blob */
+			unused = (named && !cts_image_referred(hash));
+
+		if (unused) {
+			unlink(blob);
+			cts_thumbnail_remove(hash);
+		}
+	}
+
+	return CTS_SUCCESS;
+}
+
+static int cts_contact_store_image_file(int img_type, int index, char *src_img,
+		bool owned, char *dest_name, int dest_size)
 {
 	int ret;
 	char *ext;
+	char hash[64];
 	char dest[CTS_IMG_PATH_SIZE_MAX];
 
 	retvm_if(NULL == src_img, CTS_ERR_ARG_INVALID, "img_path is NULL");
@@ -667,16 +1586,33 @@ int cts_contact_add_image_file(int img_type, int index, char *src_img, char *des
 	if (NULL == ext || strchr(ext, '/'))
 		ext = "";
 
-	snprintf(dest, sizeof(dest), "%s/%d-%d%s",
-			CTS_IMAGE_LOCATION, index, img_type, ext);
+	ret = cts_image_hash(src_img, hash, sizeof(hash));
+	retvm_if(CTS_SUCCESS != ret, ret, "cts_image_hash() Failed(%d)", ret);
 
-	ret = cts_copy_file(src_img, dest);
-	retvm_if(CTS_SUCCESS != ret, ret, "cts_copy_file() Failed(%d)", ret);
+	/* The hash in the name is used for the thumbnail */
+	snprintf(dest, sizeof(dest), "%s/%d-%d.%s%s",
+			CTS_IMAGE_LOCATION, index, img_type, hash, ext);
+
+	ret = cts_image_store(src_img, hash, dest, owned);
+	retvm_if(CTS_SUCCESS != ret, ret, "cts_image_store() Failed(%d)", ret);
 
-	snprintf(dest_name, dest_size, "%d-%d%s", index, img_type, ext);
+	snprintf(dest_name, dest_size, "%d-%d.%s%s", index, img_type, hash, ext);
 	return CTS_SUCCESS;
 }
 
+int cts_contact_add_image_file(int img_type, int index, char *src_img, char *dest_name, int dest_size)
+{
+	return cts_contact_store_image_file(img_type, index, src_img, false, dest_name, dest_size);
+}
+
+/*
+ * The src_img is taken by the image store instead of being copied.
+ */
+int cts_contact_move_image_file(int img_type, int index, char *src_img, char *dest_name, int dest_size)
+{
+	return cts_contact_store_image_file(img_type, index, src_img, true, dest_name, dest_size);
+}
+
 int cts_contact_update_image_file(int img_type, int index, char *src_img, char *dest_name, int dest_size)
 {
 	int ret;
@@ -819,46 +1755,45 @@ API int contacts_svc_save_image(cts_img_t img_type, int index, char *src_img)
 	return CTS_SUCCESS;
 }
 
+/*
+ * The counts are kept in counters by the triggers(schema.sql),
+ * so each count is a point lookup instead of scanning contacts.
+ */
 API int contacts_svc_count_with_int(cts_count_int_op op_code, int search_value)
 {
-	int ret;
-	cts_stmt stmt;
+	int ret, kind;
+	char addrbook_cond[CTS_SQL_MIN_LEN] = {0};
 	char query[CTS_SQL_MIN_LEN] = {0};
 
 	switch ((int)op_code) {
 	case CTS_GET_COUNT_CONTACTS_IN_ADDRESSBOOK:
-		snprintf(query, sizeof(query),
-				"SELECT COUNT(DISTINCT person_id) FROM %s "
-				"WHERE addrbook_id = ?", CTS_TABLE_CONTACTS);
+		kind = CTS_SCHEMA_COUNTER_PERSONS_IN_ADDRESSBOOK;
 		break;
 	case CTS_GET_COUNT_CONTACTS_IN_GROUP:
-		snprintf(query, sizeof(query),
-				"SELECT COUNT(DISTINCT person_id) "
-				"FROM %s A, %s B ON A.contact_id = B.contact_id "
-				"WHERE group_id = ?",
-				CTS_TABLE_GROUPING_INFO, CTS_TABLE_CONTACTS);
+		kind = CTS_SCHEMA_COUNTER_PERSONS_IN_GROUP;
 		break;
 	case CTS_GET_COUNT_NO_GROUP_CONTACTS_IN_ADDRESSBOOK:
-		snprintf(query, sizeof(query),
-				"SELECT COUNT(DISTINCT person_id) FROM %s A "
-				"WHERE addrbook_id = ? AND NOT EXISTS "
-				"(SELECT contact_id FROM %s WHERE contact_id=A.contact_id LIMIT 1)",
-				CTS_TABLE_CONTACTS, CTS_TABLE_GROUPING_INFO);
+		kind = CTS_SCHEMA_COUNTER_NO_GROUP_PERSONS_IN_ADDRESSBOOK;
 		break;
 	case CTS_GET_COUNT_GROUPS_IN_ADDRESSBOOK: // FIXME: should be removed (for OSP): CTS_GET_COUNT_GROUPS_IN_ADDRESSBOOK
-		snprintf(query, sizeof(query),
-				"SELECT COUNT(*) FROM %s WHERE addrbook_id = ?",
-				CTS_TABLE_GROUPS);
+		kind = CTS_SCHEMA_COUNTER_GROUPS_IN_ADDRESSBOOK;
 		break;
 	default:
 		ERR("Invalid parameter : The op_code(%d) is not supported", op_code);
 		return CTS_ERR_ARG_INVALID;
 	}
-	stmt = cts_query_prepare(query);
-	retvm_if(NULL == stmt, CTS_ERR_DB_FAILED, "cts_query_prepare() Failed");
 
-	cts_stmt_bind_int(stmt, 1, search_value);
-	ret = cts_stmt_get_first_int_result(stmt);
+	/* The addressbook which is being deleted is counted as empty */
+	if (CTS_GET_COUNT_CONTACTS_IN_GROUP == op_code)
+		snprintf(addrbook_cond, sizeof(addrbook_cond),
+				"(SELECT addrbook_id FROM %s WHERE group_id = %d)", CTS_TABLE_GROUPS, search_value);
+	else
+		snprintf(addrbook_cond, sizeof(addrbook_cond), "%d", search_value);
+	snprintf(query, sizeof(query), "SELECT cnt FROM %s WHERE kind = %d AND scope = %d "
+			"AND NOT EXISTS (SELECT 1 FROM %s WHERE addrbook_id = %s AND deleting = 1)",
+			CTS_TABLE_COUNTERS, kind, search_value, CTS_TABLE_ADDRESSBOOKS, addrbook_cond);
+
+	ret = cts_query_get_first_int_result(query);
 	if (CTS_ERR_DB_RECORD_NOT_FOUND == ret) return 0;
 	else return ret;
 }
@@ -866,61 +1801,73 @@ API int contacts_svc_count_with_int(cts_count_int_op op_code, int search_value)
 API int contacts_svc_count(cts_count_op op_code)
 {
 	int ret;
+	const char *data;
 	char query[CTS_SQL_MIN_LEN] = {0};
 
 	switch ((int)op_code)
 	{
 	case CTS_GET_ALL_CONTACT:
-		if (cts_restriction_get_permit())
-			snprintf(query, sizeof(query),"SELECT COUNT(*) FROM %s",
-				CTS_TABLE_PERSONS);
+		data = cts_addressbook_get_visible_data();
+		if (!strcmp(data, CTS_TABLE_VISIBLE_DATA_VIEW))
+			/* The counters include an addressbook which is being deleted */
+			snprintf(query, sizeof(query),
+					"SELECT COUNT(*) FROM %s A, %s B ON A.contact_id = B.person_id "
+					"WHERE A.datatype = %d AND B.person_id = B.contact_id",
+					data, CTS_TABLE_CONTACTS, CTS_DATA_NAME);
+		else if (cts_restriction_get_permit())
+			snprintf(query, sizeof(query), "SELECT cnt FROM %s WHERE kind = %d AND scope = 0",
+					CTS_TABLE_COUNTERS, CTS_SCHEMA_COUNTER_PERSONS);
 		else
-			snprintf(query, sizeof(query),"SELECT COUNT(*) FROM %s "
-						"WHERE person_id NOT IN "
-						"(SELECT contact_id FROM %s WHERE is_restricted = 1)",
-				CTS_TABLE_PERSONS, CTS_TABLE_DATA);
-
+			snprintf(query, sizeof(query),
+					"SELECT (SELECT cnt FROM %s WHERE kind = %d AND scope = 0) - "
+					"(SELECT COUNT(*) FROM %s A, %s B ON A.member = B.person_id "
+					"WHERE A.kind = %d AND A.scope = 0)",
+					CTS_TABLE_COUNTERS, CTS_SCHEMA_COUNTER_PERSONS,
+					CTS_TABLE_COUNTER_REFS, CTS_TABLE_PERSONS,
+					CTS_SCHEMA_COUNTER_RESTRICTED_CONTACTS);
 		break;
 	case CTS_GET_COUNT_SDN:
 		snprintf(query, sizeof(query),"SELECT COUNT(*) FROM %s",
 				CTS_TABLE_SIM_SERVICES);
 		break;
 	case CTS_GET_ALL_PHONELOG:
-		snprintf(query, sizeof(query), "SELECT COUNT(*) FROM %s",
-				CTS_TABLE_PHONELOGS);
+		snprintf(query, sizeof(query), "SELECT SUM(log_cnt) FROM %s",
+				CTS_TABLE_PHONELOG_COUNTS);
 		break;
 	case CTS_GET_UNSEEN_MISSED_CALL:
 		snprintf(query, sizeof(query),
-				"SELECT COUNT(*) FROM %s "
+				"SELECT SUM(log_cnt) FROM %s "
 				"WHERE log_type = %d OR log_type = %d",
-				CTS_TABLE_PHONELOGS,
+				CTS_TABLE_PHONELOG_COUNTS,
 				CTS_PLOG_TYPE_VOICE_INCOMMING_UNSEEN, CTS_PLOG_TYPE_VIDEO_INCOMMING_UNSEEN);
 		break;
 	case CTS_GET_INCOMING_CALL:
 		snprintf(query, sizeof(query),
-				"SELECT COUNT(*) FROM %s "
+				"SELECT SUM(log_cnt) FROM %s "
 				"WHERE log_type = %d OR log_type = %d",
-				CTS_TABLE_PHONELOGS,
+				CTS_TABLE_PHONELOG_COUNTS,
 				CTS_PLOG_TYPE_VOICE_INCOMMING, CTS_PLOG_TYPE_VIDEO_INCOMMING);
 		break;
 	case CTS_GET_OUTGOING_CALL:
 		snprintf(query, sizeof(query),
-				"SELECT COUNT(*) FROM %s "
+				"SELECT SUM(log_cnt) FROM %s "
 				"WHERE log_type = %d OR log_type = %d",
-				CTS_TABLE_PHONELOGS,
+				CTS_TABLE_PHONELOG_COUNTS,
 				CTS_PLOG_TYPE_VOICE_OUTGOING, CTS_PLOG_TYPE_VIDEO_OUTGOING);
 		break;
 	case CTS_GET_MISSED_CALL:
 		snprintf(query, sizeof(query),
-				"SELECT COUNT(*) FROM %s "
+				"SELECT SUM(log_cnt) FROM %s "
 				"WHERE log_type BETWEEN %d AND %d",
-				CTS_TABLE_PHONELOGS,
+				CTS_TABLE_PHONELOG_COUNTS,
 				CTS_PLOG_TYPE_VOICE_INCOMMING_UNSEEN, CTS_PLOG_TYPE_VIDEO_INCOMMING_SEEN);
 		break;
 	case CTS_GET_COUNT_ALL_GROUP: // FIXME: should be removed (for OSP): CTS_GET_COUNT_ALL_GROUP
 		snprintf(query, sizeof(query),
-				"SELECT COUNT(*) FROM %s",
-				CTS_TABLE_GROUPS);
+				"SELECT SUM(cnt) FROM %s WHERE kind = %d AND scope NOT IN "
+				"(SELECT addrbook_id FROM %s WHERE deleting = 1)",
+				CTS_TABLE_COUNTERS, CTS_SCHEMA_COUNTER_GROUPS_IN_ADDRESSBOOK,
+				CTS_TABLE_ADDRESSBOOKS);
 		break;
 	default:
 		ERR("Invalid parameter : The op_code(%d) is not supported", op_code);
@@ -998,7 +1945,20 @@ API int contacts_svc_import_sim(void)
 	int ret;
 
 	cts_mutex_lock(CTS_MUTEX_SOCKET_FD);
-	ret = cts_request_sim_import();
+	ret = cts_request_sim_import(NULL, NULL);
+	cts_mutex_unlock(CTS_MUTEX_SOCKET_FD);
+
+	return ret;
+}
+
+API int contacts_svc_import_sim_with_progress(cts_sim_import_fn progress_cb, void *user_data)
+{
+	int ret;
+
+	retv_if(NULL == progress_cb, CTS_ERR_ARG_NULL);
+
+	cts_mutex_lock(CTS_MUTEX_SOCKET_FD);
+	ret = cts_request_sim_import(progress_cb, user_data);
 	cts_mutex_unlock(CTS_MUTEX_SOCKET_FD);
 
 	return ret;
@@ -1086,3 +2046,75 @@ int cts_init_time(void)
 }
 #endif
 
+
+API void contacts_svc_set_thumbnail_maker(cts_thumbnail_fn fn, void *user_data)
+{
+	cts_thumbnail_maker = fn;
+	cts_thumbnail_maker_data = user_data;
+}
+
+API int contacts_svc_get_thumbnail(const char *img_path, int size, char **thumb_path)
+{
+	int ret;
+	bool named;
+	char *ext;
+	char hash[64];
+	char dest[CTS_IMG_PATH_SIZE_MAX];
+	char tmp[CTS_IMG_PATH_SIZE_MAX];
+
+	retv_if(NULL == img_path, CTS_ERR_ARG_NULL);
+	retv_if(NULL == thumb_path, CTS_ERR_ARG_NULL);
+	retvm_if(size <= 0, CTS_ERR_ARG_INVALID, "size(%d) is invalid", size);
+
+	*thumb_path = NULL;
+	if (NULL == cts_thumbnail_maker)
+		goto ORIGINAL;
+
+	named = (NULL != cts_image_name_hash(img_path, hash, sizeof(hash)));
+	if (!named) {
+		struct stat buf;
+		ret = stat(img_path, &buf);
+		if (ret < 0) {
+			ERR("stat(%s) Failed(%d)", img_path, errno);
+			goto ORIGINAL;
+		}
+		cts_image_stat_hash(img_path, &buf, hash, sizeof(hash));
+	}
+
+	ext = strrchr(img_path, '.');
+	if (NULL == ext || strchr(ext, '/'))
+		ext = "";
+
+	snprintf(dest, sizeof(dest), "%s/%s", CTS_THUMBNAIL_LOCATION, hash);
+	ret = mkdir(CTS_THUMBNAIL_LOCATION, 0770);
+	warn_if(ret < 0 && EEXIST != errno, "mkdir(%s) Failed(%d)", CTS_THUMBNAIL_LOCATION, errno);
+	ret = mkdir(dest, 0770);
+	warn_if(ret < 0 && EEXIST != errno, "mkdir(%s) Failed(%d)", dest, errno);
+	if (0 == ret && !named)
+		cts_thumbnail_set_path_link(img_path, hash);
+
+	snprintf(dest, sizeof(dest), "%s/%s/%d%s", CTS_THUMBNAIL_LOCATION, hash, size, ext);
+	if (0 == access(dest, F_OK))
+		goto DONE;
+
+	/* The thumbnail appears at once, because another process can make it */
+	snprintf(tmp, sizeof(tmp), "%s.%d-%lu", dest, getpid(), (unsigned long)pthread_self());
+	ret = cts_thumbnail_maker(img_path, tmp, size, cts_thumbnail_maker_data);
+	if (CTS_SUCCESS != ret || rename(tmp, dest) < 0) {
+		ERR("Making thumbnail(%s) Failed(%d, %d)", dest, ret, errno);
+		unlink(tmp);
+		goto ORIGINAL;
+	}
+	chown(dest, getuid(), CTS_SECURITY_FILE_GROUP);
+	chmod(dest, CTS_SECURITY_DEFAULT_PERMISSION);
+
+DONE:
+	*thumb_path = strdup(dest);
+	retvm_if(NULL == *thumb_path, CTS_ERR_OUT_OF_MEMORY, "strdup() Failed");
+	return CTS_SUCCESS;
+
+ORIGINAL:
+	*thumb_path = strdup(img_path);
+	retvm_if(NULL == *thumb_path, CTS_ERR_OUT_OF_MEMORY, "strdup() Failed");
+	return CTS_SUCCESS;
+}
@@ -22,9 +22,12 @@
 #define __CTS_UTILS_H__
 
 #include <stdbool.h>
+#include <time.h>
 
 #define CTS_IMG_PATH_SIZE_MAX 1024
 #define CTS_IMAGE_LOCATION "/opt/data/contacts-svc/img"
+#define CTS_IMAGE_STORE_LOCATION CTS_IMAGE_LOCATION"/.store"
+#define CTS_THUMBNAIL_LOCATION CTS_IMAGE_LOCATION"/.thumb"
 #define CTS_VCARD_IMAGE_LOCATION "/opt/data/contacts-svc/img/vcard"
 #define CTS_GROUP_IMAGE_LOCATION "/opt/data/contacts-svc/img/group"
 #define CTS_MY_IMAGE_LOCATION "/opt/data/contacts-svc/img/my"
@@ -42,14 +45,22 @@ void cts_set_addrbook_noti(void);
 void cts_set_group_noti(void);
 void cts_set_group_rel_noti(void);
 void cts_set_link_noti(void);
+void cts_add_change_noti(int table, int id, int op);
+int cts_get_addrbook_noti_time(struct timespec *dest);
 int cts_exist_file(char *path);
 int cts_convert_nicknames2textlist(GSList *src, char *dest, int dest_size);
 GSList* cts_convert_textlist2nicknames(char *text_list);
 int cts_increase_outgoing_count(int contact_id);
 int cts_get_next_ver(void);
+int cts_savepoint_begin(void);
+int cts_savepoint_end(bool is_success);
 int cts_update_contact_changed_time(int contact_id);
 int cts_contact_delete_image_file(int img_type, int index);
 int cts_contact_add_image_file(int img_type, int index, char *src_img, char *dest_name, int dest_size);
+int cts_contact_move_image_file(int img_type, int index, char *src_img, char *dest_name, int dest_size);
+int cts_image_hash(const char *path, char *dest, int dest_size);
+int cts_image_store(const char *src, const char *hash, const char *dest, bool owned);
+int cts_image_release(const char *path);
 int cts_contact_update_image_file(int img_type, int index, char *src_img, char *dest_name, int dest_size);
 
 char* cts_get_img(const char *dir, int index, char *dest, int dest_size);
@@ -212,6 +223,118 @@ int contacts_svc_unsubscribe_change(cts_subscribe_type noti_type,
 int contacts_svc_unsubscribe_change_with_data(cts_subscribe_type noti_type,
 		void (*cb)(void *), void *user_data);
 
+/**
+ * This function watchs contacts service changes like contacts_svc_subscribe_change().
+ * But the notifications which are sent in interval are merged to one callback.
+ * The callback is called when interval is elapsed after the first notification.
+ * It can be removed by contacts_svc_unsubscribe_change()
+ * or contacts_svc_unsubscribe_change_with_data().
+ *
+ * @param[in] noti_type A kind of Notification
+ * @param[in] cb callback function pointer
+ * @param[in] user_data data which is passed to callback function
+ * @param[in] interval The interval(milliseconds) of merging notifications
+ * @return #CTS_SUCCESS on success, Negative value(#cts_error) on error
+ */
+int contacts_svc_subscribe_change_debounced(cts_subscribe_type noti_type,
+		void (*cb)(void *), void *user_data, int interval);
+
+/**
+ * This function holds notifications of the transactions which are committed
+ * by this process until contacts_svc_end_noti_batch().
+ * The held notifications are merged and sent once by contacts_svc_end_noti_batch().
+ * It can be nested.
+ * Use it for bulk operations such as sync.
+ *
+ * @return #CTS_SUCCESS on success, Negative value(#cts_error) on error
+ * @par example
+ * @code
+ contacts_svc_begin_noti_batch();
+ for (i=0;i<cnt;i++)
+    contacts_svc_insert_contact(addressbook_id, contacts[i]);
+ contacts_svc_end_noti_batch(); // subscribers are notified once.
+ * @endcode
+ */
+int contacts_svc_begin_noti_batch(void);
+
+/**
+ * This function sends the notifications which are held by contacts_svc_begin_noti_batch().
+ * If the process is disconnected, the held notifications are sent.
+ *
+ * @return #CTS_SUCCESS on success, Negative value(#cts_error) on error
+ */
+int contacts_svc_end_noti_batch(void);
+
+/**
+ * Use for #cts_change_record
+ */
+typedef enum{
+	CTS_CHANGE_TABLE_CONTACT, /**< The id is contact id */
+	CTS_CHANGE_TABLE_GROUP, /**< The id is group id */
+	CTS_CHANGE_TABLE_ADDRESSBOOK, /**< The id is addressbook id */
+	CTS_CHANGE_TABLE_PHONELOG, /**< The id is phonelog id */
+}cts_change_table;
+
+/**
+ * A change which is delivered by contacts_svc_subscribe_change_records().
+ */
+typedef struct{
+	int version; /**< The version of the transaction which made this change */
+	int table; /**< #cts_change_table */
+	int id; /**< The index of the changed record */
+	int op; /**< #CTS_OPERATION_INSERTED, #CTS_OPERATION_UPDATED, #CTS_OPERATION_DELETED */
+}cts_change_record;
+
+/**
+ * When records is NULL(count is 0), some records were dropped before they were read.
+ * In this case, the subscriber should re-sync with contacts_svc_get_updated_contacts_after().
+ * The records are valid only in the callback.
+ */
+typedef void (*cts_change_record_fn)(const cts_change_record *records,
+		int count, void *user_data);
+
+/**
+ * This function watchs changes of contacts service with the index and the operation of
+ * each changed record. The records are delivered in order of commit,
+ * in batches of at most 64 records.
+ * Only the changes which are committed after subscription are delivered.
+ * Deleting a group with its members or an addressbook is delivered as
+ * one #CTS_OPERATION_DELETED of the group or the addressbook.
+ * This is handled by default context of g_main_loop.
+ *
+ * @param[in] cb callback function pointer
+ * @param[in] user_data data which is passed to callback function
+ * @return #CTS_SUCCESS on success, Negative value(#cts_error) on error
+ * @par example
+ * @code
+void change_records_cb(const cts_change_record *records, int count, void *user_data)
+{
+   int i;
+
+   if (NULL == records) {
+      // some changes were lost. re-sync with contacts_svc_get_updated_contacts_after()
+      return;
+   }
+   for (i=0;i<count;i++) {
+      if (CTS_CHANGE_TABLE_CONTACT == records[i].table)
+         printf("contact(%d) is changed(%d) at %d\n",
+               records[i].id, records[i].op, records[i].version);
+   }
+}
+
+contacts_svc_subscribe_change_records(change_records_cb, NULL);
+ * @endcode
+ */
+int contacts_svc_subscribe_change_records(cts_change_record_fn cb, void *user_data);
+
+/**
+ * This function stops to watch changes which is added by contacts_svc_subscribe_change_records().
+ * @param[in] cb The callback function which is added by contacts_svc_subscribe_change_records()
+ * @param[in] user_data The user_data which is added by contacts_svc_subscribe_change_records()
+ * @return #CTS_SUCCESS on success, Negative value(#cts_error) on error
+ */
+int contacts_svc_unsubscribe_change_records(cts_change_record_fn cb, void *user_data);
+
 /**
  * Use for contacts_svc_count()
  */
@@ -284,6 +407,55 @@ int contacts_svc_save_image(cts_img_t img_type, int index, char *src_img);
  */
 int contacts_svc_get_image(cts_img_t img_type, int index, char **img_path);
 
+/**
+ * Use for contacts_svc_set_thumbnail_maker().
+ * This function should scale down the image of src and save it to dest.
+ *
+ * @param[in] src The path of original image
+ * @param[in] dest The path of thumbnail to be saved
+ * @param[in] size The maximum width and height of thumbnail
+ * @param[in] user_data The data which is set by contacts_svc_set_thumbnail_maker()
+ * @return #CTS_SUCCESS on success, Negative value(#cts_error) on error
+ */
+typedef int (*cts_thumbnail_fn)(const char *src, const char *dest, int size, void *user_data);
+
+/**
+ * This function sets the function which makes thumbnails.
+ * Contacts service doesn't decode images, so the thumbnail is made by this function.
+ * It should be set before using contacts_svc_get_thumbnail().
+ *
+ * @param[in] fn The function which makes thumbnails(NULL means unset)
+ * @param[in] user_data The data which is passed to fn
+ */
+void contacts_svc_set_thumbnail_maker(cts_thumbnail_fn fn, void *user_data);
+
+/**
+ * This function gets the thumbnail of image for list views.
+ * The thumbnail is made once by the function of contacts_svc_set_thumbnail_maker()
+ * and it is cached by the content of image. So the same images share the thumbnail.
+ * The thumbnail of an image which is not stored by contacts service is cached
+ * by the path, size and modification time of the image.
+ * When the image is modified, the thumbnails of its older content are removed.
+ * If there is no thumbnail maker, the image cannot be read or making thumbnail fails,
+ * the image path is returned.
+ *
+ * @param[in] img_path The image path(e.g. #CTS_LIST_CONTACT_IMG_PATH_STR of list row)
+ * @param[in] size The maximum width and height of thumbnail
+ * @param[out] thumb_path The pointer of getting thumbnail path(should be freed by using free())
+ * @return #CTS_SUCCESS on success, Negative value(#cts_error) on error
+ * @par example
+ * @code
+ char *thumb;
+ ret = contacts_svc_get_thumbnail(contacts_svc_value_get_str(row, CTS_LIST_CONTACT_IMG_PATH_STR),
+                                  96, &thumb);
+ if (CTS_SUCCESS == ret) {
+    show_image(thumb);
+    free(thumb);
+ }
+ * @endcode
+ */
+int contacts_svc_get_thumbnail(const char *img_path, int size, char **thumb_path);
+
 /**
  * This function imports sim phonebook.
  *
@@ -291,6 +463,26 @@ int contacts_svc_get_image(cts_img_t img_type, int index, char **img_path);
  */
 int contacts_svc_import_sim(void);
 
+/**
+ * Use for contacts_svc_import_sim_with_progress().
+ *
+ * @param[in] imported The count of SIM records which are saved
+ * @param[in] total The count of SIM records
+ * @param[in] user_data The data which is set by contacts_svc_import_sim_with_progress()
+ */
+typedef void (*cts_sim_import_fn)(int imported, int total, void *user_data);
+
+/**
+ * This function imports sim phonebook like contacts_svc_import_sim().
+ * While the records are saved, progress_cb is called periodically.
+ * This function returns after importing is finished.
+ *
+ * @param[in] progress_cb The function which is called with the progress
+ * @param[in] user_data data which is passed to progress_cb
+ * @return #CTS_SUCCESS on success, Negative value(#cts_error) on error
+ */
+int contacts_svc_import_sim_with_progress(cts_sim_import_fn progress_cb, void *user_data);
+
 /**
  * This function exports sim phonebook.
  * @param[in] index index of contact
@@ -307,6 +499,62 @@ int contacts_svc_export_sim(int index);
  */
 int contacts_svc_reset_outgoing_count(int person_id);
 
+/**
+ * Use for contacts_svc_mempool_set_cap(), contacts_svc_mempool_get_stats()
+ */
+typedef enum
+{
+	CTS_MEMPOOL_LIST_CONTACT, /**< The values of #CTS_VALUE_LIST_CONTACT, #CTS_VALUE_LIST_NUMBERINFO, #CTS_VALUE_LIST_EMAILINFO */
+	CTS_MEMPOOL_LIST_PLOG, /**< The values of #CTS_VALUE_LIST_PLOG */
+	CTS_MEMPOOL_LIST_CHANGE, /**< The values of #CTS_VALUE_LIST_CHANGE */
+	CTS_MEMPOOL_LIST_CUSTOM_NUM_TYPE, /**< The values of #CTS_VALUE_LIST_CUSTOM_NUM_TYPE */
+	CTS_MEMPOOL_LIST_SHORTCUT, /**< The values of #CTS_VALUE_LIST_SHORTCUT */
+	CTS_MEMPOOL_LIST_GROUP, /**< The values of #CTS_VALUE_LIST_GROUP */
+	CTS_MEMPOOL_LIST_ADDRBOOK, /**< The values of #CTS_VALUE_LIST_ADDRBOOK */
+	CTS_MEMPOOL_LIST_SDN, /**< The values of #CTS_VALUE_LIST_SDN */
+	CTS_MEMPOOL_LIST_OSP, /**< The values of #CTS_VALUE_LIST_OSP */
+	CTS_MEMPOOL_UPDATED_INFO, /**< The record chunks of contacts_svc_get_updated_contacts() and similar iterators */
+	CTS_MEMPOOL_MAX
+}cts_mempool_type;
+
+/**
+ * The statistics of a memory pool. Use for contacts_svc_mempool_get_stats()
+ */
+typedef struct {
+	int cached; /**< The number of free objects kept in the pool */
+	int cap; /**< The maximum number of free objects kept in the pool */
+	unsigned int hit; /**< The number of allocations served from the pool */
+	unsigned int miss; /**< The number of allocations served by calloc() */
+	unsigned int dropped; /**< The number of frees which exceeded the cap */
+}cts_mempool_stats;
+
+/**
+ * This function sets the maximum number of free objects
+ * which the memory pool of the type keeps for reuse.
+ * If the pool has more objects than cap, the extra objects are freed.
+ * 0 disables the pool.
+ *
+ * @param[in] type #cts_mempool_type
+ * @param[in] cap The maximum number of free objects
+ * @return #CTS_SUCCESS on success, Negative value(#cts_error) on error
+ */
+int contacts_svc_mempool_set_cap(cts_mempool_type type, int cap);
+
+/**
+ * This function gets the statistics of the memory pool of the type.
+ *
+ * @param[in] type #cts_mempool_type
+ * @param[out] stats The statistics of the pool
+ * @return #CTS_SUCCESS on success, Negative value(#cts_error) on error
+ */
+int contacts_svc_mempool_get_stats(cts_mempool_type type, cts_mempool_stats *stats);
+
+/**
+ * This function frees all objects kept in the memory pools of contacts service.
+ * It is useful when the process becomes idle or the system memory is low.
+ */
+void contacts_svc_trim_memory(void);
+
 //-->
 #endif //#ifndef __CONTACTS_SVC_H__
 
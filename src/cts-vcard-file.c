@@ -18,12 +18,15 @@
  * limitations under the License.
  *
  */
+#define _GNU_SOURCE
 #include <ctype.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <errno.h>
 #include <time.h>
 #include <iconv.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "cts-internal.h"
 #include "cts-types.h"
@@ -279,9 +282,10 @@ static inline int cts_vcard_remove_folding(char *folded_src)
 	retv_if(NULL == folded_src, CTS_ERR_ARG_NULL);
 
 	while (*folded_src) {
-		if ('\r' == *folded_src && '\n' == *(folded_src+1) && ' ' == *(folded_src+2))
+		if ('\r' == *folded_src && '\n' == *(folded_src+1)
+				&& (' ' == *(folded_src+2) || '\t' == *(folded_src+2)))
 			folded_src += 3;
-		else if ('\n' == *folded_src && ' ' == *(folded_src+1))
+		else if ('\n' == *folded_src && (' ' == *(folded_src+1) || '\t' == *(folded_src+1)))
 			folded_src += 2;
 
 		if ('\0' == *folded_src)
@@ -473,11 +477,11 @@ static inline int cts_vcard_get_name(cts_name *name, char *val)
 
 static inline GSList* cts_vcard_get_nickname(GSList *nicks, char *val)
 {
-	char *temp;
+	char *temp, *save = NULL;
 	cts_nickname *result;
 	const char *separator = ",";
 
-	temp = strtok(val, separator);
+	temp = strtok_r(val, separator, &save);
 	while (temp) {
 		if ('\0' == *temp) continue;
 
@@ -488,7 +492,7 @@ static inline GSList* cts_vcard_get_nickname(GSList *nicks, char *val)
 			nicks = g_slist_append(nicks, result);
 		}
 
-		temp = strtok(NULL, separator);
+		temp = strtok_r(NULL, separator, &save);
 	}
 
 	return nicks;
@@ -927,28 +931,24 @@ static inline const char* cts_get_img_suffix(int type)
 	}
 }
 
-static inline int cts_vcard_get_photo(cts_ct_base *base, char *val)
+static inline int cts_vcard_open_photo(int type, char *dest, int dest_size)
 {
-	int ret, type, fd;
-	gsize size;
-	guchar *buf;
-	char *temp;
-	char dest[CTS_IMG_PATH_SIZE_MAX];
-
-	temp = strchr(val , ':');
-	retvm_if(NULL == temp, CTS_ERR_ARG_INVALID, "val is invalid(%s)", val);
+	int ret, fd;
 
-	*temp = '\0';
-	type = cts_vcard_get_photo_type(val);
-
-	ret = snprintf(dest, sizeof(dest), "%s/%d-%d.%s", CTS_VCARD_IMAGE_LOCATION,
-			getpid(), cts_tmp_photo_id++, cts_get_img_suffix(type));
+	ret = snprintf(dest, dest_size, "%s/%d-%d.%s", CTS_VCARD_IMAGE_LOCATION,
+			getpid(), __sync_fetch_and_add(&cts_tmp_photo_id, 1),
+			cts_get_img_suffix(type));
 	retvm_if(ret<=0, CTS_ERR_FAIL, "Destination file name was not created");
 
 	fd = open(dest, O_WRONLY|O_CREAT|O_TRUNC, 0660);
 	retvm_if(fd < 0, CTS_ERR_FAIL, "open(%s) Failed(%d)", dest, errno);
 
-	buf = g_base64_decode(temp+1, &size);
+	return fd;
+}
+
+static int cts_vcard_write_all(int fd, const guchar *buf, gsize size)
+{
+	int ret;
 
 	while (0 < size) {
 		ret = write(fd, buf, size);
@@ -957,18 +957,41 @@ static inline int cts_vcard_get_photo(cts_ct_base *base, char *val)
 				continue;
 			else {
 				ERR("write() Failed(%d)", errno);
-				close(fd);
 				if (ENOSPC == errno)
 					return CTS_ERR_NO_SPACE;
 				else
 					return CTS_ERR_IO_ERR;
 			}
 		}
+		buf += ret;
 		size -= ret;
 	}
 
+	return CTS_SUCCESS;
+}
+
+static inline int cts_vcard_get_photo(cts_ct_base *base, char *val)
+{
+	int ret, type, fd;
+	gsize size;
+	guchar *buf;
+	char *temp;
+	char dest[CTS_IMG_PATH_SIZE_MAX];
+
+	temp = strchr(val , ':');
+	retvm_if(NULL == temp, CTS_ERR_ARG_INVALID, "val is invalid(%s)", val);
+
+	*temp = '\0';
+	type = cts_vcard_get_photo_type(val);
+
+	fd = cts_vcard_open_photo(type, dest, sizeof(dest));
+	retvm_if(fd < 0, fd, "cts_vcard_open_photo() Failed(%d)", fd);
+
+	buf = g_base64_decode(temp+1, &size);
+	ret = cts_vcard_write_all(fd, buf, size);
 	close(fd);
 	g_free(buf);
+	retv_if(CTS_SUCCESS != ret, ret);
 
 	base->vcard_img_path = strdup(dest);
 
@@ -977,11 +1000,11 @@ static inline int cts_vcard_get_photo(cts_ct_base *base, char *val)
 
 static inline GSList* cts_vcard_get_group(GSList *groups, char *val)
 {
-	char *temp;
+	char *temp, *save = NULL;
 	cts_group *result;
 	const char *separator = ",";
 
-	temp = strtok(val, separator);
+	temp = strtok_r(val, separator, &save);
 	while (temp) {
 		if ('\0' == *temp) continue;
 
@@ -992,7 +1015,7 @@ static inline GSList* cts_vcard_get_group(GSList *groups, char *val)
 			groups = g_slist_append(groups, result);
 		}
 
-		temp = strtok(NULL, separator);
+		temp = strtok_r(NULL, separator, &save);
 	}
 
 	return groups;
@@ -1150,7 +1173,7 @@ static inline int cts_vcard_get_contact(int ver, int flags,
 	return CTS_ERR_ARG_INVALID;
 }
 
-static void cts_vcard_initial(void)
+void cts_vcard_initial(void)
 {
 	if (NULL == *content_name) {
 		//content_name[CTS_VCARD_VALUE_NAME] = "NAME"; /* not supported */
@@ -1258,6 +1281,9 @@ int cts_vcard_parse(const void *vcard_stream, CTSstruct **contact, int flags)
 
 const char *CTS_CRLF = "\r\n";
 
+/* The photo is written by cts_vcard_write_photo() */
+#define CTS_VCARD_CONTENT_NO_PHOTO (1<<8)
+
 static inline int cts_vcard_append_name(cts_name *name,
 		char *dest, int dest_size)
 {
@@ -1609,12 +1635,12 @@ static inline int cts_vcard_put_photo(const char *path, char *dest, int dest_siz
 
 	return ret;
 }
-static inline int cts_vcard_append_base(cts_ct_base *base,
+static inline int cts_vcard_append_base(cts_ct_base *base, int flags,
 		char *dest, int dest_size)
 {
 	int ret_len = 0;
 
-	if (base->img_path)
+	if (base->img_path && !(flags & CTS_VCARD_CONTENT_NO_PHOTO))
 		ret_len += cts_vcard_put_photo(base->img_path,
 				dest+ret_len, dest_size-ret_len);
 	if (base->uid)
@@ -1703,7 +1729,7 @@ static inline int cts_vcard_append_contact(int flags, contact_t *contact,
 		ret_len += cts_vcard_append_events(contact->events,
 				dest+ret_len, dest_size-ret_len);
 	if (contact->base)
-		ret_len += cts_vcard_append_base(contact->base,
+		ret_len += cts_vcard_append_base(contact->base, flags,
 				dest+ret_len, dest_size-ret_len);
 	if (contact->grouprelations && (flags & CTS_VCARD_CONTENT_X_SLP_GROUP))
 		ret_len += cts_vcard_append_grouprelations(contact->grouprelations,
@@ -1788,3 +1814,716 @@ int cts_vcard_make(const CTSstruct *contact, char **vcard_stream, int flags)
 	return CTS_SUCCESS;
 }
 
+void cts_vcard_writer_init(cts_vcard_writer *writer, int fd)
+{
+	writer->fd = fd;
+	writer->len = 0;
+	writer->col = 0;
+}
+
+int cts_vcard_writer_flush(cts_vcard_writer *writer)
+{
+	int ret, written = 0;
+
+	while (written < writer->len) {
+		ret = write(writer->fd, writer->buf + written, writer->len - written);
+		if (ret <= 0) {
+			if (EINTR == errno)
+				continue;
+			ERR("write() Failed(%d)", errno);
+			if (ENOSPC == errno)
+				return CTS_ERR_NO_SPACE;
+			else
+				return CTS_ERR_IO_ERR;
+		}
+		written += ret;
+	}
+	writer->len = 0;
+
+	return CTS_SUCCESS;
+}
+
+/* folds lines like cts_vcard_add_folding() while buffering */
+static int cts_vcard_writer_put(cts_vcard_writer *writer, const char *src, int len)
+{
+	int i, ret;
+
+	for (i=0;i<len;i++) {
+		if (sizeof(writer->buf) - 4 < writer->len) {
+			ret = cts_vcard_writer_flush(writer);
+			retvm_if(CTS_SUCCESS != ret, ret, "cts_vcard_writer_flush() Failed(%d)", ret);
+		}
+
+		if ('\r' == src[i])
+			writer->col--;
+		else if ('\n' == src[i])
+			writer->col = -1;
+
+		if (CTS_VCARD_FOLDING_LIMIT == writer->col) {
+			writer->buf[writer->len++] = '\r';
+			writer->buf[writer->len++] = '\n';
+			writer->buf[writer->len++] = ' ';
+			writer->col = 1;
+		}
+
+		writer->buf[writer->len++] = src[i];
+		writer->col++;
+	}
+
+	return CTS_SUCCESS;
+}
+
+#define CTS_VCARD_PHOTO_CHUNK 3*1024
+
+static inline int cts_vcard_write_photo(cts_vcard_writer *writer, const char *path)
+{
+	int ret, fd, type, len;
+	gint state = 0, save = 0;
+	char *suffix;
+	char header[128];
+	guchar image[CTS_VCARD_PHOTO_CHUNK];
+	gchar encoded[CTS_VCARD_PHOTO_CHUNK/3*4 + 8];
+
+	suffix = strrchr(path, '.');
+	retvm_if(NULL == suffix, CTS_SUCCESS, "Image Type(%s) is invalid", path);
+
+	type = cts_vcard_get_photo_type(suffix);
+	retvm_if(CTS_VCARD_IMG_NONE == type, CTS_SUCCESS, "Image Type(%s) is invalid", path);
+
+	fd = open(path, O_RDONLY);
+	retvm_if(fd < 0, CTS_SUCCESS, "Open(%s) Failed(%d)", path, errno);
+
+	len = snprintf(header, sizeof(header), "%s;ENCODING=BASE64;TYPE=%s:",
+			content_name[CTS_VCARD_VALUE_PHOTO], cts_get_photo_type_str(type));
+	ret = cts_vcard_writer_put(writer, header, len);
+
+	while (CTS_SUCCESS == ret) {
+		len = read(fd, image, sizeof(image));
+		if (len < 0) {
+			if (EINTR == errno)
+				continue;
+			ERR("read() Failed(%d)", errno);
+			ret = CTS_ERR_IO_ERR;
+			break;
+		}
+		if (0 == len)
+			break;
+
+		len = g_base64_encode_step(image, len, FALSE, encoded, &state, &save);
+		ret = cts_vcard_writer_put(writer, encoded, len);
+	}
+	close(fd);
+	retvm_if(CTS_SUCCESS != ret, ret, "Writing photo(%s) Failed(%d)", path, ret);
+
+	len = g_base64_encode_close(FALSE, encoded, &state, &save);
+	ret = cts_vcard_writer_put(writer, encoded, len);
+	retv_if(CTS_SUCCESS != ret, ret);
+
+	return cts_vcard_writer_put(writer, "\r\n\r\n", 4);
+}
+
+int cts_vcard_write_contact(cts_vcard_writer *writer, const CTSstruct *contact,
+		int flags, char *buf, int buf_size)
+{
+	int ret, len;
+	contact_t *record = (contact_t *)contact;
+
+	retv_if(NULL == contact, CTS_ERR_ARG_NULL);
+	retvm_if(CTS_STRUCT_CONTACT != contact->s_type, CTS_ERR_ARG_INVALID,
+			"The record(%d) must be type of CTS_STRUCT_CONTACT.", contact->s_type);
+
+	cts_vcard_initial();
+
+	len = snprintf(buf, buf_size, "%s%s%s%s%s", "BEGIN:VCARD", CTS_CRLF,
+			"VERSION:", "3.0", CTS_CRLF);
+	len += cts_vcard_append_contact(flags | CTS_VCARD_CONTENT_NO_PHOTO, record,
+			buf+len, buf_size-len);
+	retvm_if(buf_size <= len, CTS_ERR_EXCEEDED_LIMIT,
+			"This contact has too many information");
+
+	writer->col = 0;
+	ret = cts_vcard_writer_put(writer, buf, len);
+	retv_if(CTS_SUCCESS != ret, ret);
+
+	if (record->base && record->base->img_path) {
+		ret = cts_vcard_write_photo(writer, record->base->img_path);
+		retv_if(CTS_SUCCESS != ret, ret);
+	}
+
+	len = snprintf(buf, buf_size, "%s%s", "END:VCARD", CTS_CRLF);
+	return cts_vcard_writer_put(writer, buf, len);
+}
+
+/**************************
+ *
+ * VCard File
+ *
+ **************************/
+
+static inline char* cts_vcard_next_line(char *cursor, const char *end)
+{
+	char *eol = memchr(cursor, '\n', end - cursor);
+	return eol ? (eol + 1) : (char *)end;
+}
+
+/* returns the start of the line which begins with word(shorter than 32) */
+static inline char* cts_vcard_find_line(char *cursor, const char *end,
+		const char *word, int word_len)
+{
+	char *found;
+	char needle[32];
+
+	if (end <= cursor)
+		return NULL;
+	if (word_len <= end - cursor && 0 == memcmp(cursor, word, word_len))
+		return cursor;
+
+	/* memmem() skips the other lines(e.g. base64 photo) without scanning each line */
+	needle[0] = '\n';
+	memcpy(needle+1, word, word_len);
+	found = memmem(cursor, end - cursor, needle, word_len + 1);
+
+	return found ? (found + 1) : NULL;
+}
+
+/* removes folding(CRLF + white space) in place and returns the new length */
+static inline int cts_vcard_unfold(char *src, int len)
+{
+	char *cursor, *dest, *eol, *seg_end;
+	char *end = src + len;
+
+	eol = memchr(src, '\n', len);
+	while (eol && eol + 1 < end && ' ' != *(eol+1) && '\t' != *(eol+1))
+		eol = memchr(eol + 1, '\n', end - (eol + 1));
+	if (NULL == eol || end <= eol + 1)
+		return len;
+
+	dest = eol;
+	while (src < dest && '\r' == *(dest-1))
+		dest--;
+	cursor = eol + 2;
+	while (cursor < end) {
+		eol = memchr(cursor, '\n', end - cursor);
+		if (NULL == eol) {
+			memmove(dest, cursor, end - cursor);
+			dest += end - cursor;
+			break;
+		}
+
+		if (eol + 1 < end && (' ' == *(eol+1) || '\t' == *(eol+1))) {
+			seg_end = eol;
+			while (cursor < seg_end && '\r' == *(seg_end-1))
+				seg_end--;
+			memmove(dest, cursor, seg_end - cursor);
+			dest += seg_end - cursor;
+			cursor = eol + 2;
+		}
+		else {
+			memmove(dest, cursor, eol + 1 - cursor);
+			dest += eol + 1 - cursor;
+			cursor = eol + 1;
+		}
+	}
+
+	return dest - src;
+}
+
+int cts_vcard_file_open(const char *path, cts_vcard_file *file)
+{
+	int fd, ret;
+	struct stat buf;
+
+	retv_if(NULL == path, CTS_ERR_ARG_NULL);
+	retv_if(NULL == file, CTS_ERR_ARG_NULL);
+
+	memset(file, 0x00, sizeof(cts_vcard_file));
+
+	fd = open(path, O_RDONLY);
+	retvm_if(fd < 0, CTS_ERR_FAIL, "open(%s) Failed(%d)", path, errno);
+
+	ret = fstat(fd, &buf);
+	if (ret < 0 || 0 == buf.st_size) {
+		close(fd);
+		retvm_if(ret < 0, CTS_ERR_FAIL, "fstat() Failed(%d)", errno);
+		return CTS_SUCCESS;
+	}
+
+	/* The private mapping is modified in place(unfolding, NUL termination)
+	 * without changing the file. */
+	file->map = mmap(NULL, buf.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (MAP_FAILED == file->map) {
+		ERR("mmap() Failed(%d)", errno);
+		file->map = NULL;
+		return CTS_ERR_FAIL;
+	}
+	madvise(file->map, buf.st_size, MADV_SEQUENTIAL);
+
+	file->size = buf.st_size;
+	file->end = file->map + buf.st_size;
+	file->cursor = file->map;
+
+	return CTS_SUCCESS;
+}
+
+void cts_vcard_file_close(cts_vcard_file *file)
+{
+	if (file->map)
+		munmap(file->map, file->size);
+	free(file->last);
+	memset(file, 0x00, sizeof(cts_vcard_file));
+}
+
+char* cts_vcard_file_next(cts_vcard_file *file, int *len)
+{
+	char *begin, *card_end;
+
+	if (NULL == file->map || file->end <= file->cursor)
+		return NULL;
+
+	begin = cts_vcard_find_line(file->cursor, file->end,
+			"BEGIN:VCARD", sizeof("BEGIN:VCARD")-1);
+	if (NULL == begin) {
+		file->cursor = file->end;
+		return NULL;
+	}
+
+	card_end = cts_vcard_find_line(begin, file->end, "END:VCARD", sizeof("END:VCARD")-1);
+	if (NULL == card_end) {
+		ERR("The last vcard is not finished");
+		file->cursor = file->end;
+		return NULL;
+	}
+
+	file->cursor = cts_vcard_next_line(card_end, file->end);
+	*len = file->cursor - begin;
+	return begin;
+}
+
+int cts_vcard_file_seek(cts_vcard_file *file, long offset)
+{
+	retvm_if(offset < 0 || file->size < offset, CTS_ERR_ARG_INVALID,
+			"offset(%ld) is out of the file(size = %zu)", offset, file->size);
+
+	if (file->map)
+		file->cursor = file->map + offset;
+
+	return CTS_SUCCESS;
+}
+
+/* counts the END:VCARD lines from the cursor. The cursor is not moved. */
+int cts_vcard_file_count(cts_vcard_file *file)
+{
+	int cnt = 0;
+	char *cursor = file->cursor;
+
+	if (NULL == file->map)
+		return 0;
+
+	while ((cursor = cts_vcard_find_line(cursor, file->end,
+					"END:VCARD", sizeof("END:VCARD")-1))) {
+		cnt++;
+		cursor = cts_vcard_next_line(cursor, file->end);
+	}
+
+	return cnt;
+}
+
+/* collects the offsets of vcards from the cursor. The cursor is not moved.
+ * The offsets should be freed by free() */
+int cts_vcard_file_index(cts_vcard_file *file, long **offsets)
+{
+	int len, size, cnt;
+	char *vcard, *cursor;
+	long *tmp, *result;
+
+	cursor = file->cursor;
+	result = NULL;
+	size = cnt = 0;
+	while ((vcard = cts_vcard_file_next(file, &len))) {
+		if (size <= cnt) {
+			size = size ? size * 2 : 256;
+			tmp = realloc(result, size * sizeof(long));
+			if (NULL == tmp) {
+				ERR("realloc() Failed");
+				free(result);
+				file->cursor = cursor;
+				return CTS_ERR_OUT_OF_MEMORY;
+			}
+			result = tmp;
+		}
+		result[cnt++] = vcard - file->map;
+	}
+	file->cursor = cursor;
+
+	*offsets = result;
+	return cnt;
+}
+
+char* cts_vcard_file_terminate(cts_vcard_file *file, char *vcard, int *len)
+{
+	int unfolded;
+
+	unfolded = cts_vcard_unfold(vcard, *len);
+
+	/* The NUL is written in the vcard, because the next vcard can be used
+	 * by another thread at the same time. */
+	if (unfolded < *len) {
+		vcard[unfolded] = '\0';
+	}
+	else if ('\n' == vcard[unfolded-1]) {
+		unfolded--;
+		if (0 < unfolded && '\r' == vcard[unfolded-1])
+			unfolded--;
+		vcard[unfolded] = '\0';
+	}
+	else {
+		/* The last vcard of the file without line break */
+		file->last = strndup(vcard, unfolded);
+		retvm_if(NULL == file->last, NULL, "strndup() Failed");
+		vcard = file->last;
+	}
+
+	*len = unfolded;
+	return vcard;
+}
+
+int cts_vcard_file_foreach(const char *path,
+		int (*fn)(char *vcard, int len, void *data), void *data)
+{
+	int ret, len;
+	char *vcard;
+	cts_vcard_file file;
+
+	retv_if(NULL == fn, CTS_ERR_ARG_NULL);
+
+	ret = cts_vcard_file_open(path, &file);
+	retvm_if(CTS_SUCCESS != ret, ret, "cts_vcard_file_open() Failed(%d)", ret);
+
+	while ((vcard = cts_vcard_file_next(&file, &len))) {
+		vcard = cts_vcard_file_terminate(&file, vcard, &len);
+		if (NULL == vcard) {
+			ret = CTS_ERR_OUT_OF_MEMORY;
+			break;
+		}
+
+		if (fn(vcard, len, data)) {
+			ret = CTS_ERR_FINISH_ITER;
+			break;
+		}
+	}
+
+	cts_vcard_file_close(&file);
+	return ret;
+}
+
+/**************************
+ *
+ * VCard Stream
+ *
+ **************************/
+
+enum {
+	CTS_VCARD_STREAM_NONE,
+	CTS_VCARD_STREAM_PHOTO, /* in base64 photo, at the start of line */
+	CTS_VCARD_STREAM_PHOTO_DATA, /* in the indented line of base64 photo */
+};
+
+#define CTS_VCARD_STREAM_BUF_MIN 256
+
+void cts_vcard_stream_init(cts_vcard_stream *stream, int flags,
+		int (*fn)(CTSstruct *contact, void *data), void *data)
+{
+	memset(stream, 0x00, sizeof(cts_vcard_stream));
+	stream->flags = flags;
+	stream->photo_fd = -1;
+	stream->fn = fn;
+	stream->data = data;
+}
+
+static int cts_vcard_stream_append(char **buf, int *len, int *size,
+		const char *src, int src_len)
+{
+	int new_size;
+	char *tmp;
+
+	if (*size <= *len + src_len) {
+		retvm_if(CTS_VCARD_FILE_MAX_SIZE <= *len + src_len, CTS_ERR_EXCEEDED_LIMIT,
+				"The line or vcard is too long(%d)", *len + src_len);
+
+		new_size = *size ? *size : CTS_VCARD_STREAM_BUF_MIN;
+		while (new_size <= *len + src_len)
+			new_size *= 2;
+		tmp = realloc(*buf, new_size);
+		retvm_if(NULL == tmp, CTS_ERR_OUT_OF_MEMORY, "realloc() Failed");
+		*buf = tmp;
+		*size = new_size;
+	}
+
+	memcpy(*buf + *len, src, src_len);
+	*len += src_len;
+	(*buf)[*len] = '\0';
+
+	return CTS_SUCCESS;
+}
+
+static inline void cts_vcard_stream_drop_photo(cts_vcard_stream *stream)
+{
+	if (stream->photo_path) {
+		unlink(stream->photo_path);
+		free(stream->photo_path);
+		stream->photo_path = NULL;
+	}
+}
+
+static int cts_vcard_stream_photo_data(cts_vcard_stream *stream,
+		const char *src, int len)
+{
+	int ret, cnt;
+	gsize size;
+	guchar decoded[768];
+
+	if (stream->photo_fd < 0)
+		return CTS_SUCCESS;
+
+	/* g_base64_decode_step() skips line breaks and white spaces */
+	while (0 < len) {
+		cnt = (len < 1024) ? len : 1024;
+		size = g_base64_decode_step(src, cnt, decoded, &stream->b64_state, &stream->b64_save);
+		ret = cts_vcard_write_all(stream->photo_fd, decoded, size);
+		if (CTS_SUCCESS != ret) {
+			ERR("cts_vcard_write_all() Failed(%d)", ret);
+			close(stream->photo_fd);
+			stream->photo_fd = -1;
+			cts_vcard_stream_drop_photo(stream);
+			return ret;
+		}
+		src += cnt;
+		len -= cnt;
+	}
+
+	return CTS_SUCCESS;
+}
+
+static inline void cts_vcard_stream_photo_start(cts_vcard_stream *stream, char *params)
+{
+	int fd;
+	char dest[CTS_IMG_PATH_SIZE_MAX];
+
+	stream->state = CTS_VCARD_STREAM_PHOTO;
+	stream->b64_state = 0;
+	stream->b64_save = 0;
+
+	/* A contact has only one photo. */
+	if (stream->photo_path)
+		return;
+
+	fd = cts_vcard_open_photo(cts_vcard_get_photo_type(params), dest, sizeof(dest));
+	retm_if(fd < 0, "cts_vcard_open_photo() Failed(%d)", fd);
+
+	stream->photo_path = strdup(dest);
+	if (NULL == stream->photo_path) {
+		ERR("strdup() Failed");
+		close(fd);
+		unlink(dest);
+		return;
+	}
+	stream->photo_fd = fd;
+}
+
+static inline void cts_vcard_stream_photo_end(cts_vcard_stream *stream)
+{
+	if (0 <= stream->photo_fd) {
+		close(stream->photo_fd);
+		stream->photo_fd = -1;
+	}
+	stream->state = CTS_VCARD_STREAM_NONE;
+}
+
+/* returns the position of ':' if the line starts the base64 photo */
+static inline char* cts_vcard_stream_check_photo(char *line, int len)
+{
+	char *colon;
+
+	if (len < sizeof("PHOTO;")-1 || 0 != memcmp(line, "PHOTO;", sizeof("PHOTO;")-1))
+		return NULL;
+
+	colon = memchr(line, ':', len);
+	if (NULL == colon)
+		return NULL;
+
+	*colon = '\0';
+	if (strcasestr(line, "BASE64") || strcasestr(line, "ENCODING=B"))
+		return colon;
+	*colon = ':';
+
+	return NULL;
+}
+
+static int cts_vcard_stream_card_end(cts_vcard_stream *stream)
+{
+	int ret;
+	CTSstruct *contact;
+	contact_t *record;
+
+	stream->in_card = false;
+	ret = cts_vcard_parse(stream->card, &contact, stream->flags);
+	if (CTS_SUCCESS != ret) {
+		ERR("cts_vcard_parse() Failed(%d)", ret);
+		cts_vcard_stream_drop_photo(stream);
+		return CTS_SUCCESS;
+	}
+
+	record = (contact_t *)contact;
+	if (stream->photo_path) {
+		free(record->base->vcard_img_path);
+		record->base->vcard_img_path = stream->photo_path;
+		stream->photo_path = NULL;
+	}
+
+	if (stream->fn(contact, stream->data))
+		return CTS_ERR_FINISH_ITER;
+
+	return CTS_SUCCESS;
+}
+
+/* handles a complete line which does not have the line break */
+static int cts_vcard_stream_line(cts_vcard_stream *stream, char *line, int len)
+{
+	int ret;
+
+	if (CTS_VCARD_STREAM_PHOTO == stream->state) {
+		/* The base64 lines of vCard 2.1 may not be indented,
+		 * but they never have ':' */
+		if (0 < len && NULL == memchr(line, ':', len))
+			return cts_vcard_stream_photo_data(stream, line, len);
+		cts_vcard_stream_photo_end(stream);
+		if (0 == len)
+			return CTS_SUCCESS;
+	}
+
+	if (!stream->in_card) {
+		if (0 == strncmp(line, "BEGIN:VCARD", sizeof("BEGIN:VCARD")-1)) {
+			stream->in_card = true;
+			stream->card_len = 0;
+		}
+		else
+			return CTS_SUCCESS;
+	}
+
+	ret = cts_vcard_stream_append(&stream->card, &stream->card_len, &stream->card_size,
+			line, len);
+	if (CTS_SUCCESS == ret)
+		ret = cts_vcard_stream_append(&stream->card, &stream->card_len, &stream->card_size,
+				CTS_CRLF, 2);
+	if (CTS_SUCCESS != ret) {
+		ERR("cts_vcard_stream_append() Failed(%d). The vcard is skipped", ret);
+		stream->in_card = false;
+		cts_vcard_stream_drop_photo(stream);
+		return (CTS_ERR_OUT_OF_MEMORY == ret) ? ret : CTS_SUCCESS;
+	}
+
+	if (0 == strncmp(line, "END:VCARD", sizeof("END:VCARD")-1))
+		return cts_vcard_stream_card_end(stream);
+
+	return CTS_SUCCESS;
+}
+
+int cts_vcard_stream_push(cts_vcard_stream *stream, const char *buf, int len)
+{
+	int ret, cnt;
+	const char *end, *eol;
+	char *colon;
+
+	end = buf + len;
+	while (buf < end) {
+		if (CTS_VCARD_STREAM_PHOTO_DATA == stream->state) {
+			eol = memchr(buf, '\n', end - buf);
+			cnt = (eol ? eol : end) - buf;
+			ret = cts_vcard_stream_photo_data(stream, buf, cnt);
+			retv_if(CTS_SUCCESS != ret, ret);
+
+			buf += cnt;
+			if (eol) {
+				stream->state = CTS_VCARD_STREAM_PHOTO;
+				buf++;
+			}
+			continue;
+		}
+
+		if (CTS_VCARD_STREAM_PHOTO == stream->state && 0 == stream->line_len
+				&& (' ' == *buf || '\t' == *buf)) {
+			stream->state = CTS_VCARD_STREAM_PHOTO_DATA;
+			buf++;
+			continue;
+		}
+
+		eol = memchr(buf, '\n', end - buf);
+		cnt = (eol ? eol : end) - buf;
+		ret = cts_vcard_stream_append(&stream->line, &stream->line_len,
+				&stream->line_size, buf, cnt);
+		if (CTS_SUCCESS != ret) {
+			ERR("cts_vcard_stream_append() Failed(%d)", ret);
+			stream->line_len = 0;
+			stream->in_card = false;
+			return ret;
+		}
+		buf += cnt;
+
+		/* The photo is decoded to the file instead of keeping it in the vcard */
+		if (CTS_VCARD_STREAM_NONE == stream->state && stream->in_card
+				&& (colon = cts_vcard_stream_check_photo(stream->line, stream->line_len))) {
+			cts_vcard_stream_photo_start(stream, stream->line);
+			cnt = stream->line_len - (colon + 1 - stream->line);
+			stream->line_len = 0;
+			ret = cts_vcard_stream_photo_data(stream, colon + 1, cnt);
+			retv_if(CTS_SUCCESS != ret, ret);
+
+			if (eol)
+				buf++;
+			else
+				stream->state = CTS_VCARD_STREAM_PHOTO_DATA;
+			continue;
+		}
+
+		if (NULL == eol)
+			break;
+		buf++;
+
+		cnt = stream->line_len;
+		if (0 < cnt && '\r' == stream->line[cnt-1])
+			cnt--;
+		stream->line_len = 0;
+		ret = cts_vcard_stream_line(stream, stream->line, cnt);
+		retv_if(CTS_SUCCESS != ret, ret);
+	}
+
+	return CTS_SUCCESS;
+}
+
+int cts_vcard_stream_finish(cts_vcard_stream *stream)
+{
+	int ret = CTS_SUCCESS;
+
+	/* the last line without line break */
+	if (stream->line_len) {
+		if ('\r' == stream->line[stream->line_len-1])
+			stream->line_len--;
+		ret = cts_vcard_stream_line(stream, stream->line, stream->line_len);
+		stream->line_len = 0;
+	}
+
+	cts_vcard_stream_photo_end(stream);
+	if (stream->in_card) {
+		ERR("The last vcard is not finished");
+		stream->in_card = false;
+	}
+	cts_vcard_stream_drop_photo(stream);
+
+	free(stream->line);
+	free(stream->card);
+	stream->line = stream->card = NULL;
+	stream->line_size = stream->card_size = 0;
+
+	return ret;
+}
@@ -24,9 +24,64 @@
 #define CTS_VCARD_FILE_MAX_SIZE 1024*1024
 #define CTS_VCARD_PHOTO_MAX_SIZE 1024*100
 
+void cts_vcard_initial(void);
 int cts_vcard_parse(const void *vcard_stream, CTSstruct **contact, int flags);
 int cts_vcard_make(const CTSstruct *contact, char **vcard_stream, int flags);
 
+typedef struct {
+	int fd;
+	int len;
+	int col; /* the length of current line for folding */
+	char buf[8192];
+}cts_vcard_writer;
+
+void cts_vcard_writer_init(cts_vcard_writer *writer, int fd);
+int cts_vcard_writer_flush(cts_vcard_writer *writer);
+int cts_vcard_write_contact(cts_vcard_writer *writer, const CTSstruct *contact,
+		int flags, char *buf, int buf_size);
+
+typedef struct {
+	char *map;
+	char *end;
+	char *cursor;
+	size_t size;
+	char *last; /* the copy of the last vcard which has no room for NUL */
+}cts_vcard_file;
+
+int cts_vcard_file_open(const char *path, cts_vcard_file *file);
+void cts_vcard_file_close(cts_vcard_file *file);
+char* cts_vcard_file_next(cts_vcard_file *file, int *len);
+int cts_vcard_file_seek(cts_vcard_file *file, long offset);
+int cts_vcard_file_count(cts_vcard_file *file);
+int cts_vcard_file_index(cts_vcard_file *file, long **offsets);
+char* cts_vcard_file_terminate(cts_vcard_file *file, char *vcard, int *len);
+int cts_vcard_file_foreach(const char *path,
+		int (*fn)(char *vcard, int len, void *data), void *data);
+
+struct _cts_vcard_stream {
+	int flags;
+	int state;
+	bool in_card;
+	char *line; /* the line which is not finished yet */
+	int line_len;
+	int line_size;
+	char *card; /* the current vcard without the base64 photo */
+	int card_len;
+	int card_size;
+	int photo_fd;
+	char *photo_path;
+	int b64_state;
+	unsigned int b64_save;
+	int (*fn)(CTSstruct *contact, void *data);
+	void *data;
+};
+typedef struct _cts_vcard_stream cts_vcard_stream;
+
+void cts_vcard_stream_init(cts_vcard_stream *stream, int flags,
+		int (*fn)(CTSstruct *contact, void *data), void *data);
+int cts_vcard_stream_push(cts_vcard_stream *stream, const char *buf, int len);
+int cts_vcard_stream_finish(cts_vcard_stream *stream);
+
 #endif //__CTS_VCARD_FILE_H__
 
 
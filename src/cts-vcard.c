@@ -19,8 +19,11 @@
  *
  */
 #include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
 
 #include "cts-internal.h"
+#include "cts-schema.h"
 #include "cts-types.h"
 #include "cts-contact.h"
 #include "cts-vcard.h"
@@ -187,6 +190,8 @@ API int contacts_svc_insert_vcard(int addressbook_id, const char* a_vcard_stream
 	ret = cts_vcard_parse(a_vcard_stream, &vcard_ct, CTS_VCARD_CONTENT_BASIC);
 	retvm_if(CTS_SUCCESS != ret, ret, "cts_vcard_parse() Failed(%d)", ret);
 
+	/* vcard_ct is freed right after inserting */
+	((contact_t *)vcard_ct)->base->vcard_img_movable = true;
 	ret = contacts_svc_insert_contact(addressbook_id, vcard_ct);
 	warn_if(ret < CTS_SUCCESS, "contacts_svc_insert_contact() Failed(%d)", ret);
 
@@ -227,84 +232,445 @@ API int contacts_svc_replace_by_vcard(int contact_id, const char* a_vcard_stream
 	return ret;
 }
 
-#define CTS_VCARD_MAX_SIZE 1024*1024
+typedef struct {
+	int (*fn)(const char *a_vcard_stream, void *data);
+	void *data;
+}cts_vcard_foreach_data;
+
+static int cts_vcard_foreach_cb(char *vcard, int len, void *data)
+{
+	cts_vcard_foreach_data *info = data;
+	return info->fn(vcard, info->data);
+}
 
 API int contacts_svc_vcard_foreach(const char *vcard_file_name,
 		int (*fn)(const char *a_vcard_stream, void *data), void *data)
 {
-	FILE *file;
-	int buf_size, len;
-	char *stream;
-	char line[1024];
+	cts_vcard_foreach_data info;
 
 	retv_if(NULL == vcard_file_name, CTS_ERR_ARG_NULL);
 	retv_if(NULL == fn, CTS_ERR_ARG_NULL);
 
-	file = fopen(vcard_file_name, "r");
-	retvm_if(NULL == file, CTS_ERR_FAIL, "fopen() Failed(%d)", errno);
+	info.fn = fn;
+	info.data = data;
+
+	return cts_vcard_file_foreach(vcard_file_name, cts_vcard_foreach_cb, &info);
+}
 
-	len = 0;
-	buf_size = CTS_VCARD_MAX_SIZE;
-	stream = malloc(CTS_VCARD_MAX_SIZE);
-	retvm_if(NULL == stream, CTS_ERR_OUT_OF_MEMORY, "malloc() Failed");
+API CTSvcardstream* contacts_svc_vcard_stream_new(int (*fn)(CTSstruct *contact, void *data),
+		void *data)
+{
+	cts_vcard_stream *stream;
 
-	while (fgets(line, sizeof(line), file)) {
-		if (0 == len)
-			if (strncmp(line, "BEGIN:VCARD", sizeof("BEGIN:VCARD")-1))
-				continue;
+	retvm_if(NULL == fn, NULL, "fn is NULL");
 
-		if (len + sizeof(line) < buf_size)
-			len += snprintf(stream + len, buf_size - len, "%s", line);
-		else {
-			char *new_stream;
-			buf_size += sizeof(line) * 2;
-			new_stream = realloc(stream, buf_size);
-			if (new_stream)
-				stream = new_stream;
-			else {
-				free(stream);
-				fclose(file);
-				return CTS_ERR_OUT_OF_MEMORY;
+	stream = malloc(sizeof(cts_vcard_stream));
+	retvm_if(NULL == stream, NULL, "malloc() Failed");
+
+	cts_vcard_stream_init(stream, CTS_VCARD_CONTENT_BASIC, fn, data);
+
+	return stream;
+}
+
+API int contacts_svc_vcard_stream_push(CTSvcardstream *stream, const char *buf, int len)
+{
+	retv_if(NULL == stream, CTS_ERR_ARG_NULL);
+	retv_if(NULL == buf, CTS_ERR_ARG_NULL);
+	retvm_if(len < 0, CTS_ERR_ARG_INVALID, "len(%d) is invalid", len);
+
+	return cts_vcard_stream_push(stream, buf, len);
+}
+
+API int contacts_svc_vcard_stream_free(CTSvcardstream *stream)
+{
+	int ret;
+
+	retv_if(NULL == stream, CTS_ERR_ARG_NULL);
+
+	ret = cts_vcard_stream_finish(stream);
+	free(stream);
+
+	return ret;
+}
+
+#define CTS_VCARD_IMPORT_BATCH 50
+#define CTS_VCARD_IMPORT_WINDOW (CTS_VCARD_IMPORT_BATCH * 4)
+#define CTS_VCARD_IMPORT_WORKER_MAX 4
+
+typedef struct {
+	char *vcard;
+	int len;
+	bool parsed;
+	CTSstruct *contact;
+}cts_vcard_slice;
+
+typedef struct {
+	cts_vcard_file file;
+	cts_vcard_slice *slices;
+	int total;
+	int next; /* the next slice to be parsed */
+	int written; /* the count of slices which are taken by the writer */
+	bool stop;
+	pthread_mutex_t mutex;
+	pthread_cond_t parsed_cond;
+	pthread_cond_t window_cond;
+}cts_vcard_import_info;
+
+static inline int cts_vcard_import_split(cts_vcard_import_info *info, int count)
+{
+	int len, size = 0;
+	char *vcard;
+	cts_vcard_slice *tmp;
+
+	while ((count <= 0 || info->total < count)
+			&& (vcard = cts_vcard_file_next(&info->file, &len))) {
+		if (size <= info->total) {
+			size = size ? size * 2 : CTS_VCARD_IMPORT_WINDOW;
+			tmp = realloc(info->slices, size * sizeof(cts_vcard_slice));
+			retvm_if(NULL == tmp, CTS_ERR_OUT_OF_MEMORY, "realloc() Failed");
+			info->slices = tmp;
+		}
+		info->slices[info->total].vcard = vcard;
+		info->slices[info->total].len = len;
+		info->slices[info->total].parsed = false;
+		info->slices[info->total].contact = NULL;
+		info->total++;
+	}
+
+	return CTS_SUCCESS;
+}
+
+static void* cts_vcard_import_worker(void *data)
+{
+	int i, ret;
+	char *vcard;
+	CTSstruct *contact;
+	cts_vcard_slice *slice;
+	cts_vcard_import_info *info = data;
+
+	while (true) {
+		pthread_mutex_lock(&info->mutex);
+		while (!info->stop && info->next < info->total
+				&& info->written + CTS_VCARD_IMPORT_WINDOW <= info->next)
+			pthread_cond_wait(&info->window_cond, &info->mutex);
+		if (info->stop || info->total <= info->next) {
+			pthread_mutex_unlock(&info->mutex);
+			break;
+		}
+		i = info->next++;
+		pthread_mutex_unlock(&info->mutex);
+
+		slice = &info->slices[i];
+		contact = NULL;
+		vcard = cts_vcard_file_terminate(&info->file, slice->vcard, &slice->len);
+		if (vcard) {
+			ret = cts_vcard_parse(vcard, &contact, CTS_VCARD_CONTENT_BASIC);
+			warn_if(CTS_SUCCESS != ret, "cts_vcard_parse(%d) Failed(%d)", i, ret);
+		}
+
+		pthread_mutex_lock(&info->mutex);
+		slice->contact = contact;
+		slice->parsed = true;
+		pthread_cond_signal(&info->parsed_cond);
+		pthread_mutex_unlock(&info->mutex);
+	}
+
+	return NULL;
+}
+
+static inline CTSstruct* cts_vcard_import_take(cts_vcard_import_info *info, int index)
+{
+	CTSstruct *contact;
+
+	pthread_mutex_lock(&info->mutex);
+	while (!info->slices[index].parsed)
+		pthread_cond_wait(&info->parsed_cond, &info->mutex);
+	contact = info->slices[index].contact;
+	info->slices[index].contact = NULL;
+	info->written = index + 1;
+	pthread_cond_broadcast(&info->window_cond);
+	pthread_mutex_unlock(&info->mutex);
+
+	return contact;
+}
+
+/* A failing contact is rolled back alone in the batch transaction.
+ * The return value is the result of the savepoint, not of the insertion. */
+static inline int cts_vcard_import_insert(int addressbook_id, CTSstruct *contact,
+		bool *inserted)
+{
+	int ret;
+
+	*inserted = false;
+	ret = cts_savepoint_begin();
+	retvm_if(CTS_SUCCESS != ret, ret, "cts_savepoint_begin() Failed(%d)", ret);
+
+	/* The photo was decoded by the worker. It is moved instead of copied. */
+	((contact_t *)contact)->base->vcard_img_movable = true;
+	ret = contacts_svc_insert_contact(addressbook_id, contact);
+	warn_if(ret < CTS_SUCCESS, "contacts_svc_insert_contact() Failed(%d)", ret);
+	if (CTS_SUCCESS <= ret)
+		*inserted = true;
+
+	ret = cts_savepoint_end(*inserted);
+	retvm_if(CTS_SUCCESS != ret, ret, "cts_savepoint_end() Failed(%d)", ret);
+
+	return CTS_SUCCESS;
+}
+
+static inline int cts_vcard_import_write(cts_vcard_import_info *info,
+		int addressbook_id, cts_vcard_import_fn progress_cb, void *user_data)
+{
+	int i, ret, imported = 0;
+	bool inserted;
+	CTSstruct *contact;
+
+	for (i=0;i<info->total;i++) {
+		if (0 == i % CTS_VCARD_IMPORT_BATCH) {
+			ret = contacts_svc_begin_trans();
+			retvm_if(ret, ret, "contacts_svc_begin_trans() Failed(%d)", ret);
+		}
+
+		contact = cts_vcard_import_take(info, i);
+		if (contact) {
+			ret = cts_vcard_import_insert(addressbook_id, contact, &inserted);
+			contacts_svc_struct_free(contact);
+			if (CTS_SUCCESS != ret) {
+				contacts_svc_end_trans(false);
+				return ret;
 			}
+			if (inserted)
+				imported++;
+		}
+
+		if (0 == (i+1) % CTS_VCARD_IMPORT_BATCH || i+1 == info->total) {
+			ret = contacts_svc_end_trans(true);
+			retvm_if(ret < CTS_SUCCESS, ret, "contacts_svc_end_trans() Failed(%d)", ret);
+
+			if (progress_cb && progress_cb(imported, info->total, user_data))
+				break;
+		}
+	}
 
-			len += snprintf(stream + len, buf_size - len, "%s", line);
+	return imported;
+}
+
+API int contacts_svc_import_vcard_file_range(int addressbook_id, const char *path,
+		long offset, int count, cts_vcard_import_fn progress_cb, void *user_data)
+{
+	int i, ret, worker_cnt;
+	pthread_t workers[CTS_VCARD_IMPORT_WORKER_MAX];
+	cts_vcard_import_info info = {{0}};
+
+	retv_if(NULL == path, CTS_ERR_ARG_NULL);
+
+	ret = cts_vcard_file_open(path, &info.file);
+	retvm_if(CTS_SUCCESS != ret, ret, "cts_vcard_file_open() Failed(%d)", ret);
+
+	ret = cts_vcard_file_seek(&info.file, offset);
+	if (CTS_SUCCESS != ret) {
+		ERR("cts_vcard_file_seek() Failed(%d)", ret);
+		cts_vcard_file_close(&info.file);
+		return ret;
+	}
+
+	ret = cts_vcard_import_split(&info, count);
+	if (CTS_SUCCESS != ret || 0 == info.total) {
+		ERR("cts_vcard_import_split() Failed(%d), total = %d", ret, info.total);
+		free(info.slices);
+		cts_vcard_file_close(&info.file);
+		return ret;
+	}
+
+	cts_vcard_initial();
+	pthread_mutex_init(&info.mutex, NULL);
+	pthread_cond_init(&info.parsed_cond, NULL);
+	pthread_cond_init(&info.window_cond, NULL);
+
+	/* The caller thread is the single writer. */
+	worker_cnt = sysconf(_SC_NPROCESSORS_ONLN) - 1;
+	if (worker_cnt < 1)
+		worker_cnt = 1;
+	else if (CTS_VCARD_IMPORT_WORKER_MAX < worker_cnt)
+		worker_cnt = CTS_VCARD_IMPORT_WORKER_MAX;
+
+	for (i=0;i<worker_cnt;i++) {
+		ret = pthread_create(&workers[i], NULL, cts_vcard_import_worker, &info);
+		if (ret) {
+			ERR("pthread_create() Failed(%d)", ret);
+			break;
 		}
+	}
+	worker_cnt = i;
 
-		if (0 == strncmp(line, "END:VCARD", 9)) {
-			if (fn)
-				if (fn(stream, data)) {
-					free(stream);
-					fclose(file);
-					return CTS_ERR_FINISH_ITER;
+	if (0 < worker_cnt) {
+		contacts_svc_begin_noti_batch();
+		ret = cts_vcard_import_write(&info, addressbook_id, progress_cb, user_data);
+		contacts_svc_end_noti_batch();
+	}
+	else
+		ret = CTS_ERR_FAIL;
+
+	pthread_mutex_lock(&info.mutex);
+	info.stop = true;
+	pthread_cond_broadcast(&info.window_cond);
+	pthread_mutex_unlock(&info.mutex);
+	for (i=0;i<worker_cnt;i++)
+		pthread_join(workers[i], NULL);
+
+	for (i=0;i<info.total;i++) {
+		if (info.slices[i].contact)
+			contacts_svc_struct_free(info.slices[i].contact);
+	}
+
+	pthread_cond_destroy(&info.window_cond);
+	pthread_cond_destroy(&info.parsed_cond);
+	pthread_mutex_destroy(&info.mutex);
+	free(info.slices);
+	cts_vcard_file_close(&info.file);
+
+	return ret;
+}
+
+API int contacts_svc_import_vcard_file(int addressbook_id, const char *path,
+		cts_vcard_import_fn progress_cb, void *user_data)
+{
+	return contacts_svc_import_vcard_file_range(addressbook_id, path, 0, 0,
+			progress_cb, user_data);
+}
+
+#define CTS_VCARD_EXPORT_FIELD (CTS_DATA_FIELD_NAME|CTS_DATA_FIELD_POSTAL|CTS_DATA_FIELD_WEB\
+		|CTS_DATA_FIELD_EVENT|CTS_DATA_FIELD_COMPANY|CTS_DATA_FIELD_NICKNAME\
+		|CTS_DATA_FIELD_NUMBER|CTS_DATA_FIELD_EMAIL)
+
+static inline int cts_vcard_export_get_ids(int addressbook_id, int last_id, int *ids)
+{
+	int ret, cnt;
+	cts_stmt stmt;
+	char cond[64] = {0};
+	char query[CTS_SQL_MIN_LEN];
+
+	if (0 <= addressbook_id)
+		snprintf(cond, sizeof(cond), "addrbook_id = %d AND ", addressbook_id);
+
+	/* The contacts of the addressbook which is being deleted are hidden */
+	snprintf(query, sizeof(query),
+			"SELECT contact_id FROM %s WHERE %s"
+			"addrbook_id NOT IN (SELECT addrbook_id FROM %s WHERE deleting = 1) "
+			"AND contact_id > %d ORDER BY contact_id LIMIT %d",
+			CTS_TABLE_CONTACTS, cond, CTS_TABLE_ADDRESSBOOKS, last_id, CTS_BATCH_CONTACTS_MAX);
+
+	stmt = cts_query_prepare(query);
+	retvm_if(NULL == stmt, CTS_ERR_DB_FAILED, "cts_query_prepare() Failed");
+
+	cnt = 0;
+	while (CTS_TRUE == (ret = cts_stmt_step(stmt)))
+		ids[cnt++] = cts_stmt_get_int(stmt, 0);
+	cts_stmt_finalize(stmt);
+	retvm_if(CTS_SUCCESS != ret, ret, "cts_stmt_step() Failed(%d)", ret);
+
+	return cnt;
+}
+
+API int contacts_svc_export_vcard(int addressbook_id, int fd)
+{
+	int i, ret, cnt, exported, last_id;
+	char *buf;
+	cts_vcard_writer *writer;
+	int ids[CTS_BATCH_CONTACTS_MAX];
+	contact_t *records[CTS_BATCH_CONTACTS_MAX];
+
+	retvm_if(fd < 0, CTS_ERR_ARG_INVALID, "fd(%d) is invalid", fd);
+
+	writer = malloc(sizeof(cts_vcard_writer));
+	retvm_if(NULL == writer, CTS_ERR_OUT_OF_MEMORY, "malloc() Failed");
+	buf = malloc(CTS_VCARD_FILE_MAX_SIZE);
+	if (NULL == buf) {
+		ERR("malloc() Failed");
+		free(writer);
+		return CTS_ERR_OUT_OF_MEMORY;
+	}
+	cts_vcard_writer_init(writer, fd);
+
+	exported = last_id = 0;
+	while (0 < (cnt = cts_vcard_export_get_ids(addressbook_id, last_id, ids))) {
+		ret = cts_get_contacts_batch(CTS_VCARD_EXPORT_FIELD, ids, cnt, records);
+		if (CTS_SUCCESS != ret) {
+			ERR("cts_get_contacts_batch() Failed(%d)", ret);
+			cnt = ret;
+			break;
+		}
+
+		ret = CTS_SUCCESS;
+		for (i=0;i<cnt;i++) {
+			/* The contact was deleted after its id was read */
+			if (NULL == records[i])
+				continue;
+			if (CTS_SUCCESS == ret) {
+				ret = cts_vcard_write_contact(writer, (CTSstruct *)records[i],
+						CTS_VCARD_CONTENT_BASIC, buf, CTS_VCARD_FILE_MAX_SIZE);
+				if (CTS_ERR_EXCEEDED_LIMIT == ret) {
+					ERR("The contact(%d) is too big. It is skipped", ids[i]);
+					ret = CTS_SUCCESS;
 				}
-			len = 0;
+				else if (CTS_SUCCESS == ret)
+					exported++;
+			}
+			contacts_svc_struct_free((CTSstruct *)records[i]);
 		}
+		if (CTS_SUCCESS != ret) {
+			ERR("cts_vcard_write_contact() Failed(%d)", ret);
+			cnt = ret;
+			break;
+		}
+		if (cnt < CTS_BATCH_CONTACTS_MAX)
+			break;
+		last_id = ids[cnt-1];
 	}
 
-	free(stream);
-	fclose(file);
-	return CTS_SUCCESS;
+	ret = cts_vcard_writer_flush(writer);
+	free(buf);
+	free(writer);
+
+	retvm_if(cnt < CTS_SUCCESS, cnt, "Exporting vcards Failed(%d)", cnt);
+	retvm_if(CTS_SUCCESS != ret, ret, "cts_vcard_writer_flush() Failed(%d)", ret);
+
+	return exported;
 }
 
 API int contacts_svc_vcard_count(const char *vcard_file_name)
 {
-	FILE *file;
-	int cnt;
-	char line[1024];
+	int ret;
+	cts_vcard_file file;
 
 	retv_if(NULL == vcard_file_name, CTS_ERR_ARG_NULL);
 
-	file = fopen(vcard_file_name, "r");
-	retvm_if(NULL == file, CTS_ERR_FAIL, "fopen() Failed(%d)", errno);
+	ret = cts_vcard_file_open(vcard_file_name, &file);
+	retvm_if(CTS_SUCCESS != ret, ret, "cts_vcard_file_open() Failed(%d)", ret);
 
-	cnt = 0;
-	while (fgets(line, sizeof(line), file)) {
-		if (0 == strncmp(line, "END:VCARD", 9))
-			cnt++;
-	}
-	fclose(file);
+	ret = cts_vcard_file_count(&file);
+	cts_vcard_file_close(&file);
 
-	return cnt;
+	return ret;
+}
+
+API int contacts_svc_vcard_make_index(const char *vcard_file_name, long **offsets)
+{
+	int ret;
+	cts_vcard_file file;
+
+	retv_if(NULL == vcard_file_name, CTS_ERR_ARG_NULL);
+	retv_if(NULL == offsets, CTS_ERR_ARG_NULL);
+
+	*offsets = NULL;
+	ret = cts_vcard_file_open(vcard_file_name, &file);
+	retvm_if(CTS_SUCCESS != ret, ret, "cts_vcard_file_open() Failed(%d)", ret);
+
+	ret = cts_vcard_file_index(&file, offsets);
+	cts_vcard_file_close(&file);
+	warn_if(ret < CTS_SUCCESS, "cts_vcard_file_index() Failed(%d)", ret);
+
+	return ret;
 }
 
 static inline char* cts_new_strcpy(char *dest, const char *src, int size)
@@ -100,6 +100,133 @@ int contacts_svc_replace_by_vcard(int contact_id, const char* a_vcard_stream);
 int contacts_svc_vcard_foreach(const char *vcard_file_name,
 		int (*fn)(const char *a_vcard_stream, void *data), void *data);
 
+/**
+ * Use for contacts_svc_import_vcard_file().
+ * If this function doesn't return #CTS_SUCCESS, the import is stopped.
+ *
+ * @param[in] imported The count of contacts which are inserted
+ * @param[in] total The count of vcards in the file
+ * @param[in] user_data The data which is set by contacts_svc_import_vcard_file()
+ */
+typedef int (*cts_vcard_import_fn)(int imported, int total, void *user_data);
+
+/**
+ * This function inserts all vcards of the file into the addressbook.
+ * The vcards are parsed by worker threads and
+ * the caller thread inserts them in batched transactions.
+ * The notification of change is sent once after importing.
+ * The vcard which can not be parsed or inserted is skipped without leaving a part of it.
+ *
+ * @param[in] addressbook_id The index of addressbook. 0 is local(phone internal)
+ * @param[in] path the name of vcard file
+ * @param[in] progress_cb The function which is called after each batch(It can be NULL)
+ * @param[in] user_data data which is passed to progress_cb
+ * @return the count of inserted contacts on success, Negative value(#cts_error) on error
+ */
+int contacts_svc_import_vcard_file(int addressbook_id, const char *path,
+		cts_vcard_import_fn progress_cb, void *user_data);
+
+/**
+ * This function inserts the vcards of the file from the offset into the addressbook.
+ * It is same with contacts_svc_import_vcard_file() except the range.
+ * The offset should be one of the offsets which are gotten by contacts_svc_vcard_make_index().
+ * So the file can be imported by chunks(e.g. on idle time) or resumed.
+ *
+ * @param[in] addressbook_id The index of addressbook. 0 is local(phone internal)
+ * @param[in] path the name of vcard file
+ * @param[in] offset The byte offset of the first vcard to be imported
+ * @param[in] count The count of vcards to be imported. 0 means all vcards until the end.
+ * @param[in] progress_cb The function which is called after each batch(It can be NULL)
+ * @param[in] user_data data which is passed to progress_cb
+ * @return the count of inserted contacts on success, Negative value(#cts_error) on error
+ * @par example
+ * @code
+ long *offsets;
+ int i, total;
+
+ total = contacts_svc_vcard_make_index("/opt/media/contacts.vcf", &offsets);
+ for (i=0;i<total;i+=100)
+    contacts_svc_import_vcard_file_range(0, "/opt/media/contacts.vcf", offsets[i], 100, NULL, NULL);
+ free(offsets);
+ * @endcode
+ */
+int contacts_svc_import_vcard_file_range(int addressbook_id, const char *path,
+		long offset, int count, cts_vcard_import_fn progress_cb, void *user_data);
+
+/**
+ * The stream of vcards which are pushed by chunks.
+ * It is created by contacts_svc_vcard_stream_new().
+ */
+typedef struct _cts_vcard_stream CTSvcardstream;
+
+/**
+ * This function creates the stream which parses vcards from arbitrary chunks of bytes
+ * (e.g. data which is received by Bluetooth or read from a pipe).
+ * Whenever a vcard is completed, fn is called with the contact.
+ * The contact should be freed by contacts_svc_struct_free() in fn.
+ * The base64 photo is decoded to a file while it is pushed,
+ * so the whole vcard is never kept in the memory.
+ *
+ * @param[in] fn function pointer for handling each contact.
+ *               If this function doesn't return #CTS_SUCCESS, contacts_svc_vcard_stream_push()
+ *               returns #CTS_ERR_FINISH_ITER.
+ * @param[in] data data which is passed to callback function
+ * @return The pointer of the stream on success, NULL on error
+ * @par example
+ * @code
+ static int insert_contact(CTSstruct *contact, void *data)
+ {
+    contacts_svc_insert_contact(0, contact);
+    contacts_svc_struct_free(contact);
+    return CTS_SUCCESS;
+ }
+
+ CTSvcardstream *stream = contacts_svc_vcard_stream_new(insert_contact, NULL);
+ while (0 < (len = read(fd, buf, sizeof(buf))))
+    contacts_svc_vcard_stream_push(stream, buf, len);
+ contacts_svc_vcard_stream_free(stream);
+ * @endcode
+ */
+CTSvcardstream* contacts_svc_vcard_stream_new(int (*fn)(CTSstruct *contact, void *data),
+		void *data);
+
+/**
+ * This function pushes a chunk of vcard stream.
+ * The chunk can be cut at any position(e.g. in the middle of a line).
+ *
+ * @param[in] stream The stream of vcards
+ * @param[in] buf The chunk of vcard stream
+ * @param[in] len The length of buf
+ * @return #CTS_SUCCESS on success, Negative value(#cts_error) on error
+ */
+int contacts_svc_vcard_stream_push(CTSvcardstream *stream, const char *buf, int len);
+
+/**
+ * This function finishes the stream and frees it.
+ * The last line which does not have line break is handled before freeing.
+ *
+ * @param[in] stream The stream of vcards
+ * @return #CTS_SUCCESS on success, Negative value(#cts_error) on error
+ */
+int contacts_svc_vcard_stream_free(CTSvcardstream *stream);
+
+/**
+ * This function writes all contacts of the addressbook to the file descriptor as vcards.
+ * The contacts are read in batches and each vcard is written through a buffer,
+ * so the memory usage does not depend on the count of contacts.
+ *
+ * @param[in] addressbook_id The index of addressbook. Negative value means all addressbooks
+ * @param[in] fd The file descriptor which is opened for writing
+ * @return the count of written vcards on success, Negative value(#cts_error) on error
+ * @par example
+ * @code
+ int fd = open("/opt/media/backup.vcf", O_WRONLY|O_CREAT|O_TRUNC, 0660);
+ ret = contacts_svc_export_vcard(0, fd);
+ close(fd);
+ * @endcode
+ */
+int contacts_svc_export_vcard(int addressbook_id, int fd);
+
 /**
  * This function gets count of vcard in the file.
  *
@@ -108,6 +235,18 @@ int contacts_svc_vcard_foreach(const char *vcard_file_name,
  */
 int contacts_svc_vcard_count(const char *vcard_file_name);
 
+/**
+ * This function makes the index of vcards in the file.
+ * The index is an array of the byte offsets where each vcard begins.
+ * (offsets[K] is the offset of K-th vcard.)
+ * You should free the offsets with free() after using.
+ *
+ * @param[in] vcard_file_name the name of vcard file
+ * @param[out] offsets Points of the array of offsets(It is NULL if there is no vcard)
+ * @return The count of vcards on success, Negative value(#cts_error) on error
+ */
+int contacts_svc_vcard_make_index(const char *vcard_file_name, long **offsets);
+
 /**
  * This function puts vcard content.
  * If vcard stream has vcards, this function puts new content into the last vcard.
@@ -160,6 +160,31 @@ static void get_person_list(void)
 	contacts_svc_iter_remove(iter);
 }
 
+static int print_cluster(const int *person_ids, int count, void *user_data)
+{
+	int i;
+
+	printf("cluster :");
+	for (i=0;i<count;i++)
+		printf(" %d", person_ids[i]);
+	printf("\n");
+
+	return CTS_SUCCESS;
+}
+
+static void find_duplicates(void)
+{
+	int ret;
+
+	make_preconditon("333", "333", "010-3333-3333");
+	make_preconditon("333", "333", "+82-10-3333-3333");
+
+	ret = contacts_svc_find_duplicate_clusters(CTS_SIMILAR_NAME|CTS_SIMILAR_NUMBER, 0,
+			print_cluster, NULL);
+	if (CTS_SUCCESS != ret)
+		printf("contacts_svc_find_duplicate_clusters() Failed(%d)\n", ret);
+}
+
 int main(int argc, char **argv)
 {
 	int person1, person2;
@@ -177,6 +202,8 @@ int main(int argc, char **argv)
 	contacts_svc_unlink_person(person1, person2);
 	get_person_list();
 
+	find_duplicates();
+
 	contacts_svc_disconnect();
 
 	return 0;
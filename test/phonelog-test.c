@@ -70,6 +70,28 @@ void phonelog_insert_email_test()
 	contacts_svc_value_free(plog);
 }
 
+void phonelog_insert_sms_batch_test(void)
+{
+	int i, ret;
+	CTSvalue *plogs[10];
+
+	for (i=0;i<10;i++) {
+		plogs[i] = contacts_svc_value_new(CTS_VALUE_PHONELOG);
+		contacts_svc_value_set_str(plogs[i], CTS_PLOG_VAL_NUMBER_STR, i%2?"0123456789":"0987654321");
+		contacts_svc_value_set_int(plogs[i], CTS_PLOG_VAL_LOG_TIME_INT, (int)time(NULL));
+		contacts_svc_value_set_int(plogs[i], CTS_PLOG_VAL_LOG_TYPE_INT,
+				CTS_PLOG_TYPE_SMS_INCOMMING);
+		contacts_svc_value_set_str(plogs[i], CTS_PLOG_VAL_SHORTMSG_STR, "Hello~");
+		contacts_svc_value_set_int(plogs[i], CTS_PLOG_VAL_MSGID_INT, 100+i);
+	}
+	ret = contacts_svc_insert_phonelogs(plogs, 10);
+	if (CTS_SUCCESS != ret)
+		printf("contacts_svc_insert_phonelogs() Failed(%d)\n", ret);
+
+	for (i=0;i<10;i++)
+		contacts_svc_value_free(plogs[i]);
+}
+
 void phonelog_modify_test(void)
 {
 	contacts_svc_phonelog_set_seen(2, CTS_PLOG_TYPE_VOICE_INCOMMING_UNSEEN);
@@ -178,6 +200,28 @@ void phonelog_get_last_call_number_test(void)
 	free(number);
 }
 
+static int plog_stats_cb(int day, int log_type, int count, int duration, void *user_data)
+{
+	printf("day=%d:type=%d:count=%d:duration=%d\n", day, log_type, count, duration);
+	return CTS_SUCCESS;
+}
+
+void phonelog_get_stats_test(void)
+{
+	int ret;
+	int now = time(NULL);
+
+	ret = contacts_svc_phonelog_get_stats(CTS_PLOG_STATS_BY_DAY, now - 7*86400, now,
+			plog_stats_cb, NULL);
+	if (CTS_SUCCESS != ret)
+		printf("contacts_svc_phonelog_get_stats() Failed(%d)\n", ret);
+
+	ret = contacts_svc_phonelog_get_stats(CTS_PLOG_STATS_BY_TYPE, 0, now,
+			plog_stats_cb, NULL);
+	if (CTS_SUCCESS != ret)
+		printf("contacts_svc_phonelog_get_stats() Failed(%d)\n", ret);
+}
+
 int main()
 {
 	contacts_svc_connect();
@@ -192,12 +236,17 @@ int main()
 	printf("email List 2 <<<<<<<<<<<\n");
 	phonelog_insert_email_test();
 	phonelog_get_list_test(CTS_LIST_ALL_EMAIL_PLOG);
+	printf("message grouping List <<<<<<<<<<<\n");
+	phonelog_insert_sms_batch_test();
+	phonelog_get_list_test(CTS_LIST_GROUPING_MSG_PLOG);
 	printf("detail List <<<<<<<<<<<\n");
 	phonelog_get_detail_list_test();
 	printf("phonelog number List <<<<<<<<<<<\n");
 	phonelog_get_number_list_test();
 
 	phonelog_get_last_call_number_test();
+	printf("phonelog stats <<<<<<<<<<<\n");
+	phonelog_get_stats_test();
 
 	contacts_svc_disconnect();
 	return 0;